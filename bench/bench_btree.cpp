@@ -0,0 +1,170 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/BTree.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StringPool.h"
+#include "LegacyBTree.h"
+
+// Single-threaded B+tree benchmark against the legacy B-Tree and std::set.
+// Usage: bench_btree [--keys N] [--prefixes N] [--degree T] [--batch N]
+//   Inserts N random keys, runs prefix scans, then removes half the keys.
+//   --degree is the legacy tree's minimum degree (Database used 3).
+//   --batch is the sorted batch size timed against per-key inserts (as batchInsert).
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, const std::string& phase, size_t ops, double seconds) {
+    std::cout << std::setw(10) << name << std::setw(10) << phase
+              << std::setw(14) << std::fixed << std::setprecision(0) << ops / seconds << " ops/sec"
+              << std::setw(12) << std::setprecision(3) << seconds << " s\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t keyCount = 200000;
+    size_t prefixCount = 200;
+    int degree = 3;
+    size_t batchSize = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc) {
+            keyCount = std::stoul(argv[++i]);
+        } else if (arg == "--prefixes" && i + 1 < argc) {
+            prefixCount = std::stoul(argv[++i]);
+        } else if (arg == "--degree" && i + 1 < argc) {
+            degree = std::stoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchSize = std::stoul(argv[++i]);
+        }
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<std::string> keys;
+    keys.reserve(keyCount);
+    for (size_t i = 0; i < keyCount; i++) {
+        keys.push_back("user:" + std::to_string(rng() % (keyCount * 10)) + ":" + std::to_string(i));
+    }
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefixCount; i++) {
+        prefixes.push_back("user:" + std::to_string(rng() % 1000));
+    }
+    std::vector<std::string> removals(keys.begin(), keys.begin() + keyCount / 2);
+    std::shuffle(removals.begin(), removals.end(), rng);
+
+    std::cout << "Keys: " << keyCount << " | Prefix scans: " << prefixCount
+              << " | Legacy degree: " << degree << "\n";
+
+    size_t checksum[3] = {0, 0, 0};
+
+    {
+        legacy::BTree<std::string> tree(degree);
+        auto start = Clock::now();
+        for (const auto& key : keys) tree.insert(key);
+        report("legacy", "insert", keyCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& prefix : prefixes) checksum[0] += tree.rangeSearch(prefix).size();
+        report("legacy", "prefix", prefixCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& key : removals) tree.remove(key);
+        report("legacy", "remove", removals.size(), secondsSince(start));
+    }
+
+    {
+        BTree<std::string> tree;
+        auto start = Clock::now();
+        for (const auto& key : keys) tree.insert(key);
+        report("b+tree", "insert", keyCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& prefix : prefixes) checksum[1] += tree.rangeSearch(prefix).size();
+        report("b+tree", "prefix", prefixCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& key : removals) tree.remove(key);
+        report("b+tree", "remove", removals.size(), secondsSince(start));
+
+        size_t remaining = 0;
+        for (auto it = tree.begin(); it != tree.end(); ++it) remaining++;
+        if (remaining != tree.size() || remaining != keyCount - removals.size()) {
+            std::cerr << "b+tree lost keys: " << remaining << " left" << std::endl;
+            return 1;
+        }
+    }
+
+    {
+        std::set<std::string> tree;
+        auto start = Clock::now();
+        for (const auto& key : keys) tree.insert(key);
+        report("std::set", "insert", keyCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& prefix : prefixes) {
+            for (auto it = tree.lower_bound(prefix);
+                 it != tree.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+                checksum[2]++;
+            }
+        }
+        report("std::set", "prefix", prefixCount, secondsSince(start));
+
+        start = Clock::now();
+        for (const auto& key : removals) tree.erase(key);
+        report("std::set", "remove", removals.size(), secondsSince(start));
+    }
+
+    // Sorted batches of interned keys, as batchInsert applies them to the key and value
+    // indexes: one insert per key against insertSorted, into an empty tree and a full one
+    std::vector<InternedString> batch;
+    batch.reserve(batchSize);
+    for (size_t i = 0; i < batchSize; i++) {
+        batch.emplace_back("user:" + std::to_string(rng() % (keyCount * 10)) + ":batch" + std::to_string(i));
+    }
+    std::sort(batch.begin(), batch.end());
+    std::vector<InternedString> existing(keys.begin(), keys.end());
+    std::sort(existing.begin(), existing.end());
+    for (size_t held : {size_t(0), existing.size()}) {
+        BTree<InternedString> looped(existing.begin(), existing.begin() + held);
+        auto start = Clock::now();
+        for (const auto& key : batch) looped.insert(key);
+        double loopSeconds = secondsSince(start);
+
+        BTree<InternedString> merged(existing.begin(), existing.begin() + held);
+        start = Clock::now();
+        merged.insertSorted(batch.begin(), batch.end());
+        double mergeSeconds = secondsSince(start);
+
+        std::cout << "Sorted batch of " << batchSize << " into " << held << " keys ("
+                  << std::setprecision(1) << loopSeconds / mergeSeconds << "x):\n";
+        report("per-key", "batch", batchSize, loopSeconds);
+        report("sorted", "batch", batchSize, mergeSeconds);
+        bool same = looped.size() == merged.size();
+        for (auto a = looped.begin(), b = merged.begin(); same && a != looped.end(); ++a, ++b) same = *a == *b;
+        if (!same) {
+            std::cerr << "insertSorted disagrees with per-key inserts" << std::endl;
+            return 1;
+        }
+    }
+
+    // The legacy split loses keys, so only the B+tree is held to std::set's answer
+    std::cout << "Prefix matches: legacy " << checksum[0] << ", b+tree " << checksum[1]
+              << ", std::set " << checksum[2] << "\n";
+    if (checksum[1] != checksum[2]) {
+        std::cerr << "b+tree prefix scans disagree with std::set" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Database.h"
+
+// Multi-threaded stress benchmark for the sharded Database.
+// Usage: bench_concurrency [--keys N] [--seconds S] [--read-ratio R] [--shards N]
+//   Every thread runs a random get/insert mix over a pre-populated key space;
+//   throughput is reported for 1, 2, 4, 8, 16 and 32 threads.
+
+int main(int argc, char* argv[]) {
+    size_t keyCount = 100000;
+    double seconds = 1.0;
+    double readRatio = 0.9;
+    size_t shardCount = Database::DEFAULT_SHARD_COUNT;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc) {
+            keyCount = std::stoul(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::stod(argv[++i]);
+        } else if (arg == "--read-ratio" && i + 1 < argc) {
+            readRatio = std::stod(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            shardCount = std::stoul(argv[++i]);
+        }
+    }
+
+    Database db("bench_concurrency.json", shardCount);
+    for (size_t i = 0; i < keyCount; i++) {
+        db.insert("key" + std::to_string(i), "value" + std::to_string(i % 1000));
+    }
+
+    std::cout << "Keys: " << keyCount << " | Shards: " << shardCount
+              << " | Read ratio: " << readRatio
+              << " | Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "ops/sec" << std::setw(12) << "speedup" << "\n";
+
+    double baseline = 0;
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> totalOps(0);
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 rng(t * 7919 + 1);
+                std::uniform_int_distribution<size_t> pickKey(0, keyCount - 1);
+                std::uniform_real_distribution<double> pickOp(0.0, 1.0);
+                uint64_t ops = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    std::string key = "key" + std::to_string(pickKey(rng));
+                    if (pickOp(rng) < readRatio) {
+                        db.get(key);
+                    } else {
+                        db.insert(key, "updated" + std::to_string(ops));
+                    }
+                    ops++;
+                }
+                totalOps += ops;
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& worker : workers) worker.join();
+
+        double throughput = totalOps / seconds;
+        if (threads == 1) baseline = throughput;
+        std::cout << std::setw(8) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(0) << throughput
+                  << std::setw(11) << std::setprecision(2) << throughput / baseline << "x\n";
+    }
+    return 0;
+}
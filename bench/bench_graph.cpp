@@ -0,0 +1,178 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <set>
+#include <queue>
+#include <stack>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ParallelBFS.h"
+
+// Benchmark of graph storage and traversal: the CSR Graph against the
+// std::unordered_map<std::string, std::set<Edge>> adjacency it replaced, loaded with
+// the same undirected edges the way Database::insertEdge adds them, then the parallel
+// direction-optimizing BFS against the serial CSR one.
+// Usage: bench_graph [--nodes N] [--degree D] [--threads T]
+//   Builds a random graph of N nodes with about N*D/2 edges (default 1M nodes, degree 8),
+//   times BFS and DFS from the same start in both, then parallelBfs on 1, 2, 4, ... T
+//   threads (default: the hardware threads).
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct OldEdge {
+    std::string to;
+    int weight;
+    bool operator<(const OldEdge& other) const { return to < other.to; }
+};
+using OldGraph = std::unordered_map<std::string, std::set<OldEdge>>;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, const std::string& phase, size_t items, double seconds) {
+    std::cout << std::setw(10) << name << std::setw(8) << phase
+              << std::setw(14) << std::fixed << std::setprecision(0) << items / seconds << " items/sec"
+              << std::setw(10) << std::setprecision(3) << seconds << " s\n";
+}
+
+std::vector<std::string> oldBfs(OldGraph& graph, const std::string& start) {
+    std::vector<std::string> result;
+    std::queue<std::string> q;
+    std::set<std::string> visited;
+    q.push(start);
+    visited.insert(start);
+    while (!q.empty()) {
+        auto node = q.front(); q.pop();
+        result.push_back(node);
+        for (const auto& edge : graph[node]) {
+            if (!visited.count(edge.to)) {
+                visited.insert(edge.to);
+                q.push(edge.to);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> oldDfs(OldGraph& graph, const std::string& start) {
+    std::vector<std::string> result;
+    std::stack<std::string> s;
+    std::set<std::string> visited;
+    s.push(start);
+    while (!s.empty()) {
+        auto node = s.top(); s.pop();
+        if (visited.count(node)) continue;
+        visited.insert(node);
+        result.push_back(node);
+        for (const auto& edge : graph[node]) s.push(edge.to);
+    }
+    return result;
+}
+
+std::vector<std::string> names(const Graph& graph, const std::vector<NodeId>& order) {
+    std::vector<std::string> result;
+    result.reserve(order.size());
+    for (NodeId id : order) result.emplace_back(graph.name(id));
+    return result;
+}
+
+bool sameNodes(std::vector<std::string> a, std::vector<std::string> b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodes = 1000000;
+    size_t degree = 8;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--nodes" && i + 1 < argc) nodes = std::stoul(argv[++i]);
+        else if (arg == "--degree" && i + 1 < argc) degree = std::stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) maxThreads = std::stoul(argv[++i]);
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<std::string> labels;
+    labels.reserve(nodes);
+    for (size_t i = 0; i < nodes; i++) labels.push_back("node" + std::to_string(i));
+    std::vector<std::pair<size_t, size_t>> edges(nodes * degree / 2);
+    for (auto& edge : edges) edge = {rng() % nodes, rng() % nodes};
+    std::cout << "Graph: " << nodes << " nodes, " << edges.size() << " random edges\n";
+
+    OldGraph oldGraph;
+    auto start = Clock::now();
+    for (const auto& label : labels) oldGraph[label] = {};
+    for (const auto& [from, to] : edges) {
+        oldGraph[labels[from]].insert({labels[to], 1});
+        oldGraph[labels[to]].insert({labels[from], 1});
+    }
+    report("map+set", "build", edges.size(), secondsSince(start));
+
+    Graph graph;
+    start = Clock::now();
+    for (const auto& label : labels) graph.addNode(label);
+    for (const auto& [from, to] : edges) {
+        NodeId u = graph.addNode(labels[from]);
+        NodeId v = graph.addNode(labels[to]);
+        graph.addEdge(u, v, 1);
+        graph.addEdge(v, u, 1);
+        if (graph.shouldCompact()) graph.compact();
+    }
+    graph.compact();
+    report("CSR", "build", edges.size(), secondsSince(start));
+    std::cout << "  CSR graph: ~" << graph.memoryUsage() << " bytes\n";
+
+    const std::string& root = labels[0];
+    start = Clock::now();
+    auto oldOrder = oldBfs(oldGraph, root);
+    report("map+set", "bfs", oldOrder.size(), secondsSince(start));
+    start = Clock::now();
+    auto order = graph.bfs(graph.find(root));
+    double serialSeconds = secondsSince(start);
+    report("CSR", "bfs", order.size(), serialSeconds);
+    bool agreed = sameNodes(oldOrder, names(graph, order));
+
+    start = Clock::now();
+    oldOrder = oldDfs(oldGraph, root);
+    report("map+set", "dfs", oldOrder.size(), secondsSince(start));
+    start = Clock::now();
+    order = graph.dfs(graph.find(root));
+    report("CSR", "dfs", order.size(), secondsSince(start));
+    agreed = agreed && sameNodes(oldOrder, names(graph, order));
+
+    // Parallel BFS, checked against the serial one
+    auto serialOrder = graph.bfs(graph.find(root));
+    std::sort(serialOrder.begin(), serialOrder.end());
+    for (size_t threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        BfsOptions options;
+        options.threads = threads;
+        start = Clock::now();
+        BfsResult result = parallelBfs(graph, graph, graph.find(root), options);
+        double seconds = secondsSince(start);
+        report("parallel", "bfs", result.order.size(), seconds);
+        std::cout << "            " << threads << " threads: " << std::setprecision(2) << serialSeconds / seconds
+                  << "x serial, " << result.topDownLevels << " top-down and " << result.bottomUpLevels
+                  << " bottom-up levels\n";
+        std::sort(result.order.begin(), result.order.end());
+        agreed = agreed && result.order == serialOrder;
+        if (threads == maxThreads) break;
+    }
+
+    if (!agreed) {
+        std::cerr << "CSR traversal reached different nodes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
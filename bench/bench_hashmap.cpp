@@ -0,0 +1,141 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/FlatHashMap.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StringPool.h"
+
+// Single-threaded benchmark of a shard's primary key store: the Swiss-table style
+// FlatHashMap against the std::unordered_map it replaced. Both hold interned keys and
+// values the way a shard does; lookups start from a plain string, as Database::get
+// does, so the old map first resolves the handle through the intern pool.
+// Usage: bench_hashmap [--keys N[,N...]]
+//   For each N: inserts N keys, looks each one up (hit), looks up N absent keys
+//   (miss), then erases every key. Defaults to 1M and 10M keys.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using OldMap = std::unordered_map<InternedString, InternedString, InternedStringHash>;
+using NewMap = FlatHashMap<InternedString, InternedString, InternedTextHash>;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, const std::string& phase, size_t ops, double seconds) {
+    std::cout << std::setw(10) << name << std::setw(10) << phase
+              << std::setw(14) << std::fixed << std::setprecision(0) << ops / seconds << " ops/sec"
+              << std::setw(12) << std::setprecision(3) << seconds << " s\n";
+}
+
+struct Workload {
+    std::vector<InternedString> handles;  // Insert order
+    std::vector<std::string> hits;        // Every key, shuffled
+    std::vector<std::string> misses;      // Never inserted or interned
+    InternedString value{"value"};
+};
+
+Workload makeWorkload(size_t keyCount) {
+    std::mt19937_64 rng(42);
+    Workload w;
+    w.handles.reserve(keyCount);
+    w.hits.reserve(keyCount);
+    w.misses.reserve(keyCount);
+    for (size_t i = 0; i < keyCount; i++) {
+        std::string key = "user:" + std::to_string(rng() % 1000) + ":" + std::to_string(i);
+        w.handles.emplace_back(key);
+        w.hits.push_back(std::move(key));
+        w.misses.push_back("user:" + std::to_string(rng() % 1000) + ":" + std::to_string(keyCount + i));
+    }
+    std::shuffle(w.handles.begin(), w.handles.end(), rng);
+    std::shuffle(w.hits.begin(), w.hits.end(), rng);
+    return w;
+}
+
+// Returns false if the map lost or invented keys
+bool runOld(const Workload& w) {
+    OldMap map;
+    size_t found = 0;
+    auto start = Clock::now();
+    for (const auto& key : w.handles) map.try_emplace(key, w.value);
+    report("unordered", "insert", w.handles.size(), secondsSince(start));
+
+    start = Clock::now();
+    for (const auto& key : w.hits) {
+        InternedString handle = StringPool::instance().find(key);
+        if (handle.valid() && map.find(handle) != map.end()) found++;
+    }
+    report("unordered", "hit", w.hits.size(), secondsSince(start));
+
+    start = Clock::now();
+    for (const auto& key : w.misses) {
+        InternedString handle = StringPool::instance().find(key);
+        if (handle.valid() && map.find(handle) != map.end()) found++;
+    }
+    report("unordered", "miss", w.misses.size(), secondsSince(start));
+
+    start = Clock::now();
+    for (const auto& key : w.hits) {
+        InternedString handle = StringPool::instance().find(key);
+        if (handle.valid()) map.erase(handle);
+    }
+    report("unordered", "erase", w.hits.size(), secondsSince(start));
+    return found == w.hits.size() && map.empty();
+}
+
+bool runNew(const Workload& w) {
+    NewMap map;
+    size_t found = 0;
+    auto start = Clock::now();
+    for (const auto& key : w.handles) map.try_emplace(key, w.value);
+    report("flat", "insert", w.handles.size(), secondsSince(start));
+    size_t tableBytes = map.memoryUsage();
+
+    start = Clock::now();
+    for (const auto& key : w.hits) found += map.count(std::string_view(key));
+    report("flat", "hit", w.hits.size(), secondsSince(start));
+
+    start = Clock::now();
+    for (const auto& key : w.misses) found += map.count(std::string_view(key));
+    report("flat", "miss", w.misses.size(), secondsSince(start));
+
+    start = Clock::now();
+    for (const auto& key : w.hits) map.erase(std::string_view(key));
+    report("flat", "erase", w.hits.size(), secondsSince(start));
+    std::cout << "Flat table: " << tableBytes / (1024 * 1024) << " MB\n";
+    return found == w.hits.size() && map.empty();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> keyCounts = {1000000, 10000000};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc) {
+            keyCounts.clear();
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos < list.size();) {
+                size_t comma = std::min(list.find(',', pos), list.size());
+                keyCounts.push_back(std::stoul(list.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        }
+    }
+
+    for (size_t keyCount : keyCounts) {
+        std::cout << "Keys: " << keyCount << "\n";
+        Workload workload = makeWorkload(keyCount);
+        if (!runOld(workload) || !runNew(workload)) {
+            std::cerr << "hash map lost or invented keys" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <regex>
+#include <chrono>
+#include <random>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/PatternScan.h"
+
+// Single-threaded benchmark of value pattern matching: each pattern runs over the same
+// values through std::regex_search (what a regex scan costs without a prefilter) and
+// through ValuePattern, and the literal substring kernels are timed one by one.
+// Usage: bench_pattern [--values N] [--value-bytes B]
+//   Generates N log-like values of B/2 to 3B/2 bytes (default 1M values of about 100).
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, size_t values, size_t matches, double seconds) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(0) << values / seconds << " values/sec"
+              << std::setw(10) << std::setprecision(3) << seconds << " s"
+              << std::setw(10) << matches << " matches\n";
+}
+
+std::vector<std::string> makeValues(size_t count, size_t valueBytes) {
+    static const char* words[] = {"order", "shipped", "pending", "customer", "invoice", "refund",
+                                  "warehouse", "priority", "status", "delivered", "account", "session"};
+    std::mt19937_64 rng(42);
+    std::vector<std::string> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string value;
+        size_t length = valueBytes / 2 + rng() % (valueBytes + 1);
+        while (value.size() < length) {
+            switch (rng() % 4) {
+                case 0: value += "user" + std::to_string(rng() % 100000) + "@example.com"; break;
+                case 1: value += std::to_string(rng() % 1000000); break;
+                default: value += words[rng() % 12]; break;
+            }
+            value += ' ';
+        }
+        if (rng() % 1000 == 0) value += "zebra-7";  // The rare literal
+        values.push_back(std::move(value));
+    }
+    return values;
+}
+
+// Returns false if the two ways of matching disagree
+bool run(const std::vector<std::string>& values, const std::string& source) {
+    ValuePattern pattern(source);
+    std::cout << "Pattern '" << source << "': " << pattern.describe() << "\n";
+
+    std::regex regex(source, std::regex::ECMAScript | std::regex::optimize);
+    size_t expected = 0;
+    auto start = Clock::now();
+    for (const auto& value : values) expected += std::regex_search(value, regex);
+    report("std::regex_search", values.size(), expected, secondsSince(start));
+
+    size_t found = 0;
+    start = Clock::now();
+    for (const auto& value : values) found += pattern.matches(value);
+    report("ValuePattern", values.size(), found, secondsSince(start));
+    return found == expected;
+}
+
+bool runKernels(const std::vector<std::string>& values, const std::string& needle) {
+    std::cout << "Substring '" << needle << "' by kernel:\n";
+    size_t expected = 0;  // Also brings the values into cache for the first kernel
+    for (const auto& value : values) expected += value.find(needle) != std::string::npos;
+
+    for (SearchKernel kernel : {SearchKernel::SCALAR, SearchKernel::SSE2, SearchKernel::AVX2, SearchKernel::NEON}) {
+        if (!searchKernelSupported(kernel)) continue;
+        SubstringSearcher searcher(needle, kernel);
+        size_t found = 0;
+        auto start = Clock::now();
+        for (const auto& value : values) found += searcher.find(value) != std::string_view::npos;
+        report(searchKernelName(kernel), values.size(), found, secondsSince(start));
+        if (found != expected) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t valueCount = 1000000;
+    size_t valueBytes = 100;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--values" && i + 1 < argc) valueCount = std::stoul(argv[++i]);
+        else if (arg == "--value-bytes" && i + 1 < argc) valueBytes = std::stoul(argv[++i]);
+    }
+
+    std::vector<std::string> values = makeValues(valueCount, valueBytes);
+    std::cout << "Values: " << valueCount << " of about " << valueBytes << " bytes\n";
+
+    // A rare needle, a common word, and one whose first and last bytes are common
+    bool agreed = runKernels(values, "zebra-7") && runKernels(values, "warehouse") &&
+                  runKernels(values, "example.org");
+    for (const char* source : {"zebra-7", "user9999[0-9]@example", "(refund|invoice) user1234", "^[0-9]+ order"}) {
+        agreed = agreed && run(values, source);
+    }
+    if (!agreed) {
+        std::cerr << "pattern matching disagreed with std::regex" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <functional>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ShortestPath.h"
+
+// Single-threaded benchmark of weighted shortest paths on two synthetic undirected
+// graphs: a road-like grid (every node joined to its four neighbors, with weights of
+// 10-19 so travel cost roughly follows distance) and a power-law graph grown by
+// preferential attachment (weights 1-99). Times
+// single-source Dijkstra with each heap, then point-to-point queries between random
+// pairs by Dijkstra, bidirectional Dijkstra and, on the grid, A* with a Manhattan
+// distance heuristic. Every method must agree on every distance.
+// Usage: bench_shortestpath [--nodes N] [--queries Q]
+//   Defaults to about 1M nodes per graph and 100 queries.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, size_t queries, double seconds, size_t settled) {
+    std::cout << "  " << std::left << std::setw(26) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000 / queries << " ms/query"
+              << std::setw(12) << settled / queries << " settled/query\n";
+}
+
+void addEdge(Graph& graph, NodeId u, NodeId v, int weight) {
+    graph.addEdge(u, v, weight);
+    graph.addEdge(v, u, weight);
+    if (graph.shouldCompact()) graph.compact();
+}
+
+Graph makeGrid(size_t side, std::mt19937_64& rng) {
+    Graph graph;
+    for (size_t y = 0; y < side; y++) {
+        for (size_t x = 0; x < side; x++) graph.addNode(std::to_string(x) + "," + std::to_string(y));
+    }
+    for (size_t y = 0; y < side; y++) {
+        for (size_t x = 0; x < side; x++) {
+            NodeId id = static_cast<NodeId>(y * side + x);
+            if (x + 1 < side) addEdge(graph, id, id + 1, 10 + rng() % 10);
+            if (y + 1 < side) addEdge(graph, id, static_cast<NodeId>(id + side), 10 + rng() % 10);
+        }
+    }
+    graph.compact();
+    return graph;
+}
+
+// Each new node links to 4 earlier ones picked with probability proportional to degree
+Graph makePowerLaw(size_t nodes, std::mt19937_64& rng) {
+    Graph graph;
+    std::vector<NodeId> endpoints;  // Every edge's endpoints: sampling it samples by degree
+    for (size_t i = 0; i < nodes; i++) {
+        NodeId id = graph.addNode("n" + std::to_string(i));
+        for (int link = 0; link < 4 && id > 0; link++) {
+            NodeId to = endpoints.empty() ? 0 : endpoints[rng() % endpoints.size()];
+            if (to == id) continue;
+            addEdge(graph, id, to, 1 + rng() % 99);
+            endpoints.push_back(id);
+            endpoints.push_back(to);
+        }
+    }
+    graph.compact();
+    return graph;
+}
+
+bool runSingleSource(const Graph& graph, NodeId source) {
+    auto start = Clock::now();
+    auto radix = shortestDistances(graph, source, PathHeap::RADIX);
+    double radixSeconds = secondsSince(start);
+    start = Clock::now();
+    auto dary = shortestDistances(graph, source, PathHeap::DARY);
+    double darySeconds = secondsSince(start);
+    std::cout << "  single-source, radix heap " << std::setw(10) << std::fixed << std::setprecision(1) << radixSeconds * 1000 << " ms\n"
+              << "  single-source, 4-ary heap " << std::setw(10) << darySeconds * 1000 << " ms\n";
+    return radix == dary;
+}
+
+// `heuristicFor` gives A*'s heuristic toward a target; without one, A* is skipped
+bool runQueries(const Graph& graph, const std::vector<std::pair<NodeId, NodeId>>& queries,
+                const std::function<PathHeuristic(NodeId)>& heuristicFor) {
+    std::vector<uint64_t> expected;
+    size_t settled = 0;
+    auto start = Clock::now();
+    for (const auto& [from, to] : queries) {
+        PathResult result = dijkstraPath(graph, from, to);
+        expected.push_back(result.distance);
+        settled += result.settled;
+    }
+    report("Dijkstra", queries.size(), secondsSince(start), settled);
+
+    bool agreed = true;
+    settled = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < queries.size(); i++) {
+        PathResult result = bidirectionalPath(graph, graph, queries[i].first, queries[i].second);
+        agreed = agreed && result.distance == expected[i];
+        settled += result.settled;
+    }
+    report("bidirectional Dijkstra", queries.size(), secondsSince(start), settled);
+
+    if (heuristicFor) {
+        settled = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < queries.size(); i++) {
+            PathResult result = astarPath(graph, queries[i].first, queries[i].second, heuristicFor(queries[i].second));
+            agreed = agreed && result.distance == expected[i];
+            settled += result.settled;
+        }
+        report("A* (Manhattan)", queries.size(), secondsSince(start), settled);
+    }
+    return agreed;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodes = 1000000;
+    size_t queryCount = 100;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--nodes" && i + 1 < argc) nodes = std::stoul(argv[++i]);
+        else if (arg == "--queries" && i + 1 < argc) queryCount = std::stoul(argv[++i]);
+    }
+
+    std::mt19937_64 rng(42);
+    size_t side = 1;
+    while ((side + 1) * (side + 1) <= nodes) side++;
+    auto randomPairs = [&](size_t count) {
+        std::vector<std::pair<NodeId, NodeId>> pairs(queryCount);
+        for (auto& pair : pairs) pair = {static_cast<NodeId>(rng() % count), static_cast<NodeId>(rng() % count)};
+        return pairs;
+    };
+
+    Graph grid = makeGrid(side, rng);
+    std::cout << "Road-like grid: " << grid.nodeCount() << " nodes, " << grid.edgeCount() / 2 << " edges\n";
+    bool agreed = runSingleSource(grid, 0);
+    // Every edge weighs at least 10, so 10 per grid step is a lower bound
+    auto manhattan = [side](NodeId target) -> PathHeuristic {
+        return [side, target](NodeId node) {
+            uint64_t dx = std::llabs(static_cast<long long>(node % side) - static_cast<long long>(target % side));
+            uint64_t dy = std::llabs(static_cast<long long>(node / side) - static_cast<long long>(target / side));
+            return 10 * (dx + dy);
+        };
+    };
+    agreed = runQueries(grid, randomPairs(grid.nodeCount()), manhattan) && agreed;
+
+    Graph powerLaw = makePowerLaw(nodes, rng);
+    std::cout << "Power-law graph: " << powerLaw.nodeCount() << " nodes, " << powerLaw.edgeCount() / 2 << " edges\n";
+    agreed = runSingleSource(powerLaw, 0) && agreed;
+    agreed = runQueries(powerLaw, randomPairs(powerLaw.nodeCount()), nullptr) && agreed;
+
+    if (!agreed) {
+        std::cerr << "shortest path methods disagreed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Database.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/LSMTree.h"
+
+// Storage engine benchmark: the in-memory shards with a write-ahead log and
+// checkpointed snapshots against the LSM engine.
+// Usage: bench_storage [--keys N] [--value-bytes B] [--gets N] [--sync]
+//   Loads N random keys, checkpoints, then times N gets (half of them for missing keys).
+//   Write amplification is bytes the process wrote (/proc/self/io) per byte of keys and
+//   values; where /proc is unavailable only the LSM engine's own count is shown.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Bytes passed to write()-family calls so far, or -1 without /proc
+long long processWriteBytes() {
+    std::ifstream io("/proc/self/io");
+    std::string field;
+    long long value;
+    while (io >> field >> value) {
+        if (field == "wchar:") return value;
+    }
+    return -1;
+}
+
+std::string makeKey(uint64_t id) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "user:%012llu", static_cast<unsigned long long>(id));
+    return buffer;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+struct Workload {
+    std::vector<uint64_t> ids;    // Keys loaded, in load order
+    std::vector<uint64_t> reads;  // Keys read; odd ids were never loaded
+    size_t valueBytes;
+};
+
+void run(const std::string& name, Database& db, const Workload& work, LSMTree* lsm) {
+    std::mt19937_64 rng(7);
+    std::string value(work.valueBytes, 'v');
+    uint64_t userBytes = 0;
+
+    long long writtenBefore = processWriteBytes();
+    auto start = Clock::now();
+    for (uint64_t id : work.ids) {
+        std::string key = makeKey(id);
+        for (size_t i = 0; i < 8 && i < value.size(); i++) value[i] = 'a' + rng() % 26;
+        db.insert(key, value);
+        userBytes += key.size() + value.size();
+    }
+    db.checkpoint();
+    if (lsm) lsm->waitForCompactions();
+    double loadSeconds = secondsSince(start);
+    long long written = processWriteBytes() - writtenBefore;
+
+    std::vector<double> hits;
+    std::vector<double> misses;
+    size_t found = 0;
+    for (uint64_t id : work.reads) {
+        std::string key = makeKey(id);
+        auto begin = Clock::now();
+        std::string result = db.get(key);
+        double micros = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+        (id % 2 ? misses : hits).push_back(micros);
+        found += !result.empty();
+    }
+
+    std::cout << std::setw(8) << name
+              << std::setw(12) << std::fixed << std::setprecision(0) << work.ids.size() / loadSeconds
+              << std::setw(10) << std::setprecision(2);
+    if (written >= 0) std::cout << double(written) / userBytes;
+    else std::cout << "n/a";
+    std::cout << std::setw(10) << std::setprecision(1) << percentile(hits, 0.5)
+              << std::setw(10) << percentile(hits, 0.99)
+              << std::setw(10) << percentile(misses, 0.5)
+              << std::setw(10) << percentile(misses, 0.99) << "\n";
+
+    if (lsm) {
+        StorageEngineStats stats = lsm->stats();
+        std::cout << "         engine-counted write amplification " << std::setprecision(2)
+                  << stats.writeAmplification() << " (log " << stats.logBytes << ", flush "
+                  << stats.flushBytes << ", compaction " << stats.compactionBytes << " bytes); levels:";
+        for (size_t level = 0; level < stats.runsPerLevel.size(); level++) {
+            std::cout << " L" << level << "=" << stats.runsPerLevel[level];
+        }
+        std::cout << "; bloom skipped " << stats.bloomNegatives << " of "
+                  << stats.bloomNegatives + stats.runProbes << " run probes\n";
+    }
+    if (found != hits.size()) {
+        std::cerr << name << ": found " << found << " of " << hits.size() << " loaded keys" << std::endl;
+        std::exit(1);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t keyCount = 500000;
+    size_t valueBytes = 100;
+    size_t getCount = 200000;
+    bool syncWrites = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc) {
+            keyCount = std::stoul(argv[++i]);
+        } else if (arg == "--value-bytes" && i + 1 < argc) {
+            valueBytes = std::stoul(argv[++i]);
+        } else if (arg == "--gets" && i + 1 < argc) {
+            getCount = std::stoul(argv[++i]);
+        } else if (arg == "--sync") {
+            syncWrites = true;
+        }
+    }
+
+    // Even ids are loaded (shuffled, so flushes overlap); reads mix them with odd ids
+    Workload work;
+    work.valueBytes = valueBytes;
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < keyCount; i++) work.ids.push_back(2 * i);
+    std::shuffle(work.ids.begin(), work.ids.end(), rng);
+    for (size_t i = 0; i < getCount; i++) work.reads.push_back(rng() % (2 * keyCount));
+
+    WALOptions walOptions;
+    walOptions.syncOnCommit = syncWrites;
+
+    std::cout << "Keys: " << keyCount << " | Value bytes: " << valueBytes << " | Gets: " << getCount
+              << " | Sync writes: " << (syncWrites ? "yes" : "no") << "\n";
+    std::cout << std::setw(8) << "engine" << std::setw(12) << "puts/sec" << std::setw(10) << "write amp"
+              << std::setw(10) << "hit p50" << std::setw(10) << "hit p99"
+              << std::setw(10) << "miss p50" << std::setw(10) << "miss p99" << "  (get latency in us)\n";
+
+    const std::string path = "bench_storage.json";
+    auto cleanup = [&] {
+        for (const std::string suffix : {"", ".wal", ".wal.ckpt", ".tmp", ".lsm"}) {
+            std::filesystem::remove_all(path + suffix);
+        }
+    };
+
+    cleanup();
+    {
+        Database db(path);
+        db.enableWAL(walOptions);
+        run("hash", db, work, nullptr);
+    }
+    cleanup();
+    {
+        Database db(path);
+        LSMOptions options;
+        options.wal = walOptions;
+        auto engine = std::make_unique<LSMTree>(path + ".lsm", options);
+        LSMTree* lsm = engine.get();
+        if (!db.setStorageEngine(std::move(engine))) {
+            std::cerr << "Failed to open LSM engine" << std::endl;
+            return 1;
+        }
+        run("lsm", db, work, lsm);
+    }
+    cleanup();
+    return 0;
+}
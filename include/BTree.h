@@ -4,138 +4,674 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
 
+// Fixed-width, order-preserving key prefixes. Nodes keep these in a flat array next to
+// the keys so most comparisons during a search touch only that array and stay in L1/L2;
+// the full key is compared only when two prefixes tie.
+template <typename T, typename = void>
+struct BTreeKeyTraits {
+    static uint64_t prefix(const T&) { return 0; }
+};
+
+// Any string-like key (std::string, InternedString, ...)
 template <typename T>
-class BTreeNode {
-public:
+struct BTreeKeyTraits<T, std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>> {
+    // First 8 bytes, big-endian and zero-padded, so integer order matches byte order
+    static uint64_t prefix(std::string_view key) {
+        uint64_t p = 0;
+        size_t n = std::min<size_t>(key.size(), 8);
+        for (size_t i = 0; i < 8; i++) {
+            p <<= 8;
+            if (i < n) p |= static_cast<unsigned char>(key[i]);
+        }
+        return p;
+    }
+};
+
+// A B+tree node. Leaves hold every key and are doubly linked for range scans;
+// inner nodes hold separators, where keys[i] <= everything under children[i + 1].
+template <typename T, size_t Capacity>
+struct alignas(64) BTreeNode {
     bool isLeaf;
-    std::vector<T> keys;
-    std::vector<BTreeNode<T>*> children;
+    uint16_t count;
+    BTreeNode* next;  // Leaves only
+    BTreeNode* prev;  // Leaves only
+    uint64_t prefixes[Capacity];
+    T keys[Capacity];
+    BTreeNode* children[Capacity + 1];  // Inner nodes only
 
-    BTreeNode(bool leaf) : isLeaf(leaf) {}
+    explicit BTreeNode(bool leaf) : isLeaf(leaf), count(0), next(nullptr), prev(nullptr) {}
+};
 
-    // 🛠️ Mark traverse as const
-    void traverse() const {
-        int i;
-        for (i = 0; i < keys.size(); i++) {
-            if (!isLeaf)
-                children[i]->traverse();
-            std::cout << " " << keys[i];
+// Slab allocator for tree nodes: nodes are carved out of cache-line-aligned slabs and
+// recycled through a free list instead of going through new/delete one at a time.
+// Slabs start at one node and double up to MAX_NODES_PER_SLAB, so a small tree only
+// reserves about twice the nodes it uses.
+template <typename Node>
+class NodePool {
+private:
+    static constexpr size_t MAX_NODES_PER_SLAB = 64;
+    std::vector<Node*> slabs;
+    std::vector<Node*> freeList;
+    size_t nextSlabNodes = 1;
+    size_t reservedNodes = 0;
+
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    NodePool(NodePool&& other) noexcept
+        : slabs(std::move(other.slabs)), freeList(std::move(other.freeList)),
+          nextSlabNodes(other.nextSlabNodes), reservedNodes(other.reservedNodes) {
+        other.nextSlabNodes = 1;
+        other.reservedNodes = 0;
+    }
+    NodePool& operator=(NodePool&& other) noexcept {
+        if (this != &other) {
+            releaseSlabs();
+            slabs = std::move(other.slabs);
+            freeList = std::move(other.freeList);
+            nextSlabNodes = other.nextSlabNodes;
+            reservedNodes = other.reservedNodes;
+            other.nextSlabNodes = 1;
+            other.reservedNodes = 0;
         }
-        if (!isLeaf)
-            children[i]->traverse();
+        return *this;
     }
+    ~NodePool() { releaseSlabs(); }
 
-    // 🛠️ Add `t` as parameter
-    void insertNonFull(const T& key, int t);
-    void splitChild(int i, BTreeNode<T>* y, int t);
-    bool remove(const T& key);
-    std::vector<T> rangeSearch(const T& prefix) const;
+    template <typename... Args>
+    Node* allocate(Args&&... args) {
+        if (freeList.empty()) {
+            size_t count = nextSlabNodes;
+            void* raw = ::operator new(sizeof(Node) * count, std::align_val_t(alignof(Node)));
+            Node* slab = static_cast<Node*>(raw);
+            slabs.push_back(slab);
+            for (size_t i = count; i > 0; i--) freeList.push_back(slab + i - 1);
+            reservedNodes += count;
+            nextSlabNodes = std::min(count * 2, MAX_NODES_PER_SLAB);
+        }
+        Node* node = freeList.back();
+        freeList.pop_back();
+        return new (node) Node(std::forward<Args>(args)...);
+    }
+
+    void release(Node* node) {
+        node->~Node();
+        freeList.push_back(node);
+    }
+
+    // Every live node must already have been released
+    void releaseSlabs() {
+        for (Node* slab : slabs) {
+            ::operator delete(slab, std::align_val_t(alignof(Node)));
+        }
+        slabs.clear();
+        freeList.clear();
+        nextSlabNodes = 1;
+        reservedNodes = 0;
+    }
+
+    size_t bytesReserved() const { return reservedNodes * sizeof(Node); }
 };
 
-template <typename T>
+// Ordered set of unique keys stored as a B+tree
+template <typename T, size_t Capacity = 32>
 class BTree {
+public:
+    using Node = BTreeNode<T, Capacity>;
+    using Traits = BTreeKeyTraits<T>;
+
+    static_assert(Capacity >= 4, "B+tree nodes need room for at least four keys");
+    static constexpr size_t MIN_KEYS = (Capacity - 1) / 2;
+    // insertSorted() rebuilds once the run is at least 1/MERGE_RATIO of the tree; below
+    // that, rewriting every leaf costs more than descending once per key
+    static constexpr size_t MERGE_RATIO = 2;
+
+    // Bidirectional iterator over the linked leaves
+    class Iterator {
+    private:
+        const BTree* tree;
+        const Node* leaf;
+        size_t index;
+
+    public:
+        Iterator(const BTree* tree, const Node* leaf, size_t index)
+            : tree(tree), leaf(leaf), index(index) {}
+
+        const T& operator*() const { return leaf->keys[index]; }
+        const T* operator->() const { return &leaf->keys[index]; }
+        bool operator==(const Iterator& other) const { return leaf == other.leaf && index == other.index; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+        Iterator& operator++() {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        // Decrementing end() lands on the largest key
+        Iterator& operator--() {
+            if (!leaf) {
+                leaf = tree->lastLeaf();
+                index = leaf ? leaf->count - 1 : 0;
+            } else if (index == 0) {
+                leaf = leaf->prev;
+                index = leaf ? leaf->count - 1 : 0;
+            } else {
+                index--;
+            }
+            return *this;
+        }
+    };
+
 private:
-    BTreeNode<T>* root;
-    int t;  // Minimum degree
+    Node* root;
+    size_t count;
+    NodePool<Node> pool;
+
+    // Searches accept any key type K comparable with T (e.g. std::string_view for string keys)
+    template <typename K>
+    static bool lessAt(const Node* node, size_t i, const K& key, uint64_t p) {
+        if (node->prefixes[i] != p) return node->prefixes[i] < p;
+        return node->keys[i] < key;
+    }
+
+    template <typename K>
+    static bool greaterAt(const Node* node, size_t i, const K& key, uint64_t p) {
+        if (node->prefixes[i] != p) return node->prefixes[i] > p;
+        return key < node->keys[i];
+    }
+
+    // First slot whose key is >= key
+    template <typename K>
+    static size_t lowerBoundIn(const Node* node, const K& key, uint64_t p) {
+        size_t lo = 0, hi = node->count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (lessAt(node, mid, key, p)) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+
+    // First slot whose key is > key (the child to descend into)
+    template <typename K>
+    static size_t upperBoundIn(const Node* node, const K& key, uint64_t p) {
+        size_t lo = 0, hi = node->count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (greaterAt(node, mid, key, p)) hi = mid; else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    static void moveSlot(Node* from, size_t i, Node* to, size_t j) {
+        to->keys[j] = std::move(from->keys[i]);
+        to->prefixes[j] = from->prefixes[i];
+    }
+
+    static void insertSlot(Node* node, size_t i, const T& key, uint64_t p) {
+        for (size_t k = node->count; k > i; k--) moveSlot(node, k - 1, node, k);
+        node->keys[i] = key;
+        node->prefixes[i] = p;
+        node->count++;
+    }
+
+    static void eraseSlot(Node* node, size_t i) {
+        for (size_t k = i; k + 1 < node->count; k++) moveSlot(node, k + 1, node, k);
+        node->keys[node->count - 1] = T();
+        node->count--;
+    }
+
+    static void insertChild(Node* node, size_t i, Node* child) {
+        for (size_t k = node->count + 1; k > i; k--) node->children[k] = node->children[k - 1];
+        node->children[i] = child;
+    }
+
+    static void eraseChild(Node* node, size_t i) {
+        for (size_t k = i; k < node->count; k++) node->children[k] = node->children[k + 1];
+    }
+
+    static const T& minKey(const Node* node) {
+        while (!node->isLeaf) node = node->children[0];
+        return node->keys[0];
+    }
+
+    const Node* lastLeaf() const {
+        const Node* node = root;
+        while (node && !node->isLeaf) node = node->children[node->count];
+        return node;
+    }
+
+    void destroy(Node* node) {
+        if (!node) return;
+        if (!node->isLeaf) {
+            for (size_t i = 0; i <= node->count; i++) destroy(node->children[i]);
+        }
+        pool.release(node);
+    }
+
+    bool insertInto(Node* node, const T& key, uint64_t p, T& splitKey, uint64_t& splitPrefix, Node*& splitNode);
+    template <typename K>
+    bool removeFrom(Node* node, const K& key, uint64_t p);
+    void rebalanceChild(Node* parent, size_t i);
+    Node* buildInnerLevels(std::vector<Node*> level);
+    // Bulk load: append keys in ascending order (a repeat of the last is dropped), then
+    // even out the last leaf and build the inner levels
+    void appendLoaded(std::vector<Node*>& leaves, T key, uint64_t p);
+    void finishLoad(std::vector<Node*> leaves);
 
 public:
-    BTree(int _t) : root(nullptr), t(_t) {}
+    BTree() : root(nullptr), count(0) {}
 
-    void traverse() const {
-        if (root) root->traverse();
+    // Bulk load from a range sorted in ascending order, building the tree bottom-up
+    // in O(n) with packed nodes; repeated keys are kept once
+    template <typename InputIt>
+    BTree(InputIt first, InputIt last);
+    ~BTree() { destroy(root); }
+
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+    BTree(BTree&& other) noexcept
+        : root(other.root), count(other.count), pool(std::move(other.pool)) {
+        other.root = nullptr;
+        other.count = 0;
     }
+    BTree& operator=(BTree&& other) noexcept {
+        if (this != &other) {
+            destroy(root);
+            pool = std::move(other.pool);
+            root = other.root;
+            count = other.count;
+            other.root = nullptr;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void clear() {
+        destroy(root);
+        pool.releaseSlabs();
+        root = nullptr;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t memoryUsage() const { return sizeof(*this) + pool.bytesReserved(); }
+
+    bool insert(const T& key);   // False if the key was already present
+    // Insert a range sorted in ascending order; returns how many keys were new. A run
+    // that is large next to the tree is merged with the leaves in one pass and bulk
+    // loaded, instead of descending once per key.
+    template <typename InputIt>
+    size_t insertSorted(InputIt first, InputIt last);
+    template <typename K>
+    bool remove(const K& key);   // False if the key was not present
+    template <typename K>
+    bool contains(const K& key) const;
+
+    Iterator begin() const {
+        const Node* node = root;
+        while (node && !node->isLeaf) node = node->children[0];
+        return Iterator(this, node && node->count ? node : nullptr, 0);
+    }
+    Iterator end() const { return Iterator(this, nullptr, 0); }
+    template <typename K>
+    Iterator lowerBound(const K& key) const;
+
+    // All keys starting with `prefix`, in order: one descent plus a leaf walk
+    std::vector<T> rangeSearch(std::string_view prefix) const;
 
-    void insert(const T& key);
-    void remove(const T& key);
-    std::vector<T> rangeSearch(const T& prefix) const;
+    void traverse() const {
+        for (auto it = begin(); it != end(); ++it) std::cout << " " << *it;
+    }
 };
 
-// 🛠️ Insert key into B-Tree
-template <typename T>
-void BTree<T>::insert(const T& key) {
-    if (!root) {
-        root = new BTreeNode<T>(true);
-        root->keys.push_back(key);
-    } else {
-        if (root->keys.size() == 2 * t - 1) {
-            BTreeNode<T>* s = new BTreeNode<T>(false);
-            s->children.push_back(root);
-            s->splitChild(0, root, t);  // Pass `t` to splitChild
-            int i = (s->keys[0] < key) ? 1 : 0;
-            s->children[i]->insertNonFull(key, t);  // Pass `t` to insertNonFull
-            root = s;
-        } else {
-            root->insertNonFull(key, t);  // Pass `t` to insertNonFull
+// 🛠️ Bulk load: fill leaves left to right, then stack inner levels on top
+template <typename T, size_t Capacity>
+template <typename InputIt>
+BTree<T, Capacity>::BTree(InputIt first, InputIt last) : root(nullptr), count(0) {
+    std::vector<Node*> leaves;
+    for (; first != last; ++first) {
+        T key = *first;
+        uint64_t p = Traits::prefix(key);
+        appendLoaded(leaves, std::move(key), p);
+    }
+    finishLoad(std::move(leaves));
+}
+
+template <typename T, size_t Capacity>
+void BTree<T, Capacity>::appendLoaded(std::vector<Node*>& leaves, T key, uint64_t p) {
+    Node* leaf = leaves.empty() ? nullptr : leaves.back();
+    if (leaf && leaf->prefixes[leaf->count - 1] == p && leaf->keys[leaf->count - 1] == key) return;
+    if (!leaf || leaf->count == Capacity) {
+        Node* next = pool.allocate(true);
+        if (leaf) {
+            leaf->next = next;
+            next->prev = leaf;
         }
+        leaves.push_back(next);
+        leaf = next;
     }
+    leaf->keys[leaf->count] = std::move(key);
+    leaf->prefixes[leaf->count] = p;
+    leaf->count++;
+    count++;
 }
 
-// 🛠️ Remove key from B-Tree
-template <typename T>
-void BTree<T>::remove(const T& key) {
-    if (!root) return;
-    root->remove(key);
+template <typename T, size_t Capacity>
+void BTree<T, Capacity>::finishLoad(std::vector<Node*> leaves) {
+    if (leaves.empty()) return;
+
+    // Only the last leaf can be short; even it out with its full left neighbour
+    Node* leaf = leaves.back();
+    if (leaves.size() > 1 && leaf->count < MIN_KEYS) {
+        Node* left = leaves[leaves.size() - 2];
+        size_t shift = (left->count - leaf->count) / 2;
+        for (size_t k = leaf->count; k > 0; k--) moveSlot(leaf, k - 1, leaf, k - 1 + shift);
+        for (size_t k = 0; k < shift; k++) moveSlot(left, left->count - shift + k, leaf, k);
+        left->count = static_cast<uint16_t>(left->count - shift);
+        leaf->count = static_cast<uint16_t>(leaf->count + shift);
+    }
+    root = buildInnerLevels(std::move(leaves));
 }
 
-// 🛠️ Range search for prefix in B-Tree
-template <typename T>
-std::vector<T> BTree<T>::rangeSearch(const T& prefix) const {
-    std::vector<T> results;
-    if (root) {
-        std::function<void(BTreeNode<T>*)> search = [&](BTreeNode<T>* node) {
-            for (const T& key : node->keys) {
-                if (key.find(prefix) == 0) results.push_back(key);
-            }
-            for (auto child : node->children) {
-                if (child) search(child);
+// Spread each level's nodes evenly over the fewest parents that can hold them,
+// which keeps every parent at least half full
+template <typename T, size_t Capacity>
+typename BTree<T, Capacity>::Node* BTree<T, Capacity>::buildInnerLevels(std::vector<Node*> level) {
+    while (level.size() > 1) {
+        size_t parents = (level.size() + Capacity) / (Capacity + 1);
+        std::vector<Node*> next;
+        next.reserve(parents);
+        size_t begin = 0;
+        for (size_t i = 0; i < parents; i++) {
+            size_t end = level.size() * (i + 1) / parents;
+            Node* parent = pool.allocate(false);
+            parent->children[0] = level[begin];
+            for (size_t k = begin + 1; k < end; k++) {
+                parent->keys[k - begin - 1] = minKey(level[k]);
+                parent->prefixes[k - begin - 1] = Traits::prefix(parent->keys[k - begin - 1]);
+                parent->children[k - begin] = level[k];
             }
-        };
-        search(root);
+            parent->count = static_cast<uint16_t>(end - begin - 1);
+            next.push_back(parent);
+            begin = end;
+        }
+        level.swap(next);
     }
-    return results;
+    return level[0];
 }
 
-// 🛠️ Insert non-full with `t`
-template <typename T>
-void BTreeNode<T>::insertNonFull(const T& key, int t) {
-    int i = keys.size() - 1;
-    if (isLeaf) {
-        keys.insert(keys.begin() + (i + 1), key);
-    } else {
-        while (i >= 0 && keys[i] > key) i--;
-        if (children[i + 1]->keys.size() == 2 * t - 1) {
-            splitChild(i + 1, children[i + 1], t);  // Pass `t` to splitChild
-            if (keys[i + 1] < key) i++;
+// 🛠️ Insert a key, splitting full nodes on the way back up
+template <typename T, size_t Capacity>
+bool BTree<T, Capacity>::insert(const T& key) {
+    uint64_t p = Traits::prefix(key);
+    if (!root) {
+        root = pool.allocate(true);
+        insertSlot(root, 0, key, p);
+        count = 1;
+        return true;
+    }
+
+    T splitKey;
+    uint64_t splitPrefix = 0;
+    Node* splitNode = nullptr;
+    if (!insertInto(root, key, p, splitKey, splitPrefix, splitNode)) return false;
+
+    if (splitNode) {
+        Node* newRoot = pool.allocate(false);
+        newRoot->keys[0] = std::move(splitKey);
+        newRoot->prefixes[0] = splitPrefix;
+        newRoot->children[0] = root;
+        newRoot->children[1] = splitNode;
+        newRoot->count = 1;
+        root = newRoot;
+    }
+    count++;
+    return true;
+}
+
+// 🛠️ Sorted insert: key by key for a small run, else merge and rebuild. The merge
+// moves the keys out of the old leaves straight into the new ones.
+template <typename T, size_t Capacity>
+template <typename InputIt>
+size_t BTree<T, Capacity>::insertSorted(InputIt first, InputIt last) {
+    size_t before = count;
+    if (static_cast<size_t>(std::distance(first, last)) * MERGE_RATIO < count) {
+        for (; first != last; ++first) insert(*first);
+        return count - before;
+    }
+
+    BTree merged;
+    std::vector<Node*> leaves;
+    Node* leaf = root;
+    while (leaf && !leaf->isLeaf) leaf = leaf->children[0];
+    if (leaf && !leaf->count) leaf = nullptr;
+    size_t i = 0;
+    uint64_t p = first != last ? Traits::prefix(*first) : 0;
+    while (leaf || first != last) {
+        // On a tie the tree's key goes first and the run's copy is dropped as a repeat;
+        // prefixes settle most comparisons without reading either key
+        if (leaf && (first == last || !greaterAt(leaf, i, *first, p))) {
+            merged.appendLoaded(leaves, std::move(leaf->keys[i]), leaf->prefixes[i]);
+            if (++i == leaf->count) {
+                leaf = leaf->next;
+                i = 0;
+            }
+        } else {
+            merged.appendLoaded(leaves, *first, p);
+            if (++first != last) p = Traits::prefix(*first);
         }
-        children[i + 1]->insertNonFull(key, t);  // Pass `t` to insertNonFull
     }
+    merged.finishLoad(std::move(leaves));
+    *this = std::move(merged);
+    return count - before;
 }
 
-// 🛠️ Split child with `t`
-template <typename T>
-void BTreeNode<T>::splitChild(int i, BTreeNode<T>* y, int t) {
-    BTreeNode<T>* z = new BTreeNode<T>(y->isLeaf);
-    z->keys.insert(z->keys.begin(), y->keys.begin() + t, y->keys.end());
-    if (!y->isLeaf)
-        z->children.insert(z->children.begin(), y->children.begin() + t, y->children.end());
+template <typename T, size_t Capacity>
+bool BTree<T, Capacity>::insertInto(Node* node, const T& key, uint64_t p,
+                                    T& splitKey, uint64_t& splitPrefix, Node*& splitNode) {
+    if (node->isLeaf) {
+        size_t i = lowerBoundIn(node, key, p);
+        if (i < node->count && node->prefixes[i] == p && node->keys[i] == key) return false;
 
-    y->keys.resize(t - 1);
-    y->children.resize(t);
+        if (node->count < Capacity) {
+            insertSlot(node, i, key, p);
+            return true;
+        }
+
+        // Split the full leaf in half and link the new right half in
+        Node* right = pool.allocate(true);
+        size_t mid = Capacity / 2;
+        for (size_t k = mid; k < Capacity; k++) moveSlot(node, k, right, k - mid);
+        right->count = static_cast<uint16_t>(Capacity - mid);
+        node->count = static_cast<uint16_t>(mid);
+        right->next = node->next;
+        right->prev = node;
+        if (node->next) node->next->prev = right;
+        node->next = right;
+
+        if (i <= mid) insertSlot(node, i, key, p); else insertSlot(right, i - mid, key, p);
+        splitKey = right->keys[0];
+        splitPrefix = right->prefixes[0];
+        splitNode = right;
+        return true;
+    }
 
-    children.insert(children.begin() + i + 1, z);
-    keys.insert(keys.begin() + i, y->keys[t - 1]);
+    size_t ci = upperBoundIn(node, key, p);
+    T childKey;
+    uint64_t childPrefix = 0;
+    Node* childSplit = nullptr;
+    if (!insertInto(node->children[ci], key, p, childKey, childPrefix, childSplit)) return false;
+    if (!childSplit) return true;
+
+    if (node->count < Capacity) {
+        insertSlot(node, ci, childKey, childPrefix);
+        insertChild(node, ci + 1, childSplit);
+        return true;
+    }
+
+    // Split the full inner node; its middle separator moves up to the parent
+    Node* right = pool.allocate(false);
+    size_t mid = Capacity / 2;
+    for (size_t k = mid + 1; k < Capacity; k++) moveSlot(node, k, right, k - mid - 1);
+    for (size_t k = mid + 1; k <= Capacity; k++) right->children[k - mid - 1] = node->children[k];
+    right->count = static_cast<uint16_t>(Capacity - mid - 1);
+    splitKey = std::move(node->keys[mid]);
+    splitPrefix = node->prefixes[mid];
+    node->count = static_cast<uint16_t>(mid);
+
+    Node* target = (ci <= mid) ? node : right;
+    size_t ti = (ci <= mid) ? ci : ci - mid - 1;
+    insertSlot(target, ti, childKey, childPrefix);
+    insertChild(target, ti + 1, childSplit);
+    splitNode = right;
+    return true;
 }
 
-// 🛠️ Remove key (dummy implementation for now)
-template <typename T>
-bool BTreeNode<T>::remove(const T& key) {
-    auto it = std::find(keys.begin(), keys.end(), key);
-    if (it != keys.end()) {
-        keys.erase(it);
+// 🛠️ Remove a key, borrowing from or merging with siblings when a node underflows
+template <typename T, size_t Capacity>
+template <typename K>
+bool BTree<T, Capacity>::remove(const K& key) {
+    if (!root) return false;
+    if (!removeFrom(root, key, Traits::prefix(key))) return false;
+    count--;
+
+    if (root->count == 0) {
+        Node* old = root;
+        root = root->isLeaf ? nullptr : root->children[0];
+        pool.release(old);
+    }
+    return true;
+}
+
+template <typename T, size_t Capacity>
+template <typename K>
+bool BTree<T, Capacity>::removeFrom(Node* node, const K& key, uint64_t p) {
+    if (node->isLeaf) {
+        size_t i = lowerBoundIn(node, key, p);
+        if (i == node->count || node->prefixes[i] != p || !(node->keys[i] == key)) return false;
+        eraseSlot(node, i);
         return true;
     }
-    return false;
+
+    size_t ci = upperBoundIn(node, key, p);
+    if (!removeFrom(node->children[ci], key, p)) return false;
+    if (node->children[ci]->count < MIN_KEYS) rebalanceChild(node, ci);
+    return true;
+}
+
+template <typename T, size_t Capacity>
+void BTree<T, Capacity>::rebalanceChild(Node* parent, size_t i) {
+    Node* child = parent->children[i];
+    Node* left = i > 0 ? parent->children[i - 1] : nullptr;
+    Node* right = i < parent->count ? parent->children[i + 1] : nullptr;
+
+    if (left && left->count > MIN_KEYS) {
+        // Borrow the largest entry of the left sibling
+        if (child->isLeaf) {
+            insertSlot(child, 0, left->keys[left->count - 1], left->prefixes[left->count - 1]);
+            eraseSlot(left, left->count - 1);
+            parent->keys[i - 1] = child->keys[0];
+            parent->prefixes[i - 1] = child->prefixes[0];
+        } else {
+            insertSlot(child, 0, parent->keys[i - 1], parent->prefixes[i - 1]);
+            child->count--;  // insertChild works on the pre-insert count
+            insertChild(child, 0, left->children[left->count]);
+            child->count++;
+            parent->keys[i - 1] = left->keys[left->count - 1];
+            parent->prefixes[i - 1] = left->prefixes[left->count - 1];
+            eraseSlot(left, left->count - 1);
+        }
+        return;
+    }
+
+    if (right && right->count > MIN_KEYS) {
+        // Borrow the smallest entry of the right sibling
+        if (child->isLeaf) {
+            insertSlot(child, child->count, right->keys[0], right->prefixes[0]);
+            eraseSlot(right, 0);
+            parent->keys[i] = right->keys[0];
+            parent->prefixes[i] = right->prefixes[0];
+        } else {
+            insertSlot(child, child->count, parent->keys[i], parent->prefixes[i]);
+            child->children[child->count] = right->children[0];
+            parent->keys[i] = right->keys[0];
+            parent->prefixes[i] = right->prefixes[0];
+            eraseChild(right, 0);
+            eraseSlot(right, 0);
+        }
+        return;
+    }
+
+    // Merge with a sibling: always fold the right node of the pair into the left one
+    size_t sep = left ? i - 1 : i;
+    Node* into = left ? left : child;
+    Node* from = left ? child : right;
+
+    if (into->isLeaf) {
+        for (size_t k = 0; k < from->count; k++) moveSlot(from, k, into, into->count + k);
+        into->count = static_cast<uint16_t>(into->count + from->count);
+        into->next = from->next;
+        if (from->next) from->next->prev = into;
+    } else {
+        into->keys[into->count] = std::move(parent->keys[sep]);
+        into->prefixes[into->count] = parent->prefixes[sep];
+        size_t base = into->count + 1;
+        for (size_t k = 0; k < from->count; k++) moveSlot(from, k, into, base + k);
+        for (size_t k = 0; k <= from->count; k++) into->children[base + k] = from->children[k];
+        into->count = static_cast<uint16_t>(base + from->count);
+    }
+    from->count = 0;
+    pool.release(from);
+
+    eraseChild(parent, sep + 1);
+    eraseSlot(parent, sep);
+}
+
+// 🛠️ Exact-match lookup
+template <typename T, size_t Capacity>
+template <typename K>
+bool BTree<T, Capacity>::contains(const K& key) const {
+    auto it = lowerBound(key);
+    return it != end() && *it == key;
+}
+
+// 🛠️ Position of the first key >= key
+template <typename T, size_t Capacity>
+template <typename K>
+typename BTree<T, Capacity>::Iterator BTree<T, Capacity>::lowerBound(const K& key) const {
+    if (!root) return end();
+    uint64_t p = Traits::prefix(key);
+    const Node* node = root;
+    while (!node->isLeaf) node = node->children[upperBoundIn(node, key, p)];
+
+    size_t i = lowerBoundIn(node, key, p);
+    if (i == node->count) return Iterator(this, node->next, 0);
+    return Iterator(this, node, i);
+}
+
+// 🛠️ Range search for prefix in B+tree
+template <typename T, size_t Capacity>
+std::vector<T> BTree<T, Capacity>::rangeSearch(std::string_view prefix) const {
+    std::vector<T> results;
+    for (auto it = lowerBound(prefix); it != end(); ++it) {
+        if (std::string_view(*it).compare(0, prefix.size(), prefix) != 0) break;
+        results.push_back(*it);
+    }
+    return results;
 }
 
 #endif
@@ -0,0 +1,93 @@
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Where one blob lives in the blob file, plus its content hash. Values stored out of
+// line are replaced everywhere (shards, WAL, snapshots, commits) by this reference,
+// encoded in TypedValue's header space as MARKER, TAG, offset, length, hash (in host
+// byte order, like the binary snapshot). A user string never encodes like this:
+// TypedValue gives any string starting with MARKER a STRING header.
+struct BlobRef {
+    static constexpr char TAG = 'B';
+    static constexpr size_t ENCODED_BYTES = 2 + 8 + 4 + 8;
+
+    uint64_t offset = 0;
+    uint32_t length = 0;
+    uint64_t hash = 0;
+
+    std::string encode() const;
+    static bool decode(std::string_view stored, BlobRef& ref);  // False if not a reference
+};
+
+struct BlobStoreStats {
+    size_t blobs = 0;
+    uint64_t fileBytes = 0;
+    uint64_t dedupHits = 0;    // put() calls answered with an existing blob
+    uint64_t bytesSaved = 0;   // What those calls would have appended
+};
+
+// Append-only file of large values, deduplicated by content hash. Each record is the
+// hash, the length and the bytes; reopening scans the headers to rebuild the hash
+// index and drops a torn tail. Reads view the file through read-only mappings that
+// reserve room to grow, and a mapping is only replaced (never unmapped) while the
+// store is open, so views stay valid until close. Blobs are never reclaimed: commits
+// may still refer to a value long after the live table has dropped it.
+class BlobStore {
+private:
+    struct Mapping {
+        const char* base;
+        uint64_t length;
+    };
+
+    std::string path;
+    int fd;
+    bool syncWrites;
+    mutable std::mutex mutex;  // Appends, the hash index and remapping
+    std::unordered_multimap<uint64_t, BlobRef> byHash;
+    std::atomic<uint64_t> endOffset;  // Every blob below it is fully written
+    uint64_t dedupHits;
+    uint64_t bytesSaved;
+    mutable std::deque<Mapping> mappings;  // Newest last
+    mutable std::atomic<const Mapping*> current;
+
+    bool mapLocked(uint64_t needed) const;
+    std::string_view viewLocked(const BlobRef& ref) const;
+    bool recover();
+
+public:
+    explicit BlobStore(const std::string& path, bool syncWrites = true);
+    ~BlobStore();
+
+    BlobStore(const BlobStore&) = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+
+    bool open();  // Creates the file, or reopens it and rebuilds the index
+
+    // Store `value`, or find an identical blob already stored. With syncWrites the
+    // bytes are on disk before the reference is returned, so a logged reference
+    // never outlives its blob. False on I/O error.
+    bool put(std::string_view value, BlobRef& ref);
+    bool find(std::string_view value, BlobRef& ref) const;  // Lookup only
+
+    // The blob's bytes in place (empty if `ref` is out of range); valid until close
+    std::string_view view(const BlobRef& ref) const;
+
+    // Write the bytes [offset, offset + length) of the file to `outFd` without copying
+    // them through user space where the platform allows (sendfile on Linux)
+    bool sendTo(int outFd, uint64_t offset, uint64_t length) const;
+
+    bool sync() const;
+    BlobStoreStats stats() const;
+    const std::string& getPath() const { return path; }
+};
+
+#endif
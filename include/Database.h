@@ -6,56 +6,463 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include<set>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_set>
+#include <string_view>
 #include "/Users/gaganphadke/Versioning/versioned-db/include/BTree.h"  // Include B-Tree header
+#include "/Users/gaganphadke/Versioning/versioned-db/include/WriteAheadLog.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Snapshot.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StringPool.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/SpillFile.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StorageEngine.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/TypedValue.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ValueSketch.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/FlatHashMap.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/BlobStore.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Query.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/PatternScan.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ShortestPath.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ParallelBFS.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/UnionFind.h"
 
-// Data type enumeration for flexible storage
-enum DataType {
-    STRING,
-    INTEGER,
-    FLOAT,
-    BOOLEAN,
-    ARRAY,
-    OBJECT
+using InternedSet = std::unordered_set<InternedString, InternedStringHash>;
+
+// Hash-based secondary index: indexer(value) -> keys, plus key -> indexed value
+// so updates and removals never have to search the postings
+struct SecondaryIndex {
+    std::function<std::string(const std::string&)> indexer;
+    std::unordered_map<InternedString, InternedSet, InternedStringHash> postings;
+    InternedMap reverse;
+
+    void put(const InternedString& key, const InternedString& indexed);
+    void erase(const InternedString& key);
+};
+
+// Inverted value index: value -> keys currently holding it. Built on first use
+// (so mapping a large snapshot stays cheap), then maintained on every write.
+struct InvertedValueIndex {
+    std::unordered_map<InternedString, InternedSet, InternedStringHash> postings;
+    size_t keyCount = 0;  // Keys across every posting, kept so memoryUsage() is O(1)
+    bool ready = false;
+
+    void link(const InternedString& key, const InternedString& value);
+    void unlink(const InternedString& key, std::string_view value);
+    std::vector<std::string> keysFor(std::string_view value) const;
+    void clear();
+    size_t memoryUsage() const;  // Approximate bytes held by the index, in O(1)
+};
+
+// Numeric index over INTEGER and FLOAT values: one B+tree ordered by (value, key) for
+// BETWEEN queries and one ordered by key for prefix aggregates. Values are read from
+// their fixed-width encoding, never parsed. Built on first use like InvertedValueIndex.
+struct NumericIndex {
+    struct ByValue {
+        double value = 0.0;
+        InternedString key;
+
+        friend bool operator<(const ByValue& a, const ByValue& b) {
+            return a.value < b.value || (a.value == b.value && a.key < b.key);
+        }
+        friend bool operator==(const ByValue& a, const ByValue& b) { return a.value == b.value && a.key == b.key; }
+    };
+
+    // String-like, so the B+tree keeps key prefixes and can seek to a key prefix
+    struct ByKey {
+        InternedString key;
+        double value = 0.0;
+
+        operator std::string_view() const { return key.view(); }
+        friend bool operator<(const ByKey& a, const ByKey& b) { return a.key < b.key; }
+        friend bool operator==(const ByKey& a, const ByKey& b) { return a.key == b.key; }
+        friend bool operator<(const ByKey& a, std::string_view b) { return a.key.view() < b; }
+        friend bool operator<(std::string_view a, const ByKey& b) { return a < b.key.view(); }
+    };
+
+    BTree<ByValue> byValue;
+    BTree<ByKey> byKey;
+    bool ready = false;
+
+    void link(const InternedString& key, std::string_view stored);    // No-op unless numeric
+    void unlink(const InternedString& key, std::string_view stored);
+    void clear();
+    size_t memoryUsage() const;
+};
+
+// count/min/max/sum over numeric values
+struct NumericSummary {
+    size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+
+    void add(double value);
+    double mean() const { return count ? sum / double(count) : 0.0; }
+};
+
+// Table statistics: exact entry and byte counts plus approximate value frequencies.
+// Built on first use, then kept current by every write at O(1) cost.
+struct TableStatistics {
+    size_t entries = 0;
+    uint64_t keyBytes = 0;
+    uint64_t valueBytes = 0;
+    HeavyHitters values;  // Over stored (encoded) values
+    bool ready = false;
+
+    void add(std::string_view key, std::string_view value);
+    void remove(std::string_view key, std::string_view value);
+    void clear();
+};
+
+// Value cache counters. Hits and misses count get() calls served from memory and
+// from the spill file; values read from a mapped snapshot are neither.
+struct CacheStats {
+    size_t budgetBytes = 0;  // 0 means unlimited: nothing is ever spilled
+    size_t residentBytes = 0;
+    size_t residentValues = 0;
+    size_t sharedBytes = 0;  // Resident but also held elsewhere, so spilling would free nothing
+    size_t spilledValues = 0;
+    size_t spillFileBytes = 0;
+    size_t spillGarbageBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+// Point-in-time statistics reported by the `stats` command
+struct DatabaseStats {
+    size_t entries = 0;
+    uint64_t keyBytes = 0;
+    uint64_t valueBytes = 0;
+    std::vector<std::pair<std::string, uint64_t>> topValues;  // Shown as by get(), most frequent first
+    bool topValuesExact = false;  // Storage engines report exact counts from a full scan
+    bool valueIndexReady = false;
+    size_t valueIndexDistinctValues = 0;
+    size_t valueIndexBytes = 0;
+    bool numericIndexReady = false;
+    size_t numericIndexEntries = 0;
+    size_t numericIndexBytes = 0;
+    size_t openSnapshots = 0;
+    size_t savedVersions = 0;  // Old values kept for open snapshots
+    StringPoolStats strings;  // Process-wide: shared by every Database and commit snapshot
+    CacheStats cache;
+    bool hasEngine = false;
+    StorageEngineStats engine;
+    bool hasBlobStore = false;
+    size_t blobThreshold = 0;
+    BlobStoreStats blobs;
+    size_t graphNodes = 0;
+    size_t graphEdges = 0;  // Directed entries: two per edge, one per self-loop
+    size_t graphPendingEdges = 0;
+    size_t graphComponents = 0;
+    size_t graphIndependentCycles = 0;  // Edges minus nodes plus components
+    bool graphComponentsStale = false;  // Edges were removed; the next component query recounts
+    size_t graphBytes = 0;
+};
+
+// How a Database::Cursor walks the data. KEY merges the key B+tree with the mapped
+// snapshot's sorted keys; HASH visits the snapshot and then each shard's table in
+// place, skipping the merge when the order doesn't matter.
+enum class CursorOrder {
+    KEY,
+    HASH
 };
 
-// Structure to hold index entries
-struct IndexEntry {
-    std::string key;
-    std::string value;
+struct CursorOptions {
+    CursorOrder order = CursorOrder::KEY;
+    std::string lo;          // Inclusive lower bound
+    std::string hi;          // Exclusive upper bound; empty means unbounded
+    bool reverse = false;    // KEY order only
+    size_t batchSize = 1024; // Entries fetched per refill from a storage engine
+
+    static CursorOptions all(CursorOrder order = CursorOrder::KEY);
+    static CursorOptions range(const std::string& lo, const std::string& hi, bool reverse = false);
+    static CursorOptions prefix(const std::string& prefix, bool reverse = false);
 };
 
-struct Edge {
-    std::string to;
-    int weight;
+// A weighted shortest path between two graph nodes
+struct GraphPath {
+    bool found = false;  // False if either node is unknown or no path joins them
+    uint64_t distance = 0;
+    std::vector<std::string> nodes;  // from ... to
+    size_t settled = 0;              // Nodes the search settled
+};
 
-    // Comparator for set
-    bool operator<(const Edge& other) const {
-        return to < other.to;
-    }
+// A breadth-first traversal by node name (see ParallelBFS.h)
+struct GraphBfs {
+    std::vector<std::string> nodes;    // Level by level from the start
+    std::vector<size_t> levelOffsets;  // Level d is nodes[levelOffsets[d], levelOffsets[d + 1])
+    std::vector<std::string> parents;  // With BfsOptions::parents: each node's parent, the start its own
 };
-extern std::unordered_map<std::string, std::set<Edge>> graph;
 
 // Database class with B-Tree indexing
 class Database {
 private:
+    // One hash partition of the key space with its own reader-writer lock.
+    // With a mapped snapshot, `entries` holds only keys written since it was mapped
+    // and `maskedKeys` are this shard's snapshot keys overwritten or removed since.
+    // Keys and values are interned, so indexes and commits share their bytes.
+    // Under a memory budget each shard keeps its share of values resident and spills
+    // the rest; a CLOCK hand sweeps the table's slots to pick what to evict.
+    // `entries` is an open-addressing table hashed on key text, so a lookup by
+    // string_view goes straight to the slot without touching the intern pool.
+    struct ValueSlot {
+        InternedString value;  // Resident copy; invalid while the value is spilled
+        SpillRef spilled;      // Copy in the spill file, kept after a fault-in so re-eviction is free
+        mutable std::atomic<bool> referenced;  // CLOCK bit, set by readers under a shared lock
+
+        explicit ValueSlot(const InternedString& value) : value(value), referenced(true) {}
+        ValueSlot(ValueSlot&& other) noexcept
+            : value(std::move(other.value)), spilled(other.spilled),
+              referenced(other.referenced.load(std::memory_order_relaxed)) {}
+    };
+    using EntryMap = FlatHashMap<InternedString, ValueSlot, InternedTextHash>;
+
+    // A key's value from before write `seq` (invalid if the key didn't exist), kept
+    // while an open read snapshot may still need it
+    struct Version {
+        uint64_t seq;
+        InternedString value;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        EntryMap entries;
+        std::unordered_set<std::string> maskedKeys;
+        // Per-key version chains, oldest first; empty unless snapshots are open
+        std::unordered_map<InternedString, std::vector<Version>, InternedStringHash> versions;
+
+        size_t residentBytes = 0;
+        size_t spilledValues = 0;
+        // Resident bytes whose pool entry something else also holds (an index, a saved
+        // version, a commit, another key), as counted over the clock hand's last full
+        // turn. Dropping the slot's handle frees none of them, so they don't count
+        // against the budget. sharedSeen and sweptSlots track the turn in progress.
+        size_t sharedBytes = 0;
+        size_t sharedSeen = 0;
+        size_t sweptSlots = 0;
+        size_t clockHand = 0;  // Slot the next eviction sweep starts from
+
+        void recountShared() { sharedBytes = sharedSeen = sweptSlots = 0; }
+        mutable std::atomic<uint64_t> hits{0};
+        mutable std::atomic<uint64_t> misses{0};
+        uint64_t evictions = 0;
+    };
+
+    // Lock order: checkpointMutex -> resetMutex -> shards (ascending) -> indexMutex
     std::string filename;
-    std::unordered_map<std::string, std::string> data;
-    std::unordered_map<std::string, std::vector<IndexEntry>> indices;
-    mutable std::mutex dataMutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardMask;
+    std::unordered_map<std::string, SecondaryIndex> indices;
+    // Guards keyIndex, valueIndex, indices, valueKeys, numericIndex and statistics
+    mutable std::shared_mutex indexMutex;
+    mutable InvertedValueIndex valueKeys;  // Mutable: built lazily by queryByValue()
+    mutable NumericIndex numericIndex;     // Built lazily by the first numeric query
+    mutable TableStatistics statistics;    // Built lazily by the first getStats()
+
+    BTree<InternedString> keyIndex;    // B+tree of in-memory keys, used for prefix/range scans
+    mutable BTree<InternedString> valueIndex;  // B-Tree of values as get() shows them, built lazily
+    mutable bool valueIndexReady;
+
+    // Value cache: 0 keeps every value resident. Both are only changed with every
+    // shard locked exclusively, so any one shard lock is enough to read them.
+    size_t memoryBudget;
+    std::unique_ptr<SpillFile> spill;  // <filename>.values, opened with the first budget
+
+    // Write-ahead logging and background checkpointing
+    std::unique_ptr<WriteAheadLog> wal;
+    WALOptions walOptions;
+    mutable std::mutex checkpointMutex;  // Serializes checkpoints, exports and whole-database resets
+    std::mutex checkpointWaitMutex;
+    std::condition_variable checkpointCv;
+    bool stopCheckpointer;
+    std::thread checkpointer;
+    // Set once load() has replayed the log (or there was none): until then a checkpoint
+    // would write an empty snapshot over records that were never applied
+    std::atomic<bool> walReplayed;
+
+    // Memory-mapped binary snapshot; only replaced while every shard is locked exclusively
+    std::atomic<SnapshotFormat> snapshotFormat;
+    std::shared_ptr<const BinarySnapshot> mappedSnapshot;
+
+    // Pluggable storage backend; when set it owns every key and value
+    std::unique_ptr<StorageEngine> engine;
 
-    BTree<std::string> keyIndex;    // B-Tree for key indexing
-    BTree<std::string> valueIndex;  // B-Tree for value indexing
+    // Out-of-line values: set once before load() and kept across resets, since commit
+    // snapshots may still hold references into the file
+    std::unique_ptr<BlobStore> blobs;
+    size_t blobThreshold;
+
+    // MVCC: every write to the shards takes the next sequence number, and a read
+    // snapshot sees the writes numbered up to its own. While one is open, a write first
+    // saves the value it replaces in its shard's version chains; versions no open
+    // snapshot can read are dropped as snapshots close.
+    std::atomic<uint64_t> writeSeq;
+    mutable std::mutex snapshotMutex;          // Guards liveSnapshots
+    mutable std::multiset<uint64_t> liveSnapshots;
+    mutable std::atomic<size_t> openSnapshots;    // Read by writers under their shard lock
+    mutable std::atomic<uint64_t> newestSnapshot;
+    mutable std::atomic<size_t> savedVersions;
+    // Held shared by snapshot scans and exclusively by whole-database resets, so the
+    // mapped snapshot can't be swapped under a scan
+    mutable std::shared_mutex resetMutex;
+
+    // Undirected graph: each edge is stored in both directions. graphMutex is never
+    // held together with the other locks. Mutable: readers compact the delta buffer.
+    mutable Graph graph;
+    mutable std::shared_mutex graphMutex;
+    std::shared_lock<std::shared_mutex> lockGraphCompacted() const;  // Nothing pending while held
+
+    // Connected components of the graph, kept current by insertNode() and insertEdge().
+    // Edge removals and restores only mark them stale; the next call that needs them
+    // rebuilds them in one pass, however many removals came before. cycleEdges counts
+    // the edges that joined two nodes already connected. Guarded by graphMutex, held
+    // exclusively even to read, since lookups compress paths.
+    mutable UnionFind components;
+    mutable bool componentsStale = false;
+    mutable size_t cycleEdges = 0;
+    void syncComponentsLocked() const;
+
+    size_t shardIndexFor(std::string_view key) const;
+    Shard& shardFor(std::string_view key) const;
+    std::vector<std::unique_lock<std::shared_mutex>> lockAllShards() const;
+    std::vector<std::shared_lock<std::shared_mutex>> lockAllShardsShared() const;
+    void clearShardsLocked();
+
+    // A write's index work, gathered under its shard lock alone so indexMutex is only
+    // held while the shared index structures change
+    struct PreparedWrite {
+        InternedString key;
+        InternedString value;
+        bool replaced = false;
+        InternedString previous;              // The value it replaces, if a value index needs it
+        std::vector<InternedString> indexed;  // Secondary index keys, in `indices` order
+    };
 
     bool indexExists(const std::string& indexName) const;
-    void updateIndices(const std::string& key, const std::string& value);
-    void removeFromIndices(const std::string& key);
-    void buildBTreeIndices();  // Builds B-Tree indices
+    // Caller holds the key's shard, before the write is applied
+    PreparedWrite prepareWriteLocked(const Shard& shard, const InternedString& key,
+                                     const InternedString& value) const;
+    void applyWriteLocked(const PreparedWrite& write);  // Caller holds indexMutex
+    void removeFromIndices(const InternedString& key);
+    void removeFromIndicesBatch(const std::vector<InternedString>& keys);
+    void buildSecondaryIndex(SecondaryIndex& index) const;  // Caller holds every shard lock
+    void buildValueKeysLocked() const;  // Caller holds every shard lock and indexMutex
+    void buildBTreeIndices();  // Bulk loads the key B-Tree from the shards
+    void buildValueIndexLocked() const;  // Caller holds every shard lock and indexMutex
+    void buildNumericIndexLocked() const;  // Caller holds every shard lock and indexMutex
+    void ensureNumericIndex() const;
+    void buildStatisticsLocked() const;  // Caller holds every shard lock and indexMutex
+    // Take a removed value out of valueKeys, numericIndex and statistics (caller holds
+    // indexMutex); `internedKey` may be invalid if the key was never interned
+    void unlinkValueLocked(std::string_view key, const InternedString& internedKey, std::string_view previous);
+    bool writeSnapshot(const std::string& contents) const;  // Atomic temp-file + rename
+    void checkpointLoop();
+    bool checkpointLocked();
+
+    // MVCC helpers (caller holds the shard's lock; exclusively to save a version)
+    void saveVersionLocked(Shard& shard, std::string_view key, uint64_t seq, bool skipIfAbsent);
+    const Version* versionAtLocked(const Shard& shard, const InternedString& key, uint64_t seq) const;
+    const Version* versionAtLocked(const Shard& shard, std::string_view key, uint64_t seq) const;
+    uint64_t registerSnapshotLocked() const;  // Caller holds every shard lock
+    void releaseSnapshot(uint64_t seq) const;
+
+    // One entry read at a snapshot: views, plus the database's handles where it has them
+    struct SnapshotRow {
+        std::string_view key;
+        std::string_view value;
+        const InternedString* keyHandle;
+        const InternedString* valueHandle;
+    };
+    // Keeps the strings a snapshot scan handed out alive after the scan
+    struct ScanPins {
+        std::shared_ptr<const BinarySnapshot> mapping;
+        std::deque<InternedString> handles;
+        std::deque<std::string> buffers;
+    };
+    // Visit every entry as of `seq`. Each shard is read-locked only while its entries
+    // are gathered, and the visit runs unlocked. Rows are valid for the visit only,
+    // unless `pins` is given to keep them for the caller.
+    void forEachAt(uint64_t seq, const std::function<void(const SnapshotRow&)>& visit,
+                   ScanPins* pins = nullptr) const;
+
+    // Helpers that see through the mapped snapshot (caller holds the shard's lock)
+    void putLocked(Shard& shard, const InternedString& key, const InternedString& value);
+    bool eraseLocked(Shard& shard, std::string_view key);
+    bool lookupLocked(const Shard& shard, std::string_view key, std::string& value) const;
+    bool peekLocked(const Shard& shard, std::string_view key, std::string& scratch,
+                    std::string_view& value) const;  // No copy unless the value is spilled
+    const ValueSlot* findSlotLocked(const Shard& shard, std::string_view key) const;
+    bool readSlotLocked(const ValueSlot& slot, std::string& value) const;
+
+    // Encoded values, as every layer below the public API stores them (see TypedValue.h).
+    // Large ones are blob references there; getStored() hands back the reference.
+    void insertStored(const std::string& key, const std::string& value);
+    bool getStored(const std::string& key, std::string& value) const;
+    std::string placeValue(std::string stored);  // Moves a large value to the blob file
+    InternedString placeValue(const InternedString& stored);
+    std::string probeValue(std::string stored) const;  // The same, for lookups: never appends
+    InternedString shownValue(const InternedString& stored) const;  // As get() shows it, for valueIndex
+    bool missingBlobFile() const;  // Reports values referring to an absent blob file; false
+
+    // Value cache (caller holds the shard exclusively)
+    size_t shardBudget() const;
+    bool overBudgetLocked(const Shard& shard) const;
+    // Const: get() faults values in. `writing` is the slot just written, whose writer
+    // still holds its own handles to the value, so it is passed over.
+    void evictLocked(Shard& shard, size_t targetBytes, const ValueSlot* writing = nullptr) const;
+    bool spillSlotLocked(Shard& shard, ValueSlot& slot) const;
+    bool compactSpillLocked();  // Caller holds every shard exclusively
+
+    // Visit every live entry. With shardsLocked the caller already holds every shard
+    // lock; otherwise shard locks are taken one at a time as the scan moves along
+    // and a key rewritten mid-scan may be visited twice, newest value last.
+    // Spilled values are read into a scratch buffer that only lives for the visit,
+    // unless `spilledValues` is given to keep them for the caller.
+    void forEachEntry(const std::function<void(std::string_view, std::string_view)>& visit,
+                      bool shardsLocked = false,
+                      std::deque<std::string>* spilledValues = nullptr) const;
+    std::string snapshotContentsLocked() const;  // Caller holds every shard lock
+    std::string snapshotContentsAt(uint64_t seq) const;  // Holds no shard lock for long
+    bool applyImportBatch(const std::vector<std::pair<std::string, std::string>>& batch);
+    bool applyBatchInsert(std::vector<std::pair<InternedString, InternedString>>& batch);
+
+    // Ordered scan over [lo, hi) merging keyIndex with the mapped snapshot's sorted keys;
+    // an empty `hi` means unbounded and a `limit` of 0 means no limit
+    std::vector<std::string> scanKeys(const std::string& lo, const std::string& hi,
+                                      bool reverse, size_t limit) const;
+
+    // Structured queries. A run holds each leaf's prepared form, the planner's
+    // estimates and the explain output; a row is one entry under test, whose value is
+    // only looked up once a predicate needs it. Key lists are sorted and distinct, and
+    // view strings pinned by the shard locks the run holds.
+    struct QueryRun;
+    struct QueryRow;
+    using KeyList = std::vector<std::string_view>;
+    std::vector<std::string> runQuery(const Query& query, QueryExplain* explain) const;
+    void runQueryOnEngine(const Query& query, QueryRun& run, std::vector<std::string>& results) const;
+    // Caller holds every shard lock and indexMutex
+    void prepareQueryLocked(const Query& query, QueryRun& run) const;
+    bool indexableLocked(const Query& query) const;  // Some index can produce its keys
+    size_t estimateLocked(const Query& query, QueryRun& run) const;  // Upper bound on its keys
+    KeyList candidatesLocked(const Query& query, QueryRun& run, size_t depth, const char* role) const;
+    KeyList scanQueryLocked(const Query& query, QueryRun& run, size_t depth) const;
+    bool matchesLocked(const Query& query, QueryRow& row, const QueryRun& run) const;
 
 public:
-    // Constructor
-    Database(const std::string& filename);
+    static constexpr size_t DEFAULT_SHARD_COUNT = 64;
+
+    // Constructor (shardCount is rounded up to a power of two)
+    Database(const std::string& filename, size_t shardCount = DEFAULT_SHARD_COUNT);
+    ~Database();
 
     // Basic operations
     bool load();
@@ -63,42 +470,232 @@ public:
     void insert(const std::string& key, const std::string& value);
     std::string get(const std::string& key) const;
     bool remove(const std::string& key);
-    std::unordered_map<std::string, std::string> getAllData() const;
+    std::unordered_map<std::string, std::string> getAllData() const;  // Values shown as by get()
+
+    // Read-only cursor over a point-in-time view of the data. Keys and values are views
+    // into the database's own strings (a spilled value is read back into a buffer), so
+    // nothing is copied up front. In-memory data is pinned by holding every shard's
+    // read lock until the cursor is destroyed: keep cursors short-lived (a ReadSnapshot
+    // suits long scans), and don't write to the database from a thread that holds one. With a storage engine the
+    // cursor scans `batchSize` entries at a time and each batch is consistent on its own.
+    class Cursor {
+    public:
+        Cursor(Cursor&&) = default;
+        Cursor& operator=(Cursor&&) = default;
+
+        bool valid() const { return source != Source::NONE; }
+        void next();
+
+        // Valid until the next call to next() or nextBatch()
+        std::string_view key() const { return currentKey; }
+        // Stored bytes (see TypedValue::decode), viewed in the blob file if stored out of line
+        std::string_view value() const { return db->resolveValue(currentValue); }
+        InternedString keyHandle() const;    // The database's own handle where it has one
+        InternedString valueHandle() const;
+
+        // Up to `max` entries from the current one on, advancing past them. The views
+        // stay valid until the next call to next() or nextBatch(); a short batch is not
+        // the end, an empty one is.
+        size_t nextBatch(std::vector<std::pair<std::string_view, std::string_view>>& batch, size_t max);
+
+    private:
+        friend class Database;
+        enum class Source { NONE, MEMORY, SNAPSHOT, SHARD, ENGINE };
+        using EntryIterator = EntryMap::const_iterator;
 
-    void insertNode(const std::string& node);                   
-    void insertEdge(const std::string& from, const std::string& to, int weight);  
-    std::vector<std::string> bfs(const std::string& start);      
-    std::vector<std::string> dfs(const std::string& start);
+        Cursor(const Database& db, CursorOptions options);
+        bool inBounds(std::string_view key) const;
+        bool visibleInSnapshot(size_t i) const;  // Not masked by a newer write or a removal
+        void settle();   // Make the next entry in order current
+        void refill();   // Storage engine: fetch the next batch
+        void setSlot(Source from, const InternedString& key, const ValueSlot& slot);
+
+        const Database* db;
+        CursorOptions options;
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        std::shared_ptr<const BinarySnapshot> snapshot;
+
+        // KEY order: keyIndex over [memFirst, memLast) and snapshot rows [snapFirst, snapLast).
+        // Going forward the heads are the next rows; in reverse they sit one past them.
+        BTree<InternedString>::Iterator memIt, memFirst, memLast;
+        size_t snapIt = 0, snapFirst = 0, snapLast = 0;
+        // HASH order: the snapshot rows, then shard by shard
+        size_t shardIndex = 0;
+        EntryIterator entryIt;
+        // Storage engine: the current batch, and the one before it for nextBatch()'s views
+        std::vector<std::pair<std::string, std::string>> buffered, retired;
+        size_t bufferedPos = 0;
+        size_t refills = 0;
+        bool engineDone = false;
+
+        Source source = Source::NONE;
+        std::string_view currentKey, currentValue;
+        const InternedString* currentKeyHandle = nullptr;
+        const InternedString* currentValueHandle = nullptr;
+        std::string scratch;                   // The current value, if it had to be read back in
+        std::deque<std::string> batchValues;   // ...and those handed out by nextBatch()
+    };
+    Cursor openCursor(const CursorOptions& options = CursorOptions()) const;
+
+    // A consistent read-only view of the database as of one write sequence number.
+    // Opening it read-locks every shard just long enough to take the number; reads then
+    // lock one shard at a time, briefly, so writers carry on while a long scan runs.
+    // With a storage engine, reads go to the engine's current data. A snapshot must
+    // not outlive its Database, and visits must not reset or reload the database.
+    class ReadSnapshot {
+    public:
+        ReadSnapshot(ReadSnapshot&& other) noexcept : db(other.db), seq(other.seq) { other.db = nullptr; }
+        ReadSnapshot& operator=(const ReadSnapshot&) = delete;
+        ~ReadSnapshot();
+
+        uint64_t sequence() const { return seq; }
+        bool get(const std::string& key, std::string& value) const;  // Shown as by get()
+        bool getTyped(const std::string& key, TypedValue& value) const;
+        // Every entry, in no particular order, with stored values (see TypedValue::decode)
+        void forEach(const std::function<void(std::string_view key, std::string_view value)>& visit) const;
+        InternedMap entries() const;  // Shares strings with the database instead of copying
+
+    private:
+        friend class Database;
+        ReadSnapshot(const Database* db, uint64_t seq) : db(db), seq(seq) {}
+
+        const Database* db;
+        uint64_t seq;
+    };
+    ReadSnapshot openSnapshot() const;
+
+    // Typed values: insert() stores its value as a STRING; insertTyped() keeps the type
+    // (JSON snapshots, imports and exports keep it too). get() shows any value as
+    // text, getTyped() hands it back with its type.
+    void insertTyped(const std::string& key, const TypedValue& value);
+    bool getTyped(const std::string& key, TypedValue& value) const;
+
+    // Blob storage: call before load(), which also opens <filename>.blobs by itself when
+    // an earlier run left one. Values of at least `threshold` bytes are kept once each in
+    // <filename>.blobs and the table, log, snapshots and commits hold a small reference
+    // instead. get() still returns the bytes; getView() views them in the mapped file,
+    // and locateBlob() gives the file range for sendfile-style transfers. JSON snapshots
+    // and exports write the values themselves.
+    static constexpr size_t DEFAULT_BLOB_THRESHOLD = 16 * 1024;
+    bool enableBlobStore(size_t threshold = DEFAULT_BLOB_THRESHOLD);
+    bool hasBlobStore() const;
+    const BlobStore* getBlobStore() const;
+    std::string_view resolveValue(std::string_view stored) const;  // A blob reference's bytes; else `stored`
+    bool getView(const std::string& key, std::string_view& value, std::string& scratch) const;  // As get() shows it
+    bool locateBlob(const std::string& key, uint64_t& offset, uint64_t& length) const;
+
+    // Write-ahead logging: call before load() so the log is replayed on startup
+    bool enableWAL(const WALOptions& options = WALOptions());
+    bool isWALEnabled() const;
+    bool checkpoint();
+
+    // Storage backend: call before load(). The engine keeps its own log and files, so
+    // inserts, gets, removes, batches and ordered scans go straight to it and the
+    // in-memory shards, value cache and secondary indexes are bypassed. save() then
+    // only syncs the engine's log and checkpoint() flushes its memtable.
+    bool setStorageEngine(std::unique_ptr<StorageEngine> storage);
+    bool hasStorageEngine() const;
+
+    // Snapshot format used by save()/checkpoint(); load() detects the format itself
+    void setSnapshotFormat(SnapshotFormat format);
+    SnapshotFormat getSnapshotFormat() const;
+
+    // Graph: nodes are interned to dense ids and edges kept in CSR arrays (see Graph.h).
+    // Traversals list the nodes reachable from `start`, which is always first; an
+    // unknown start is listed alone. bfs() runs the parallel direction-optimizing
+    // search, so nodes within one level come in no fixed order; the options add a
+    // depth limit and parents. Commits keep a copy of the graph.
+    void insertNode(const std::string& node);
+    // Undirected; true if the edge closes a cycle (is new and joins two nodes that
+    // were already connected, or is a self-loop)
+    bool insertEdge(const std::string& from, const std::string& to, int weight);
+    bool removeEdge(const std::string& from, const std::string& to);  // False if there was no such edge
+    std::vector<std::string> bfs(const std::string& start) const;
+    GraphBfs bfs(const std::string& start, const BfsOptions& options) const;
+    std::vector<std::string> dfs(const std::string& start) const;
+    Graph graphSnapshot() const;
+    void restoreGraph(Graph snapshot);
+
+    // Weighted shortest paths (see ShortestPath.h); these throw std::invalid_argument
+    // if any edge has a negative weight. shortestPath() runs bidirectional Dijkstra, or
+    // A* when given a heuristic: a lower bound on a node's distance to `to`, called
+    // with the graph read-locked. shortestDistances() lists every node reachable
+    // from `source` with its distance, nearest first.
+    GraphPath shortestPath(const std::string& from, const std::string& to) const;
+    GraphPath shortestPath(const std::string& from, const std::string& to,
+                           const std::function<uint64_t(std::string_view)>& heuristic) const;
+    std::vector<std::pair<std::string, uint64_t>> shortestDistances(const std::string& source) const;
+
+    // Connected components, from the union-find kept by insertEdge(): O(α(n)) per
+    // lookup unless an edge removal left them to be rebuilt. Unknown nodes are in no
+    // component. hasCycle() is true once the graph has any cycle, self-loops included.
+    bool connected(const std::string& a, const std::string& b) const;
+    size_t componentCount() const;
+    size_t componentSize(const std::string& node) const;  // 0 for an unknown node
+    std::vector<size_t> componentSizes() const;           // Largest first
+    bool hasCycle() const;
 
     // Advanced querying
     std::vector<std::string> query(
         const std::function<bool(const std::string&, const std::string&)>& predicate) const;
-    std::vector<std::string> queryByPrefix(const std::string& prefix) const;
-    std::vector<std::string> queryByValue(const std::string& value) const;
+    std::vector<std::string> queryByPrefix(const std::string& prefix, bool reverse = false) const;
+    std::vector<std::string> queryByValue(const std::string& value) const;  // Inverted index lookup
+    // Keys whose value (shown as by get()) contains `pattern`: a literal, or an
+    // ECMAScript regex. Compiled patterns are cached (see PatternScan.h). In key order;
+    // throws std::regex_error on a malformed regex.
     std::vector<std::string> queryByValuePattern(const std::string& pattern) const;
 
+    // Structured queries (see Query.h): matching keys in key order. The planner drives
+    // the search from the most selective index (the key B+tree, the value index or a
+    // secondary index), intersects the key lists of the other selective terms and
+    // tests the rest row by row; it scans the table, in parallel chunks, only when no
+    // index narrows the search to half of it. Every shard is read-locked throughout,
+    // so the answer is consistent. explain() runs the query and reports the plan.
+    std::vector<std::string> query(const Query& query) const;
+    QueryExplain explain(const Query& query) const;
+
+    // Ordered range queries: keys in [lo, hi) in key order, O(log n + k).
+    // An empty `hi` means no upper bound; `limit` 0 means all matches.
+    std::vector<std::string> queryRange(const std::string& lo, const std::string& hi,
+                                        bool reverse = false, size_t limit = 0) const;
+
+    // Numeric queries over INTEGER and FLOAT values through the numeric index (built on
+    // first use): keys with lo <= value <= hi in value order, and a summary of the
+    // numeric values of every key starting with `prefix`
+    std::vector<std::string> queryBetween(double lo, double hi, size_t limit = 0) const;
+    NumericSummary summarizeNumeric(const std::string& prefix) const;
+
     // B-Tree-based querying
     std::vector<std::string> queryByPrefixBTree(const std::string& prefix) const;
     std::vector<std::string> queryByValueBTree(const std::string& value) const;
 
-    // Indexing
+    // Indexing: createIndex() builds the index over existing data in parallel
     bool createIndex(const std::string& indexName, 
                      const std::function<std::string(const std::string&)>& indexer);
     std::vector<std::string> queryByIndex(const std::string& indexName, const std::string& value) const;
 
-    // Batch operations
+    // Batch operations: each touched shard and the indexes are locked once, and the
+    // whole batch is logged as a single write-ahead record
     bool batchInsert(const std::unordered_map<std::string, std::string>& entries);
+    bool batchInsert(const InternedMap& entries);
     bool batchRemove(const std::vector<std::string>& keys);
 
     // Statistics
     size_t size() const;
+    DatabaseStats getStats(size_t topValues = 5) const;  // O(topValues) once statistics are built
     std::unordered_map<std::string, size_t> getValueDistribution() const;
 
-    // Caching and performance
+    // Caching and performance: with a memory budget (bytes of resident values, 0 for
+    // unlimited) cold values spill to <filename>.values and get() faults them back in.
+    // optimize() evicts down to the budget and compacts the spill file; clearCache()
+    // evicts every value and drops the lazily built value indexes.
+    bool setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
     void optimize();
     void clearCache();
 
-    // Import/Export
+    // Import/Export (JSON, or NDJSON for .ndjson/.jsonl files, whatever the snapshot
+    // format); both stream, so memory use doesn't grow with the file
     bool importFrom(const std::string& filename, bool merge = false);
     bool exportTo(const std::string& filename) const;
 
@@ -0,0 +1,348 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Swiss-table style open-addressing hash map. Entries live in one flat slot array; a
+// parallel array of control bytes holds, per slot, 7 bits of the key's hash, or EMPTY,
+// or DELETED. A lookup hashes once and then compares a group of 16 control bytes at a
+// time (with SSE2 or NEON where available). It only reads the slots whose 7 bits match,
+// so a miss rarely touches a key at all. Groups are 16-slot aligned and probed
+// quadratically, and the table grows at 7/8 load.
+//
+// Lookups are heterogeneous: find() takes anything Hash and Eq accept alongside K
+// (e.g. std::string_view for string keys). Keys and values are stored inline in the
+// slots, so short std::string keys cost no allocation beyond the table itself.
+// Inserts that grow the table move entries and invalidate pointers and iterators;
+// erase does not. V must be move-constructible.
+template <typename K, typename V, typename Hash, typename Eq = std::equal_to<>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<K, V>;
+    static constexpr size_t GROUP_WIDTH = 16;
+
+private:
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    // One group of control bytes; each match returns bit i set for slot i of the group
+    class Group {
+    private:
+#if defined(__SSE2__)
+        __m128i bytes;
+
+    public:
+        explicit Group(const int8_t* ctrl) : bytes(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+        uint32_t match(int8_t h2) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+        }
+        // EMPTY and DELETED are the only control bytes with the sign bit set
+        uint32_t matchFree() const { return static_cast<uint32_t>(_mm_movemask_epi8(bytes)); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        int8x16_t bytes;
+
+        static uint32_t toMask(uint8x16_t lanes) {
+            static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            uint8x16_t masked = vandq_u8(lanes, vld1q_u8(bits));
+            return vaddv_u8(vget_low_u8(masked)) | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(masked))) << 8);
+        }
+
+    public:
+        explicit Group(const int8_t* ctrl) : bytes(vld1q_s8(ctrl)) {}
+        uint32_t match(int8_t h2) const { return toMask(vceqq_s8(bytes, vdupq_n_s8(h2))); }
+        uint32_t matchFree() const { return toMask(vcltzq_s8(bytes)); }
+#else
+        const int8_t* bytes;
+
+    public:
+        explicit Group(const int8_t* ctrl) : bytes(ctrl) {}
+        uint32_t match(int8_t h2) const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= static_cast<uint32_t>(bytes[i] == h2) << i;
+            return mask;
+        }
+        uint32_t matchFree() const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= static_cast<uint32_t>(bytes[i] < 0) << i;
+            return mask;
+        }
+#endif
+        uint32_t matchEmpty() const { return match(EMPTY); }
+    };
+
+    int8_t* ctrl = nullptr;
+    value_type* slots = nullptr;
+    size_t slotCount = 0;   // 0, or a power-of-two multiple of GROUP_WIDTH
+    size_t used = 0;
+    size_t growthLeft = 0;  // Inserts into EMPTY slots left before the next rehash
+    Hash hasher;
+    Eq equal;
+
+    // Finalizer from MurmurHash3: every output bit depends on every input bit, so the
+    // group index and the 7 stored bits are independent even for weak hashes
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static int8_t h2Of(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+    static size_t lowestBit(uint32_t mask) { return static_cast<size_t>(__builtin_ctz(mask)); }
+    static size_t maxLoad(size_t slots) { return slots - slots / 8; }
+
+    template <typename Q>
+    uint64_t hashOf(const Q& key) const { return mix(static_cast<uint64_t>(hasher(key))); }
+
+    template <typename Q>
+    size_t findIndex(const Q& key, uint64_t hash) const {
+        if (!slotCount) return NPOS;
+        size_t groupMask = slotCount / GROUP_WIDTH - 1;
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1;; step++) {
+            size_t base = group * GROUP_WIDTH;
+            Group g(ctrl + base);
+            for (uint32_t mask = g.match(h2Of(hash)); mask; mask &= mask - 1) {
+                size_t i = base + lowestBit(mask);
+                if (equal(slots[i].first, key)) return i;
+            }
+            // A key is never placed past a group that still had an EMPTY slot
+            if (g.matchEmpty()) return NPOS;
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // First EMPTY or DELETED slot on the key's probe sequence
+    size_t findFree(uint64_t hash) const {
+        size_t groupMask = slotCount / GROUP_WIDTH - 1;
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1;; step++) {
+            size_t base = group * GROUP_WIDTH;
+            uint32_t mask = Group(ctrl + base).matchFree();
+            if (mask) return base + lowestBit(mask);
+            group = (group + step) & groupMask;
+        }
+    }
+
+    void allocate(size_t slots) {
+        slotCount = slots;
+        ctrl = static_cast<int8_t*>(::operator new(slots, std::align_val_t(GROUP_WIDTH)));
+        std::memset(ctrl, EMPTY, slots);
+        this->slots = std::allocator<value_type>().allocate(slots);
+        growthLeft = maxLoad(slots);
+    }
+
+    void release() {
+        if (!slotCount) return;
+        for (size_t i = 0; i < slotCount; i++) {
+            if (ctrl[i] >= 0) slots[i].~value_type();
+        }
+        ::operator delete(ctrl, std::align_val_t(GROUP_WIDTH));
+        std::allocator<value_type>().deallocate(slots, slotCount);
+        ctrl = nullptr;
+        slots = nullptr;
+        slotCount = 0;
+        used = 0;
+        growthLeft = 0;
+    }
+
+    // Move every entry into fresh arrays of `slots` slots, dropping the DELETED markers
+    void rehash(size_t slots) {
+        int8_t* oldCtrl = ctrl;
+        value_type* oldSlots = this->slots;
+        size_t oldCount = slotCount;
+        allocate(slots);
+        for (size_t i = 0; i < oldCount; i++) {
+            if (oldCtrl[i] < 0) continue;
+            uint64_t hash = hashOf(oldSlots[i].first);
+            size_t j = findFree(hash);
+            ctrl[j] = h2Of(hash);
+            new (this->slots + j) value_type(std::move(oldSlots[i]));
+            oldSlots[i].~value_type();
+        }
+        growthLeft -= used;
+        if (oldCount) {
+            ::operator delete(oldCtrl, std::align_val_t(GROUP_WIDTH));
+            std::allocator<value_type>().deallocate(oldSlots, oldCount);
+        }
+    }
+
+    // Out of EMPTY slots: double, unless DELETED markers are most of the load
+    void grow() {
+        if (!slotCount) allocate(GROUP_WIDTH);
+        else rehash(used * 2 < maxLoad(slotCount) ? slotCount : slotCount * 2);
+    }
+
+    template <typename KeyArg, typename... Args>
+    std::pair<size_t, bool> emplaceIndex(KeyArg&& key, Args&&... args) {
+        uint64_t hash = hashOf(key);
+        size_t i = findIndex(key, hash);
+        if (i != NPOS) return {i, false};
+        i = slotCount ? findFree(hash) : NPOS;
+        if (i == NPOS || (ctrl[i] == EMPTY && growthLeft == 0)) {
+            grow();
+            i = findFree(hash);
+        }
+        if (ctrl[i] == EMPTY) growthLeft--;
+        ctrl[i] = h2Of(hash);
+        new (slots + i) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                   std::forward_as_tuple(std::forward<Args>(args)...));
+        used++;
+        return {i, true};
+    }
+
+    // A slot can go back to EMPTY if its group still has one: no probe sequence
+    // continues past such a group, so none can run through this slot
+    void eraseIndex(size_t i) {
+        slots[i].~value_type();
+        used--;
+        if (Group(ctrl + (i & ~(GROUP_WIDTH - 1))).matchEmpty()) {
+            ctrl[i] = EMPTY;
+            growthLeft++;
+        } else {
+            ctrl[i] = DELETED;
+        }
+    }
+
+    template <bool Const>
+    class Iter {
+    private:
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        Map* map = nullptr;
+        size_t index = 0;
+
+        void skipFree() {
+            while (index < map->slotCount && map->ctrl[index] < 0) index++;
+        }
+
+        friend class FlatHashMap;
+        friend class Iter<!Const>;
+
+    public:
+        using value_type = FlatHashMap::value_type;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iter() = default;
+        Iter(Map* map, size_t index) : map(map), index(index) {}
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        Iter(const Iter<OtherConst>& other) : map(other.map), index(other.index) {}
+
+        reference operator*() const { return map->slots[index]; }
+        pointer operator->() const { return &map->slots[index]; }
+        Iter& operator++() {
+            index++;
+            skipFree();
+            return *this;
+        }
+        bool operator==(const Iter& other) const { return index == other.index; }
+        bool operator!=(const Iter& other) const { return index != other.index; }
+    };
+
+public:
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    FlatHashMap() = default;
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+    FlatHashMap(FlatHashMap&& other) noexcept { *this = std::move(other); }
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(slotCount, other.slotCount);
+            std::swap(used, other.used);
+            std::swap(growthLeft, other.growthLeft);
+        }
+        return *this;
+    }
+    ~FlatHashMap() { release(); }
+
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+    size_t capacity() const { return slotCount; }
+    size_t memoryUsage() const { return slotCount * (sizeof(value_type) + 1); }
+
+    iterator begin() {
+        iterator it(this, 0);
+        if (slotCount) it.skipFree();
+        return it;
+    }
+    iterator end() { return iterator(this, slotCount); }
+    const_iterator begin() const {
+        const_iterator it(this, 0);
+        if (slotCount) it.skipFree();
+        return it;
+    }
+    const_iterator end() const { return const_iterator(this, slotCount); }
+
+    template <typename Q>
+    iterator find(const Q& key) {
+        size_t i = findIndex(key, hashOf(key));
+        return i == NPOS ? end() : iterator(this, i);
+    }
+    template <typename Q>
+    const_iterator find(const Q& key) const {
+        size_t i = findIndex(key, hashOf(key));
+        return i == NPOS ? end() : const_iterator(this, i);
+    }
+    template <typename Q>
+    size_t count(const Q& key) const { return findIndex(key, hashOf(key)) != NPOS; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        auto [i, inserted] = emplaceIndex(key, std::forward<Args>(args)...);
+        return {iterator(this, i), inserted};
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        auto [i, inserted] = emplaceIndex(std::move(key), std::forward<Args>(args)...);
+        return {iterator(this, i), inserted};
+    }
+    V& operator[](const K& key) {
+        size_t i = emplaceIndex(key).first;  // May reallocate `slots`, so index after it
+        return slots[i].second;
+    }
+
+    void erase(iterator it) { eraseIndex(it.index); }
+    void erase(const_iterator it) { eraseIndex(it.index); }
+    template <typename Q>
+    size_t erase(const Q& key) {
+        size_t i = findIndex(key, hashOf(key));
+        if (i == NPOS) return 0;
+        eraseIndex(i);
+        return 1;
+    }
+
+    void clear() { release(); }  // Frees the arrays too
+    void reserve(size_t entries) {
+        size_t slots = GROUP_WIDTH;
+        while (maxLoad(slots) < entries) slots *= 2;
+        if (slots > slotCount) rehash(slots);
+    }
+
+    // Slot-by-slot access for sweeps that keep their place across calls (e.g. a CLOCK
+    // hand); valid slot indexes are [0, capacity())
+    bool occupied(size_t slot) const { return ctrl[slot] >= 0; }
+    value_type& slotAt(size_t slot) { return slots[slot]; }
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StringPool.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/FlatHashMap.h"
+
+using NodeId = uint32_t;
+
+// One adjacency entry, as stored in a CSR row
+struct Neighbor {
+    NodeId to;
+    int weight;
+};
+
+// One bit per node, for traversal visited sets
+class NodeBitset {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    explicit NodeBitset(size_t nodes = 0) : words((nodes + 63) / 64, 0) {}
+
+    bool test(NodeId id) const { return words[id >> 6] >> (id & 63) & 1; }
+    void set(NodeId id) { words[id >> 6] |= uint64_t(1) << (id & 63); }
+    bool testAndSet(NodeId id) {  // True if the bit was already set
+        uint64_t bit = uint64_t(1) << (id & 63);
+        bool was = words[id >> 6] & bit;
+        words[id >> 6] |= bit;
+        return was;
+    }
+};
+
+// Directed weighted graph over interned node names. Each name gets a dense NodeId in
+// creation order. Adjacency is kept in compressed sparse row (CSR) form: row u of
+// `offsets` spans the neighbors of u in the flat `targets`/`weights` arrays, sorted by
+// NodeId. New edges land in a delta buffer first, and removed ones are only marked,
+// until compact() merges both into the arrays in one pass. Adding an edge that exists
+// keeps its original weight.
+//
+// Readers see only the CSR arrays: the row accessors and the traversals require
+// pendingEdges() == 0 (Database compacts before it reads). Not thread-safe on its own.
+class Graph {
+private:
+    std::vector<InternedString> names;                          // NodeId -> name
+    FlatHashMap<InternedString, NodeId, InternedTextHash> ids;  // name -> NodeId
+
+    // CSR arrays over nodes [0, offsets.size() - 1); later nodes have empty rows
+    std::vector<uint64_t> offsets{0};
+    std::vector<NodeId> targets;
+    std::vector<int> weights;
+
+    // Delta since the last compaction: edges added, their (from, to) pairs, and the
+    // pairs of edges removed from the CSR arrays
+    struct PendingEdge {
+        NodeId from;
+        NodeId to;
+        int weight;
+    };
+    std::vector<PendingEdge> pending;
+    std::unordered_set<uint64_t> pendingPairs;
+    std::unordered_set<uint64_t> removedPairs;
+    size_t negativeWeights = 0;  // Edges with a weight below zero
+
+    bool hasCompactedEdge(NodeId from, NodeId to) const;
+
+public:
+    static constexpr NodeId NONE = static_cast<NodeId>(-1);
+    // The delta buffer is compacted once it reaches this many edges, or an eighth
+    // of the CSR arrays if that is more
+    static constexpr size_t COMPACT_MIN_PENDING = 4096;
+
+    Graph() = default;
+    Graph(const Graph& other);
+    Graph& operator=(const Graph& other);
+    Graph(Graph&&) = default;
+    Graph& operator=(Graph&&) = default;
+
+    NodeId addNode(std::string_view name);    // The existing id if the node exists
+    NodeId find(std::string_view name) const;  // NONE if absent
+    bool addEdge(NodeId from, NodeId to, int weight);  // False if the edge already existed
+    bool removeEdge(NodeId from, NodeId to);           // False if there was no such edge
+    bool hasEdge(NodeId from, NodeId to) const;
+    bool hasNegativeWeights() const { return negativeWeights != 0; }
+
+    size_t nodeCount() const { return names.size(); }
+    size_t edgeCount() const { return targets.size() - removedPairs.size() + pending.size(); }  // Directed
+    size_t pendingEdges() const { return pending.size() + removedPairs.size(); }  // Additions and removals
+    bool shouldCompact() const;
+    void compact();  // Merge the delta buffer and removals into the CSR arrays
+    void clear();
+
+    std::string_view name(NodeId id) const { return names[id].view(); }
+    const InternedString& handle(NodeId id) const { return names[id]; }
+
+    // Row `id` of the CSR arrays (caller makes sure nothing is pending)
+    size_t degree(NodeId id) const {
+        return id + 1 < offsets.size() ? offsets[id + 1] - offsets[id] : 0;
+    }
+    const NodeId* targetsOf(NodeId id) const { return targets.data() + (id + 1 < offsets.size() ? offsets[id] : 0); }
+    const int* weightsOf(NodeId id) const { return weights.data() + (id + 1 < offsets.size() ? offsets[id] : 0); }
+
+    // Traversals from `start` over compacted edges, in visiting order. BFS visits
+    // neighbors in NodeId order; DFS pushes them in that order, so takes the last first.
+    std::vector<NodeId> bfs(NodeId start) const;
+    std::vector<NodeId> dfs(NodeId start) const;
+
+    size_t memoryUsage() const;  // Approximate bytes held, excluding the node names' text
+};
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef LSM_TREE_H
+#define LSM_TREE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StorageEngine.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/WriteAheadLog.h"
+
+// Tuning knobs for the LSM engine
+struct LSMOptions {
+    size_t memtableBytes = 4 << 20;   // Seal and flush the memtable past this size
+    size_t level0Runs = 4;            // Merge level 0 into level 1 at this many runs
+    size_t level1Bytes = 32 << 20;    // Level 1 target size...
+    size_t levelRatio = 10;           // ...each deeper level may be this much larger
+    size_t bloomBitsPerKey = 10;      // ~1% false positives
+    WALOptions wal;
+};
+
+// Bloom filter over one run's keys, read straight out of the mapped run file.
+// Probes use double hashing over a stable 64-bit hash, so filters survive restarts.
+class BloomFilter {
+private:
+    const uint8_t* bits = nullptr;
+    uint64_t bitCount = 0;
+    uint32_t probes = 0;
+
+public:
+    BloomFilter() = default;
+    BloomFilter(const uint8_t* bits, uint64_t bitCount, uint32_t probes)
+        : bits(bits), bitCount(bitCount), probes(probes) {}
+
+    static uint64_t hash(std::string_view key);
+    static uint32_t probesFor(size_t bitsPerKey);
+    static void add(std::vector<uint8_t>& bits, uint32_t probes, uint64_t keyHash);
+
+    bool mayContain(std::string_view key) const;
+};
+
+// Sorted run layout (all integers little-endian):
+//   [header]      magic "VDBRUN\0\0", version, entry count, section offsets
+//   [value heap]  every value, concatenated in key order (streamed out first)
+//   [key block]   every key, concatenated in sorted order
+//   [slot table]  one RunSlot per entry; a tombstone has valueLength TOMBSTONE
+//   [bloom]       bloom filter bits over every key
+// Like binary snapshots, runs are mmap'd and binary-searched in place.
+struct RunHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bloomProbes;
+    uint64_t count;
+    uint64_t valueHeapOffset;
+    uint64_t keyBlockOffset;
+    uint64_t slotTableOffset;
+    uint64_t bloomOffset;
+    uint64_t bloomBits;
+    uint64_t fileSize;
+};
+
+struct RunSlot {
+    static constexpr uint32_t TOMBSTONE = 0xFFFFFFFFu;
+
+    uint64_t keyOffset;    // Relative to the key block
+    uint64_t valueOffset;  // Relative to the value heap
+    uint32_t keyLength;
+    uint32_t valueLength;
+};
+
+// An immutable, mapped sorted run. The file is deleted with the last reference
+// once compaction has marked it obsolete.
+class SortedRun {
+private:
+    std::string path;
+    uint64_t id;
+    const char* base;
+    size_t length;
+    const RunHeader* header;
+    const RunSlot* slots;
+    BloomFilter bloom;
+    std::atomic<bool> obsolete;
+
+    SortedRun(const std::string& path, uint64_t id);
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    ~SortedRun();
+    SortedRun(const SortedRun&) = delete;
+    SortedRun& operator=(const SortedRun&) = delete;
+
+    static std::shared_ptr<SortedRun> open(const std::string& path, uint64_t id);
+
+    uint64_t getId() const { return id; }
+    size_t size() const;
+    size_t fileBytes() const { return length; }
+    std::string_view keyAt(size_t i) const;
+    std::string_view valueAt(size_t i) const;
+    bool isTombstone(size_t i) const;
+
+    size_t lowerBound(std::string_view key) const;
+    bool mayContain(std::string_view key) const { return bloom.mayContain(key); }
+    void markObsolete() { obsolete = true; }
+};
+
+// Streams a sorted run to disk: values go out as they arrive, keys and slots are
+// buffered and appended by finish(), which then patches in the header
+class SortedRunWriter {
+private:
+    std::string path;
+    int fd;
+    size_t bitsPerKey;
+    uint64_t valueBytes;
+    std::string keyBlock;
+    std::vector<RunSlot> slots;
+    std::vector<uint64_t> keyHashes;
+    std::string pending;  // Values not yet written
+    bool failed;
+
+    bool writeAt(uint64_t offset, const char* data, size_t size);
+    bool flushPending();
+
+public:
+    SortedRunWriter(const std::string& path, size_t bitsPerKey);
+    ~SortedRunWriter();
+
+    bool open();
+    void add(std::string_view key, std::string_view value, bool tombstone);  // Keys in ascending order
+    bool finish(uint64_t& fileBytes);  // Writes the tail, fsyncs and closes
+    size_t size() const { return slots.size(); }
+};
+
+// Log-structured merge tree: writes land in a memtable (and the write-ahead log);
+// a full memtable is sealed and a flusher thread writes it out as a level-0 run.
+// A compaction thread merges level 0 into level 1 once it holds level0Runs runs,
+// and level N into N+1 once N outgrows its target, so every level below 0 is a
+// single sorted run. Reads check the memtables, then level 0 newest first, then
+// each deeper level; a run's bloom filter is consulted before it is searched.
+class LSMTree : public StorageEngine {
+private:
+    struct MemEntry {
+        std::string value;
+        bool tombstone;
+    };
+    using Memtable = std::map<std::string, MemEntry, std::less<>>;
+
+    // The runs readers see; replaced wholesale when a flush or compaction installs
+    struct Version {
+        std::vector<std::vector<std::shared_ptr<SortedRun>>> levels;  // Level 0 newest first
+    };
+
+    std::string directory;
+    LSMOptions options;
+    std::unique_ptr<WriteAheadLog> wal;
+
+    // Lock order: installMutex -> mutex
+    mutable std::shared_mutex mutex;  // Guards active, immutable, activeBytes and version
+    std::unique_ptr<Memtable> active;
+    std::shared_ptr<const Memtable> immutable;  // Sealed, waiting for the flusher
+    size_t activeBytes;
+    std::shared_ptr<const Version> version;
+    std::mutex installMutex;  // Serializes flush/compaction installs and manifest writes
+    uint64_t nextRunId;
+
+    std::condition_variable_any sealedCv;    // Flusher: a memtable was sealed
+    std::condition_variable_any installedCv; // Writers and flush(): a flush or compaction was installed
+    std::condition_variable_any compactCv;   // Compactor: the level shape changed
+    bool stopping;
+    bool failed;
+    std::thread flusher;
+    std::thread compactor;
+
+    std::atomic<uint64_t> userBytes;
+    std::atomic<uint64_t> logBytes;
+    std::atomic<uint64_t> flushBytes;
+    std::atomic<uint64_t> compactionBytes;
+    std::atomic<uint64_t> flushes;
+    std::atomic<uint64_t> compactions;
+    mutable std::atomic<uint64_t> bloomNegatives;
+    mutable std::atomic<uint64_t> runProbes;
+
+    std::string runPath(uint64_t id) const;
+    std::string manifestPath() const;
+    bool readManifest(Version& loaded);
+    bool writeManifest(const Version& next) const;
+
+    bool write(const WALRecord& record, uint64_t keyValueBytes,
+               const std::function<void()>& apply);
+    void applyLocked(std::string_view key, std::string_view value, bool tombstone);
+    bool sealLocked();  // Caller holds mutex exclusively
+
+    void flusherLoop();
+    void compactorLoop();
+    bool pickCompaction(const Version& current, size_t& level) const;
+    bool compact(size_t level);
+    size_t levelTargetBytes(size_t level) const;
+
+public:
+    LSMTree(const std::string& directory, const LSMOptions& options = LSMOptions());
+    ~LSMTree() override;
+
+    bool open() override;
+    void close();
+
+    bool put(std::string_view key, std::string_view value) override;
+    bool remove(std::string_view key) override;
+    bool get(std::string_view key, std::string& value) const override;
+    bool putBatch(const std::vector<std::pair<std::string_view, std::string_view>>& entries) override;
+    bool removeBatch(const std::vector<std::string_view>& keys) override;
+    void scan(std::string_view lo, std::string_view hi, const ScanVisitor& visit) const override;
+    bool sync() override;
+    bool flush() override;
+    StorageEngineStats stats() const override;
+
+    // Block until no flush or compaction is pending (used by benchmarks)
+    void waitForCompactions();
+};
+
+#endif
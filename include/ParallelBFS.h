@@ -0,0 +1,37 @@
+#ifndef PARALLEL_BFS_H
+#define PARALLEL_BFS_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+
+struct BfsOptions {
+    size_t threads = 0;                // 0: one per hardware thread
+    uint32_t maxDepth = UINT32_MAX;    // Levels to expand past the start; 0 visits the start alone
+    bool parents = false;              // Fill BfsResult::parents
+};
+
+struct BfsResult {
+    std::vector<NodeId> order;         // Level by level; the order within a level varies run to run
+    std::vector<size_t> levelOffsets;  // Level d is order[levelOffsets[d], levelOffsets[d + 1])
+    std::vector<NodeId> parents;       // By NodeId: the node each was reached from (the start for
+                                       // itself), Graph::NONE if unreached; empty unless asked for
+    size_t topDownLevels = 0;
+    size_t bottomUpLevels = 0;
+};
+
+// Level-synchronous, direction-optimizing BFS over a compacted Graph (nothing pending).
+// A fixed set of worker threads expands each level between barriers, claiming nodes
+// in an atomic visited bitmap and collecting the next level in per-thread buffers. A
+// level expands top-down (frontier nodes scan their edges) while the frontier is
+// small, and bottom-up (each unvisited node scans its incoming edges for a frontier
+// node, stopping at the first) once the frontier's edges outnumber a fraction of the
+// unexplored ones, which saves most edge checks on the big middle levels of a
+// low-diameter graph. Bottom-up reads `reverse`: the graph with every edge flipped,
+// or the graph itself when it is symmetric.
+//
+// Visits the same nodes as Graph::bfs(). Small graphs run on the calling thread alone.
+BfsResult parallelBfs(const Graph& graph, const Graph& reverse, NodeId start, const BfsOptions& options = {});
+
+#endif
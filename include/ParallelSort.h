@@ -0,0 +1,52 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Sort [first, last) across hardware threads: each thread sorts one contiguous run,
+// then neighbouring runs are merged pairwise (also in parallel) until one remains.
+// Small inputs fall back to a plain std::sort.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallelSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    static constexpr size_t MIN_RUN = 1 << 14;
+    size_t n = static_cast<size_t>(last - first);
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, std::max<size_t>(1, n / MIN_RUN));
+    if (workers <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(workers + 1);
+    for (size_t i = 0; i <= workers; i++) bounds[i] = n * i / workers;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) {
+        threads.emplace_back([&, i] {
+            std::sort(first + bounds[i], first + bounds[i + 1], comp);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    while (bounds.size() > 2) {
+        size_t runs = bounds.size() - 1;
+        std::vector<size_t> merged;
+        threads.clear();
+        for (size_t i = 0; i < runs; i += 2) {
+            merged.push_back(bounds[i]);
+            if (i + 1 == runs) break;  // Odd run out waits for the next round
+            threads.emplace_back([&, i] {
+                std::inplace_merge(first + bounds[i], first + bounds[i + 1], first + bounds[i + 2], comp);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        merged.push_back(n);
+        bounds.swap(merged);
+    }
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef PATTERN_SCAN_H
+#define PATTERN_SCAN_H
+
+#include <string>
+#include <string_view>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <unordered_map>
+#include <cstdint>
+
+// Substring search kernels. The SIMD ones filter a block of candidate start positions
+// at once: they compare the block against one byte of the needle, and the block at a
+// second byte's offset against that byte, and verify only positions where both match.
+// The bytes are the needle's last and its rarest before that, by a fixed table of
+// byte frequencies in text, so few positions pass. AVX2 is picked at run time when the CPU has it; SSE2 is the
+// x86-64 baseline and NEON the AArch64 one. SCALAR is std::string_view::find.
+enum class SearchKernel {
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+SearchKernel bestSearchKernel();  // The fastest kernel this CPU supports
+bool searchKernelSupported(SearchKernel kernel);
+const char* searchKernelName(SearchKernel kernel);
+
+// A needle prepared once for many searches. A kernel this CPU lacks falls back to SCALAR.
+class SubstringSearcher {
+private:
+    std::string text;
+    size_t rare;       // Offsets of the two bytes the SIMD filter tests, rare < other
+    size_t other;
+    SearchKernel searchKernel;
+
+public:
+    explicit SubstringSearcher(std::string needle, SearchKernel kernel = bestSearchKernel());
+
+    size_t find(std::string_view haystack) const;  // First occurrence, or npos
+    const std::string& needle() const { return text; }
+    SearchKernel kernel() const { return searchKernel; }
+};
+
+// One-off search: offset of the first occurrence of `needle` in `haystack`, or npos
+size_t findSubstring(std::string_view haystack, std::string_view needle);
+
+// A value pattern, compiled once. A pattern without regex syntax is a literal and is
+// matched by substring search alone. Anything else is an ECMAScript regex (as
+// std::regex reads it), searched for anywhere in the value. Before running the regex,
+// matches() checks for the longest literal that every match must contain, so most
+// values are rejected by the SIMD search without touching the regex engine.
+class ValuePattern {
+private:
+    std::string pattern;
+    SubstringSearcher literal;  // Required in every match; empty if none could be found
+    bool literalOnly;
+    std::unique_ptr<std::regex> regex;  // Null for a literal
+
+public:
+    explicit ValuePattern(const std::string& pattern);  // Throws std::regex_error
+
+    bool matches(std::string_view text) const;
+
+    const std::string& source() const { return pattern; }
+    bool isLiteral() const { return literalOnly; }
+    const std::string& requiredLiteral() const { return literal.needle(); }
+    std::string describe() const;  // How matches() works, for explain output
+
+    // The longest run of literal bytes every match of the ECMAScript regex contains.
+    // Conservative: empty when the pattern has top-level alternation.
+    static std::string extractRequiredLiteral(const std::string& pattern);
+};
+
+// Compiled patterns by source text, shared process-wide so a pattern queried again
+// skips compilation. Holds at most `capacity` patterns, dropping the least recently used.
+class PatternCache {
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const ValuePattern>>;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> byPattern;
+    size_t capacity;
+    uint64_t hits;
+    uint64_t misses;
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 128;
+
+    explicit PatternCache(size_t capacity = DEFAULT_CAPACITY);
+    static PatternCache& instance();
+
+    // The compiled pattern, compiling it on a miss; throws std::regex_error
+    std::shared_ptr<const ValuePattern> get(const std::string& pattern);
+
+    size_t size() const;
+    uint64_t hitCount() const;
+    uint64_t missCount() const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// A structured query over the live data: leaves test a key or a value, inner nodes
+// combine their children with AND or OR. Database::query(const Query&) plans it
+// against the key B+tree, the inverted value index and the secondary indexes, and
+// only scans the table when no index narrows the search enough.
+struct Query {
+    enum class Kind {
+        KEY_PREFIX,    // Key starts with `first`
+        KEY_RANGE,     // Key in [first, second); an empty `second` means unbounded
+        VALUE_EQUALS,  // Value equals `first`, as queryByValue() matches it
+        VALUE_REGEX,   // Value, shown as by get(), contains a match for `first` (see ValuePattern)
+        INDEX_EQUALS,  // Secondary index `first` maps the value to `second`
+        AND,
+        OR
+    };
+
+    Kind kind = Kind::AND;
+    std::string first;
+    std::string second;
+    std::vector<Query> children;  // AND and OR only
+
+    static Query keyPrefix(const std::string& prefix);
+    static Query keyRange(const std::string& lo, const std::string& hi);
+    static Query valueEquals(const std::string& value);
+    static Query valueMatches(const std::string& pattern);
+    static Query indexEquals(const std::string& indexName, const std::string& value);
+    static Query allOf(std::vector<Query> children);  // Nested ANDs are flattened
+    static Query anyOf(std::vector<Query> children);  // ...and nested ORs
+
+    bool isLeaf() const { return kind != Kind::AND && kind != Kind::OR; }
+    std::string toString() const;  // In the syntax parse() reads
+
+    // Parse the CLI syntax: terms prefix:P, range:LO..HI (HI may be *), value:V,
+    // regex:R and index:NAME=V, joined by AND and OR (AND binds tighter) and grouped
+    // with parentheses. Arguments may be double-quoted, with \" and \\ escapes.
+    // Returns false and sets `error` on malformed input.
+    static bool parse(const std::string& text, Query& query, std::string& error);
+};
+
+Query operator&&(Query a, Query b);
+Query operator||(Query a, Query b);
+
+// What Database::explain() reports: the plan as indented lines, each with the keys
+// it produced, and the work done to run it
+struct QueryExplain {
+    std::vector<std::string> plan;
+    size_t rowsExamined = 0;  // Entries whose key or value was tested against a predicate
+    size_t postingsRead = 0;  // Keys read from the key B+tree and index posting lists
+    size_t matches = 0;
+};
+
+#endif
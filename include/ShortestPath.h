@@ -0,0 +1,54 @@
+#ifndef SHORTEST_PATH_H
+#define SHORTEST_PATH_H
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+
+// Weighted shortest paths over a compacted Graph (nothing pending). Every function
+// requires non-negative weights (see Graph::hasNegativeWeights()); distances are sums
+// of edge weights.
+
+constexpr uint64_t UNREACHABLE = UINT64_MAX;
+
+// Priority queue behind Dijkstra. RADIX buckets keys by their highest bit that
+// differs from the last key popped, which works because Dijkstra pops keys in
+// non-decreasing order, and costs O(1) per push and amortized O(log C) per pop. DARY is
+// a 4-ary implicit heap: shallower than a binary heap, with each node's children
+// in one cache line.
+enum class PathHeap {
+    RADIX,
+    DARY
+};
+
+struct PathResult {
+    bool found = false;
+    uint64_t distance = UNREACHABLE;
+    std::vector<NodeId> nodes;  // from ... to, when found
+    size_t settled = 0;         // Nodes taken off the queue: the work the search did
+};
+
+// Lower bound on the distance from a node to the target. A* returns shortest paths
+// as long as it never overestimates; a consistent one also settles each node once.
+// UNREACHABLE marks a node the target can't be reached from, which A* then skips.
+using PathHeuristic = std::function<uint64_t(NodeId)>;
+
+// Single-source Dijkstra: the distance to every node, UNREACHABLE where there is no path
+std::vector<uint64_t> shortestDistances(const Graph& graph, NodeId source, PathHeap heap = PathHeap::RADIX);
+
+// Point-to-point Dijkstra that stops once the target is settled
+PathResult dijkstraPath(const Graph& graph, NodeId from, NodeId to, PathHeap heap = PathHeap::RADIX);
+
+// Bidirectional Dijkstra: searches forward from `from` over `graph` and backward from
+// `to` over `reverse` (every edge flipped; the graph itself when it is symmetric),
+// alternating by smaller queue, and stops once the two queue minimums add up to at
+// least the best meeting distance found. Settles roughly half as many nodes as
+// dijkstraPath on graphs that grow evenly in every direction.
+PathResult bidirectionalPath(const Graph& graph, const Graph& reverse, NodeId from, NodeId to);
+
+// A*: Dijkstra ordered by distance plus the heuristic's estimate of what remains
+PathResult astarPath(const Graph& graph, NodeId from, NodeId to, const PathHeuristic& heuristic);
+
+#endif
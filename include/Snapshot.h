@@ -0,0 +1,78 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+
+// On-disk snapshot formats understood by Database::load()/save()
+enum class SnapshotFormat {
+    JSON,
+    BINARY
+};
+
+// Binary snapshot layout (all integers little-endian):
+//   [header]        magic "VDBSNAP\0", version, entry count, section offsets
+//   [key block]     every key, concatenated in sorted order
+//   [offset table]  one SnapshotSlot per entry, in key order
+//   [value heap]    every value, concatenated in key order
+// The file is mmap'd read-only and lookups binary-search the offset table,
+// so nothing is parsed or copied until a key is actually read.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t keyBlockOffset;
+    uint64_t offsetTableOffset;
+    uint64_t valueHeapOffset;
+    uint64_t fileSize;
+};
+
+struct SnapshotSlot {
+    uint64_t keyOffset;    // Relative to the key block
+    uint64_t valueOffset;  // Relative to the value heap
+    uint32_t keyLength;
+    uint32_t valueLength;
+};
+
+class BinarySnapshot {
+private:
+    const char* base;
+    size_t length;
+    const SnapshotHeader* header;
+    const SnapshotSlot* slots;
+
+    BinarySnapshot();
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    ~BinarySnapshot();
+    BinarySnapshot(const BinarySnapshot&) = delete;
+    BinarySnapshot& operator=(const BinarySnapshot&) = delete;
+
+    // Map an existing snapshot; returns nullptr if the file is missing or malformed
+    static std::unique_ptr<BinarySnapshot> open(const std::string& path);
+
+    // True if the file starts with the binary snapshot magic
+    static bool isBinarySnapshot(const std::string& path);
+
+    // Serialize entries (which must be sorted by key) into a complete snapshot image
+    static std::string serialize(
+        const std::vector<std::pair<std::string_view, std::string_view>>& sortedEntries);
+
+    size_t size() const;
+    std::string_view keyAt(size_t i) const;
+    std::string_view valueAt(size_t i) const;
+
+    // Index of the first key >= `key` (size() if none)
+    size_t lowerBound(std::string_view key) const;
+    bool find(std::string_view key, std::string_view& value) const;
+    bool contains(std::string_view key) const;
+};
+
+#endif
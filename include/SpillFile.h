@@ -0,0 +1,54 @@
+#ifndef SPILL_FILE_H
+#define SPILL_FILE_H
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+// Where one spilled value lives in the spill file
+struct SpillRef {
+    static constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();
+
+    uint64_t offset = NONE;
+    uint32_t length = 0;
+
+    bool valid() const { return offset != NONE; }
+};
+
+// Scratch file that cold values are evicted to. It is not a durability mechanism
+// (the snapshot and write-ahead log are), so it is truncated on open and deleted on
+// close. Appends reserve their range with an atomic bump, so shards spill in parallel;
+// space freed by overwrites is only reclaimed by compaction.
+class SpillFile {
+private:
+    std::string path;
+    int fd;
+    std::atomic<uint64_t> endOffset;
+    std::atomic<uint64_t> deadBytes;
+
+public:
+    explicit SpillFile(const std::string& path);
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    bool open();
+    bool reset();  // Drop every spilled value
+
+    SpillRef append(std::string_view value);  // Invalid ref on I/O error
+    bool read(const SpillRef& ref, std::string& value) const;
+    void release(const SpillRef& ref);        // The value at `ref` is no longer needed
+
+    // Move the file; used to install a compacted copy in place of the original
+    bool renameTo(const std::string& newPath);
+
+    const std::string& getPath() const { return path; }
+    uint64_t sizeBytes() const { return endOffset.load(std::memory_order_relaxed); }
+    uint64_t garbageBytes() const { return deadBytes.load(std::memory_order_relaxed); }
+    uint64_t liveBytes() const { return sizeBytes() - garbageBytes(); }
+};
+
+#endif
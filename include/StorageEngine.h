@@ -0,0 +1,59 @@
+#ifndef STORAGE_ENGINE_H
+#define STORAGE_ENGINE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// Counters reported by a storage engine. Write amplification is bytes written to
+// disk (log, flushes and compactions) per byte of keys and values written by callers.
+struct StorageEngineStats {
+    std::string name;
+    uint64_t userBytes = 0;
+    uint64_t logBytes = 0;
+    uint64_t flushBytes = 0;
+    uint64_t compactionBytes = 0;
+    uint64_t flushes = 0;
+    uint64_t compactions = 0;
+    uint64_t bloomNegatives = 0;  // Run probes skipped because the filter ruled the key out
+    uint64_t runProbes = 0;       // Run probes that had to search the run
+    size_t memtableBytes = 0;
+    std::vector<size_t> runsPerLevel;
+    std::vector<uint64_t> bytesPerLevel;
+
+    uint64_t diskBytes() const { return logBytes + flushBytes + compactionBytes; }
+    double writeAmplification() const { return userBytes ? double(diskBytes()) / double(userBytes) : 0.0; }
+};
+
+// Pluggable key-value backend for Database. Implementations must be thread-safe;
+// Database calls them without holding any of its own locks.
+class StorageEngine {
+public:
+    using ScanVisitor = std::function<bool(std::string_view key, std::string_view value)>;
+
+    virtual ~StorageEngine() = default;
+
+    // Recover persisted state and start any background work
+    virtual bool open() = 0;
+
+    virtual bool put(std::string_view key, std::string_view value) = 0;
+    virtual bool remove(std::string_view key) = 0;
+    virtual bool get(std::string_view key, std::string& value) const = 0;
+
+    // Batches are logged as one record, so they recover all-or-nothing
+    virtual bool putBatch(const std::vector<std::pair<std::string_view, std::string_view>>& entries) = 0;
+    virtual bool removeBatch(const std::vector<std::string_view>& keys) = 0;
+
+    // Visit live entries with lo <= key < hi in key order (an empty `hi` is unbounded)
+    // until `visit` returns false
+    virtual void scan(std::string_view lo, std::string_view hi, const ScanVisitor& visit) const = 0;
+
+    virtual bool sync() = 0;   // Everything written so far survives a crash
+    virtual bool flush() = 0;  // ...and is folded out of the log into the engine's own files
+
+    virtual StorageEngineStats stats() const = 0;
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct ArenaBlock;
+struct FreeSlot;
+
+// One interned string, stored in an arena block with its bytes right after the header
+struct InternedEntry {
+    std::atomic<uint32_t> refs;
+    uint32_t length;
+    uint32_t stripe;
+    uint32_t hash;  // InternedString::hashText of the bytes; fills what was padding
+    ArenaBlock* block;
+
+    const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+};
+
+// Reference-counted handle to an interned string. Handles are 8 bytes, copies only
+// bump a counter, and two handles are equal exactly when they share an entry.
+class InternedString {
+private:
+    InternedEntry* entry = nullptr;
+
+    explicit InternedString(InternedEntry* adopted) : entry(adopted) {}
+    friend class StringPool;
+
+public:
+    InternedString() = default;
+    explicit InternedString(std::string_view text);  // Interns into StringPool::instance()
+    InternedString(const InternedString& other);
+    InternedString(InternedString&& other) noexcept : entry(other.entry) { other.entry = nullptr; }
+    InternedString& operator=(InternedString other) noexcept {
+        std::swap(entry, other.entry);
+        return *this;
+    }
+    ~InternedString();
+
+    bool valid() const { return entry != nullptr; }
+    std::string_view view() const {
+        return entry ? std::string_view(entry->data(), entry->length) : std::string_view();
+    }
+    operator std::string_view() const { return view(); }
+    std::string str() const { return std::string(view()); }
+    size_t size() const { return entry ? entry->length : 0; }
+    uint32_t useCount() const { return entry ? entry->refs.load(std::memory_order_relaxed) : 0; }
+    bool empty() const { return size() == 0; }
+    const void* identity() const { return entry; }
+
+    // Hash of the text, cached in the entry, so a handle and a plain view of the same
+    // string hash alike
+    static uint32_t hashText(std::string_view text) {
+        return static_cast<uint32_t>(std::hash<std::string_view>()(text));
+    }
+    uint32_t textHash() const { return entry ? entry->hash : hashText(std::string_view()); }
+
+    friend bool operator==(const InternedString& a, const InternedString& b) { return a.entry == b.entry; }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return a.entry != b.entry; }
+    friend bool operator<(const InternedString& a, const InternedString& b) {
+        return a.entry != b.entry && a.view() < b.view();
+    }
+    friend bool operator==(const InternedString& a, std::string_view b) { return a.view() == b; }
+    friend bool operator==(std::string_view a, const InternedString& b) { return a == b.view(); }
+    friend bool operator!=(const InternedString& a, std::string_view b) { return a.view() != b; }
+    friend bool operator!=(std::string_view a, const InternedString& b) { return a != b.view(); }
+    friend bool operator<(const InternedString& a, std::string_view b) { return a.view() < b; }
+    friend bool operator<(std::string_view a, const InternedString& b) { return a < b.view(); }
+
+    friend std::ostream& operator<<(std::ostream& out, const InternedString& s) { return out << s.view(); }
+};
+
+// Interned strings are unique, so hashing the entry address is enough
+struct InternedStringHash {
+    size_t operator()(const InternedString& s) const { return std::hash<const void*>()(s.identity()); }
+};
+
+// Content hash for maps that are also looked up by std::string_view
+struct InternedTextHash {
+    using is_transparent = void;
+    size_t operator()(const InternedString& s) const { return s.textHash(); }
+    size_t operator()(std::string_view text) const { return InternedString::hashText(text); }
+};
+
+using InternedMap = std::unordered_map<InternedString, InternedString, InternedStringHash>;
+
+// Pool usage; "logical" bytes are what every live handle would cost as its own copy.
+// Read from running totals, so counts changing meanwhile may be partly included.
+struct StringPoolStats {
+    size_t uniqueStrings = 0;
+    size_t references = 0;
+    size_t storedBytes = 0;
+    size_t logicalBytes = 0;
+    size_t arenaBytes = 0;
+    size_t freeBytes = 0;  // Arena bytes of released strings, waiting for a string of their size
+
+    size_t bytesSaved() const { return logicalBytes > storedBytes ? logicalBytes - storedBytes : 0; }
+};
+
+// Process-wide intern table, striped by hash so concurrent shards rarely share a lock.
+// String bytes live in 64 KB arena blocks; a block is freed once every string in it
+// has been released. A released string's slot goes on its stripe's free list and is
+// reused by the next string of the same rounded size, so under churn a stripe's
+// arena never holds more than the most bytes it ever had live in each size, plus its
+// current block. Strings bigger than a quarter block get a block of their own,
+// freed with them.
+class StringPool {
+private:
+    static constexpr size_t STRIPE_COUNT = 64;
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;
+
+    // Running totals, so stats() never walks the table. references and logicalBytes
+    // move with every handle copy and release; the rest only change under the lock.
+    struct Counters {
+        std::atomic<size_t> references{0};
+        std::atomic<size_t> logicalBytes{0};
+        std::atomic<size_t> uniqueStrings{0};
+        std::atomic<size_t> storedBytes{0};
+        std::atomic<size_t> arenaBytes{0};
+        std::atomic<size_t> freeBytes{0};
+    };
+
+    // A cache line apart, so stripes don't contend on each other's counters
+    struct alignas(64) Stripe {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string_view, InternedEntry*> table;
+        ArenaBlock* current = nullptr;  // Block new strings are carved from
+        ArenaBlock* blocks = nullptr;   // Every block owned by this stripe
+        std::vector<FreeSlot*> freeSlots;  // Released slots by size / ENTRY_ALIGN
+        Counters totals;
+    };
+
+    Stripe stripes[STRIPE_COUNT];
+
+    StringPool() = default;
+    static size_t stripeFor(std::string_view text);
+    InternedEntry* allocateLocked(Stripe& stripe, uint32_t stripeIndex, std::string_view text);
+    static void freeBlockLocked(Stripe& stripe, ArenaBlock* block);
+    static void pushFreeLocked(Stripe& stripe, ArenaBlock* block, void* slot, size_t bytes);
+    static void unlinkFreeLocked(Stripe& stripe, FreeSlot* slot);
+
+public:
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Never destroyed, so handles in static objects stay valid until exit
+    static StringPool& instance() {
+        static StringPool* pool = new StringPool();
+        return *pool;
+    }
+
+    InternedString intern(std::string_view text);
+    InternedString find(std::string_view text) const;  // Invalid handle if not interned
+    StringPoolStats stats() const;  // O(stripes)
+
+    static void addReference(InternedEntry* entry);
+    static void release(InternedEntry* entry);
+};
+
+inline void StringPool::addReference(InternedEntry* entry) {
+    entry->refs.fetch_add(1, std::memory_order_relaxed);
+    Counters& totals = instance().stripes[entry->stripe].totals;
+    totals.references.fetch_add(1, std::memory_order_relaxed);
+    totals.logicalBytes.fetch_add(entry->length, std::memory_order_relaxed);
+}
+
+inline InternedString::InternedString(const InternedString& other) : entry(other.entry) {
+    if (entry) StringPool::addReference(entry);
+}
+
+inline InternedString::InternedString(std::string_view text)
+    : InternedString(StringPool::instance().intern(text)) {}
+
+inline InternedString::~InternedString() {
+    if (entry) StringPool::release(entry);
+}
+
+#endif
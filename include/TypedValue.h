@@ -0,0 +1,114 @@
+#ifndef TYPED_VALUE_H
+#define TYPED_VALUE_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Data type enumeration for flexible storage
+enum DataType {
+    STRING,
+    INTEGER,
+    FLOAT,
+    BOOLEAN,
+    ARRAY,
+    OBJECT
+};
+
+// A value together with its type. Everything below the Database API (shards, WAL,
+// snapshots, spill file, storage engines) sees values as bytes, encoded as:
+//   STRING          the text itself, verbatim
+//   anything else   MARKER, the DataType byte, then the payload:
+//     INTEGER         8-byte little-endian two's complement
+//     FLOAT           8-byte IEEE 754 double
+//     BOOLEAN         1 byte
+//     ARRAY, OBJECT   compact JSON text (JSON null is kept as an OBJECT)
+// Numbers are fixed width, so reading one back is a copy rather than a parse.
+// A string that itself starts with MARKER gets a STRING header to stay unambiguous,
+// which leaves MARKER-prefixed forms free for blob references (see BlobStore.h).
+class TypedValue {
+private:
+    DataType type;
+    int64_t integer;
+    double number;
+    std::string text;  // STRING text, or ARRAY/OBJECT JSON
+
+    TypedValue(DataType type, int64_t integer, double number, std::string text)
+        : type(type), integer(integer), number(number), text(std::move(text)) {}
+
+public:
+    static constexpr char MARKER = '\0';
+    static constexpr size_t HEADER_BYTES = 2;
+
+    TypedValue() : TypedValue(STRING, 0, 0.0, std::string()) {}
+
+    static TypedValue ofString(std::string text) { return TypedValue(STRING, 0, 0.0, std::move(text)); }
+    static TypedValue ofInteger(int64_t value) { return TypedValue(INTEGER, value, 0.0, std::string()); }
+    static TypedValue ofFloat(double value) { return TypedValue(FLOAT, 0, value, std::string()); }
+    static TypedValue ofBoolean(bool value) { return TypedValue(BOOLEAN, value, 0.0, std::string()); }
+    static TypedValue ofArray(std::string json) { return TypedValue(ARRAY, 0, 0.0, std::move(json)); }
+    static TypedValue ofObject(std::string json) { return TypedValue(OBJECT, 0, 0.0, std::move(json)); }
+
+    // Read a literal as typed by a user: a JSON number, true/false, array or object
+    // keeps its type and anything else is a STRING
+    static TypedValue parse(std::string_view literal);
+
+    // Convert a parsed nlohmann::json value (a template so this header needn't include it)
+    template <typename Json>
+    static TypedValue fromJSON(const Json& j) {
+        if (j.is_string()) return ofString(j.template get<std::string>());
+        if (j.is_number_unsigned()) {
+            uint64_t value = j.template get<uint64_t>();
+            if (value <= static_cast<uint64_t>(INT64_MAX)) return ofInteger(static_cast<int64_t>(value));
+            return ofFloat(static_cast<double>(value));
+        }
+        if (j.is_number_integer()) return ofInteger(j.template get<int64_t>());
+        if (j.is_number_float()) return ofFloat(j.template get<double>());
+        if (j.is_boolean()) return ofBoolean(j.template get<bool>());
+        if (j.is_array()) return ofArray(j.dump());
+        return ofObject(j.dump());
+    }
+
+    // ...and back (ARRAY/OBJECT text that isn't valid JSON comes back as a string)
+    template <typename Json>
+    Json toJSONValue() const {
+        switch (type) {
+            case INTEGER: return Json(integer);
+            case FLOAT: return Json(number);
+            case BOOLEAN: return Json(integer != 0);
+            case ARRAY:
+            case OBJECT: {
+                Json parsed = Json::parse(text, nullptr, false);
+                if (!parsed.is_discarded()) return parsed;
+                break;
+            }
+            default:
+                break;
+        }
+        return Json(text);
+    }
+
+    // Decode stored bytes (never fails: malformed headers read back as STRING)
+    static TypedValue decode(std::string_view stored);
+
+    // Helpers that work on stored bytes directly
+    static bool isPlain(std::string_view stored) { return stored.empty() || stored[0] != MARKER; }
+    static DataType typeOf(std::string_view stored);
+    static bool numberOf(std::string_view stored, double& value);  // INTEGER or FLOAT only
+    static std::string display(std::string_view stored);  // Same as decode(stored).toString()
+    static std::string encodeString(std::string_view text);  // Stored form of a STRING
+    static const char* typeName(DataType type);
+
+    DataType getType() const { return type; }
+    bool isNumeric() const { return type == INTEGER || type == FLOAT; }
+    int64_t asInteger() const { return type == FLOAT ? static_cast<int64_t>(number) : integer; }
+    double asDouble() const { return type == FLOAT ? number : static_cast<double>(integer); }
+    bool asBoolean() const { return integer != 0; }
+    const std::string& asText() const { return text; }
+
+    std::string encode() const;
+    std::string toString() const;  // Text as shown by get(): strings bare, the rest as JSON
+    std::string toJSON() const;    // JSON text (strings quoted)
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Disjoint sets over dense ids 0..size()-1, with union by rank and path halving, so
+// any sequence of m operations costs O(m α(n)). Every id starts as its own set. find()
+// shortens paths as it walks them, so even lookups need exclusive access.
+class UnionFind {
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint8_t> rank;    // Upper bound on each root's tree height
+    std::vector<uint32_t> sizes;  // Set size, valid at roots
+    size_t sets = 0;
+
+public:
+    uint32_t add();  // A new singleton set; returns its id
+    void reset(size_t count);  // `count` singletons
+    size_t size() const { return parent.size(); }
+
+    uint32_t find(uint32_t id);  // The root of id's set
+    bool unite(uint32_t a, uint32_t b);  // False if a and b were already in one set
+    bool connected(uint32_t a, uint32_t b) { return find(a) == find(b); }
+
+    size_t setCount() const { return sets; }
+    size_t setSize(uint32_t id) { return sizes[find(id)]; }
+    std::vector<size_t> setSizes() const;  // Every set's size, largest first
+
+    size_t memoryUsage() const;
+};
+
+#endif
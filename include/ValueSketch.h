@@ -0,0 +1,53 @@
+#ifndef VALUE_SKETCH_H
+#define VALUE_SKETCH_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Count-min sketch over strings: `depth` rows of `width` counters, one counter per row
+// per item. While every removal matches an earlier add, an estimate never undercounts
+// and overcounts by at most ~2.7/width of the total count with high probability.
+class CountMinSketch {
+private:
+    size_t width;  // Power of two
+    size_t depth;
+    std::vector<uint32_t> counters;
+
+public:
+    explicit CountMinSketch(size_t width = 4096, size_t depth = 4);
+
+    void add(std::string_view item, int64_t delta);
+    uint64_t estimate(std::string_view item) const;
+    void clear();
+    size_t memoryUsage() const { return counters.size() * sizeof(uint32_t); }
+};
+
+// Approximate top-K under inserts and removals: a count-min sketch plus a bounded
+// table of the items with the largest estimates seen so far. An item enters the
+// table once its estimate beats the smallest one there, so every update is O(depth +
+// log capacity) apart from an O(capacity) rescan when the table's floor is crossed.
+class HeavyHitters {
+private:
+    CountMinSketch sketch;
+    size_t capacity;
+    std::map<std::string, uint64_t, std::less<>> candidates;  // Small; looked up by string_view
+    uint64_t floor;  // Never above the smallest estimate in a full table
+
+    void admit(std::string_view item, uint64_t estimate);
+
+public:
+    explicit HeavyHitters(size_t capacity = 64);
+
+    void add(std::string_view item);
+    void remove(std::string_view item);
+    void clear();
+
+    // Up to k items by estimated count, largest first
+    std::vector<std::pair<std::string, uint64_t>> top(size_t k) const;
+    size_t memoryUsage() const;
+};
+
+#endif
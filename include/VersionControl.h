@@ -16,10 +16,10 @@ struct Commit {
     std::string branchName;
     std::string author;
     std::chrono::system_clock::time_point timestamp;
-    std::unordered_map<std::string, std::string> snapshot;
+    InternedMap snapshot;  // Shares its strings with the database and other commits
     int parentId;
     std::set<int> mergedFrom;
-    std::unordered_map<std::string, std::set<Edge>> graphSnapshot;
+    Graph graphSnapshot;  // Shares node names with the database
 };
 
 // 🛠️ Commit log structure
@@ -0,0 +1,101 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// Tuning knobs for the write-ahead log
+struct WALOptions {
+    bool syncOnCommit = true;           // Block each write until its record is fsync'd
+    size_t groupCommitSize = 64;        // Flush as soon as this many records are pending
+    int groupCommitIntervalMs = 5;      // ...or after this long, whichever comes first
+    size_t checkpointBytes = 8 << 20;   // Fold the log into the snapshot past this size
+    int checkpointIntervalMs = 1000;    // How often the checkpoint thread checks the log
+};
+
+enum class WALOp : uint8_t {
+    INSERT = 1,
+    REMOVE = 2,
+    BATCH_INSERT = 3,   // `value` packs every (key, value) pair of the batch
+    BATCH_REMOVE = 4    // `value` packs every key of the batch
+};
+
+// A single logged mutation
+struct WALRecord {
+    WALOp op;
+    std::string key;
+    std::string value;
+};
+
+// Append-only, checksummed mutation log with group-commit fsync batching.
+// Record layout: [u32 payload length][u32 crc32(payload)][payload]
+// Payload layout: [u8 op][u32 key length][key][u32 value length][value]
+class WriteAheadLog {
+private:
+    std::string path;
+    WALOptions options;
+    int fd;
+
+    std::mutex ioMutex;                 // Serializes file I/O (always taken before `mutex`)
+    std::mutex mutex;                   // Guards the pending buffer and LSNs
+    std::condition_variable flushCv;
+    std::condition_variable durableCv;
+    std::string buffer;
+    size_t pendingRecords;
+    uint64_t appendedLsn;
+    uint64_t durableLsn;
+    bool stopping;
+    bool failed;
+    std::atomic<size_t> fileBytes;
+    std::thread flusher;
+
+    void flusherLoop();
+    bool writeAndSync(const std::string& bytes);
+    bool flushPending();  // Requires ioMutex
+    static bool syncDirectoryOf(const std::string& path);
+    static std::string encode(const WALRecord& record);
+    static bool applyBatch(const WALRecord& batch, const std::function<void(const WALRecord&)>& apply);
+    static size_t replayFile(const std::string& path,
+                             const std::function<void(const WALRecord&)>& apply,
+                             bool truncateTornTail);
+
+public:
+    WriteAheadLog(const std::string& path, const WALOptions& options = WALOptions());
+    ~WriteAheadLog();
+
+    bool open();
+    void close();
+
+    // Logging: enqueue() orders a record and returns its LSN (0 on failure);
+    // waitDurable() blocks until that LSN is fsync'd when syncOnCommit is set
+    uint64_t enqueue(const WALRecord& record);
+    bool waitDurable(uint64_t lsn);
+    bool append(const WALRecord& record);
+    bool sync();
+
+    // Pack a whole batch into one record so it is checksummed, logged and replayed atomically
+    static WALRecord batchInsertRecord(const std::vector<std::pair<std::string_view, std::string_view>>& entries);
+    static WALRecord batchRemoveRecord(const std::vector<std::string_view>& keys);
+
+    // Recovery: replays the rotated log (if any) then the live log, returns records applied.
+    // Batch records are expanded, so `apply` only ever sees INSERT and REMOVE.
+    size_t replay(const std::function<void(const WALRecord&)>& apply);
+
+    // Checkpointing: rotate() moves the live log aside so a snapshot can be written,
+    // discardRotated() drops it once that snapshot is safely on disk
+    bool rotate();
+    bool discardRotated();
+
+    size_t sizeBytes() const;
+    bool hasRecords() const;  // Whether the live or rotated log holds anything to replay
+    std::string rotatedPath() const;
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/BlobStore.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/TypedValue.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace {
+
+constexpr size_t RECORD_HEADER_BYTES = 8 + 4;  // Hash, then length
+constexpr uint64_t MIN_MAPPING_BYTES = 1 << 20;
+
+bool writeAll(int fd, const char* data, size_t length, uint64_t offset) {
+    for (size_t written = 0; written < length;) {
+        ssize_t n = ::pwrite(fd, data + written, length - written, offset + written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t length, uint64_t offset) {
+    for (size_t done = 0; done < length;) {
+        ssize_t n = ::pread(fd, data + done, length - done, offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string BlobRef::encode() const {
+    std::string stored(ENCODED_BYTES, '\0');
+    stored[0] = TypedValue::MARKER;
+    stored[1] = TAG;
+    std::memcpy(&stored[2], &offset, sizeof(offset));
+    std::memcpy(&stored[10], &length, sizeof(length));
+    std::memcpy(&stored[14], &hash, sizeof(hash));
+    return stored;
+}
+
+bool BlobRef::decode(std::string_view stored, BlobRef& ref) {
+    if (stored.size() != ENCODED_BYTES || stored[0] != TypedValue::MARKER || stored[1] != TAG) return false;
+    std::memcpy(&ref.offset, stored.data() + 2, sizeof(ref.offset));
+    std::memcpy(&ref.length, stored.data() + 10, sizeof(ref.length));
+    std::memcpy(&ref.hash, stored.data() + 14, sizeof(ref.hash));
+    return true;
+}
+
+// 🛠️ Constructor
+BlobStore::BlobStore(const std::string& path, bool syncWrites)
+    : path(path), fd(-1), syncWrites(syncWrites), endOffset(0), dedupHits(0), bytesSaved(0),
+      current(nullptr) {}
+
+BlobStore::~BlobStore() {
+    for (const Mapping& mapping : mappings) munmap(const_cast<char*>(mapping.base), mapping.length);
+    if (fd >= 0) ::close(fd);
+}
+
+// 🛠️ Open (or create) the blob file and rebuild the hash index from its records
+bool BlobStore::open() {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || !recover()) {
+        std::cerr << "Error opening blob file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 🛠️ Walk the record headers; a record cut short by a crash is truncated away (its
+// reference was never logged, since a blob is synced before its reference is returned)
+bool BlobStore::recover() {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+
+    uint64_t offset = 0;
+    char header[RECORD_HEADER_BYTES];
+    while (offset + RECORD_HEADER_BYTES <= fileSize && readAll(fd, header, sizeof(header), offset)) {
+        BlobRef ref;
+        std::memcpy(&ref.hash, header, sizeof(ref.hash));
+        std::memcpy(&ref.length, header + 8, sizeof(ref.length));
+        ref.offset = offset + RECORD_HEADER_BYTES;
+        if (ref.offset + ref.length > fileSize) break;
+        byHash.emplace(ref.hash, ref);
+        offset = ref.offset + ref.length;
+    }
+    if (offset != fileSize && ::ftruncate(fd, static_cast<off_t>(offset)) != 0) return false;
+    endOffset = offset;
+    return true;
+}
+
+// 🛠️ Map the file far enough to cover `needed` bytes, reserving room to grow into.
+// Pages past the end of the file are never touched: views only cover written blobs.
+bool BlobStore::mapLocked(uint64_t needed) const {
+    const Mapping* mapped = current.load(std::memory_order_acquire);
+    if (mapped && mapped->length >= needed) return true;
+    uint64_t length = std::max<uint64_t>(MIN_MAPPING_BYTES, mapped ? mapped->length : 0);
+    while (length < needed) length *= 2;
+    void* base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return false;
+    mappings.push_back({static_cast<const char*>(base), length});
+    current.store(&mappings.back(), std::memory_order_release);
+    return true;
+}
+
+std::string_view BlobStore::viewLocked(const BlobRef& ref) const {
+    uint64_t end = ref.offset + ref.length;
+    if (end > endOffset.load(std::memory_order_acquire) || !mapLocked(end)) return std::string_view();
+    return std::string_view(current.load(std::memory_order_acquire)->base + ref.offset, ref.length);
+}
+
+// 🛠️ View a blob in place; only a read past the current mapping takes the lock
+std::string_view BlobStore::view(const BlobRef& ref) const {
+    uint64_t end = ref.offset + ref.length;
+    if (end > endOffset.load(std::memory_order_acquire)) return std::string_view();
+    const Mapping* mapped = current.load(std::memory_order_acquire);
+    if (mapped && mapped->length >= end) return std::string_view(mapped->base + ref.offset, ref.length);
+    std::lock_guard<std::mutex> lock(mutex);
+    return viewLocked(ref);
+}
+
+bool BlobStore::find(std::string_view value, BlobRef& ref) const {
+    uint64_t hash = std::hash<std::string_view>()(value);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [first, last] = byHash.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second.length == value.size() && viewLocked(it->second) == value) {
+            ref = it->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 🛠️ Deduplicate by hash (confirmed byte for byte), else append a new record
+bool BlobStore::put(std::string_view value, BlobRef& ref) {
+    if (fd < 0 || value.size() > std::numeric_limits<uint32_t>::max()) return false;
+    uint64_t hash = std::hash<std::string_view>()(value);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [first, last] = byHash.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second.length == value.size() && viewLocked(it->second) == value) {
+            ref = it->second;
+            dedupHits++;
+            bytesSaved += value.size();
+            return true;
+        }
+    }
+
+    uint64_t offset = endOffset.load(std::memory_order_relaxed);
+    char header[RECORD_HEADER_BYTES];
+    uint32_t length = static_cast<uint32_t>(value.size());
+    std::memcpy(header, &hash, sizeof(hash));
+    std::memcpy(header + 8, &length, sizeof(length));
+    if (!writeAll(fd, header, sizeof(header), offset) ||
+        !writeAll(fd, value.data(), value.size(), offset + sizeof(header)) ||
+        (syncWrites && ::fsync(fd) != 0)) {
+        // Leave endOffset alone: the next append overwrites the partial record
+        return false;
+    }
+    ref = {offset + sizeof(header), length, hash};
+    byHash.emplace(hash, ref);
+    endOffset.store(ref.offset + length, std::memory_order_release);
+    return true;
+}
+
+// 🛠️ Send a byte range straight from the page cache to a socket or file
+bool BlobStore::sendTo(int outFd, uint64_t offset, uint64_t length) const {
+    if (offset + length > endOffset.load(std::memory_order_acquire)) return false;
+#ifdef __linux__
+    off_t position = static_cast<off_t>(offset);
+    while (length > 0) {
+        ssize_t n = ::sendfile(outFd, fd, &position, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        length -= static_cast<uint64_t>(n);
+    }
+    return true;
+#else
+    BlobRef range{offset, static_cast<uint32_t>(length), 0};
+    std::string_view bytes = view(range);
+    while (!bytes.empty()) {
+        ssize_t n = ::write(outFd, bytes.data(), bytes.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+#endif
+}
+
+bool BlobStore::sync() const {
+    return fd >= 0 && ::fsync(fd) == 0;
+}
+
+BlobStoreStats BlobStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    BlobStoreStats stats;
+    stats.blobs = byHash.size();
+    stats.fileBytes = endOffset.load(std::memory_order_relaxed);
+    stats.dedupHits = dedupHits;
+    stats.bytesSaved = bytesSaved;
+    return stats;
+}
@@ -1,5 +1,6 @@
 #include "/Users/gaganphadke/Versioning/versioned-db/include/Database.h"
 #include "/Users/gaganphadke/Versioning/versioned-db/include/BTree.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ParallelSort.h"
 #include <fstream>
 #include <iostream>
 #include <regex>
@@ -7,282 +8,3353 @@
 #include <mutex>
 #include <unordered_set>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <iterator>
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
 using json = nlohmann::json;
 
-std::mutex dataMutex;  // Define the mutex globally if not defined elsewhere
 
-std::unordered_map<std::string, std::set<Edge>> graph; 
+namespace {
+
+using ImportBatch = std::vector<std::pair<std::string, std::string>>;
+using ImportSink = std::function<bool(const ImportBatch&)>;  // False stops the import
+
+constexpr size_t IMPORT_BATCH_SIZE = 4096;
+constexpr size_t NDJSON_CHUNK_BYTES = 4 << 20;
+
+// NDJSON files hold one {"key": ..., "value": ...} object per line
+bool isNDJSONPath(const std::string& path) {
+    for (const std::string suffix : {".ndjson", ".jsonl"}) {
+        if (path.size() >= suffix.size() &&
+            path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stored form of a JSON value: strings verbatim, anything else typed (see TypedValue.h)
+std::string storedValue(const json& value) {
+    if (value.is_string()) return TypedValue::encodeString(value.get_ref<const std::string&>());
+    return TypedValue::fromJSON(value).encode();
+}
+
+// JSON form of a stored value, for JSON snapshots
+json jsonValue(std::string_view stored) {
+    if (TypedValue::isPlain(stored)) return std::string(stored);
+    return TypedValue::decode(stored).toJSONValue<json>();
+}
+
+// The part of a stored value that get() shows verbatim: all of a plain string, the
+// text after the header of a STRING, ARRAY or OBJECT. Numbers and booleans are formatted.
+bool shownInPlace(std::string_view stored, std::string_view& shown) {
+    if (TypedValue::isPlain(stored)) {
+        shown = stored;
+        return true;
+    }
+    if (stored.size() < TypedValue::HEADER_BYTES) return false;
+    DataType type = static_cast<DataType>(stored[1]);
+    if (type != STRING && type != ARRAY && type != OBJECT) return false;
+    shown = stored.substr(TypedValue::HEADER_BYTES);
+    return true;
+}
+
+// Smallest string greater than every string starting with `prefix` ("" if none is)
+std::string prefixSuccessor(const std::string& prefix) {
+    std::string upper = prefix;
+    while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xFF) upper.pop_back();
+    if (!upper.empty()) upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+    return upper;
+}
+
+// Append `text` as a quoted JSON string
+void appendQuoted(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// Append a stored value as JSON: strings quoted, typed values as JSON literals
+void appendJSONValue(std::string& out, std::string_view stored) {
+    if (TypedValue::isPlain(stored)) appendQuoted(out, stored);
+    else out += TypedValue::decode(stored).toJSON();
+}
+
+// SAX handler for a top-level JSON object. Scalar members are converted as they are
+// read; nested objects and arrays are assembled into a small DOM and dumped. Every
+// IMPORT_BATCH_SIZE members the batch is handed to the sink and reused.
+class ImportHandler : public nlohmann::json_sax<json> {
+private:
+    const ImportSink& sink;
+    ImportBatch batch;
+    std::string memberKey;
+    std::vector<json> nested;             // Open containers below the top-level object
+    std::vector<std::string> nestedKeys;  // Pending key for each open nested object
+    bool inObject = false;
+    bool done = false;
+
+    bool value(json v) {
+        if (!nested.empty()) {
+            json& parent = nested.back();
+            if (parent.is_array()) parent.push_back(std::move(v));
+            else parent[nestedKeys.back()] = std::move(v);
+            return true;
+        }
+        if (!inObject) return fail("top-level value must be an object");
+        batch.emplace_back(std::move(memberKey), storedValue(v));
+        if (batch.size() >= IMPORT_BATCH_SIZE && !flush()) return fail("could not store the batch");
+        return true;
+    }
+
+    bool fail(const std::string& message) {
+        error = message;
+        return false;
+    }
+
+public:
+    std::string error;
+
+    explicit ImportHandler(const ImportSink& sink) : sink(sink) {
+        batch.reserve(IMPORT_BATCH_SIZE);
+    }
+
+    bool flush() {
+        bool stored = batch.empty() || sink(batch);
+        batch.clear();
+        return stored;
+    }
+
+    bool null() override { return value(nullptr); }
+    bool boolean(bool val) override { return value(val); }
+    bool number_integer(number_integer_t val) override { return value(val); }
+    bool number_unsigned(number_unsigned_t val) override { return value(val); }
+    bool number_float(number_float_t val, const string_t&) override { return value(val); }
+    bool string(string_t& val) override { return value(std::move(val)); }
+    bool binary(binary_t& val) override { return value(json::binary(std::move(val))); }
+
+    bool start_object(std::size_t) override {
+        if (!inObject && nested.empty()) {
+            if (done) return fail("unexpected second top-level value");
+            inObject = true;
+            return true;
+        }
+        nested.push_back(json::object());
+        nestedKeys.emplace_back();
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (nested.empty()) memberKey = std::move(val);
+        else nestedKeys.back() = std::move(val);
+        return true;
+    }
+
+    bool end_object() override {
+        if (nested.empty()) {
+            inObject = false;
+            done = true;
+            return true;
+        }
+        json finished = std::move(nested.back());
+        nested.pop_back();
+        nestedKeys.pop_back();
+        return value(std::move(finished));
+    }
+
+    bool start_array(std::size_t) override {
+        if (!inObject) return fail("top-level value must be an object");
+        nested.push_back(json::array());
+        nestedKeys.emplace_back();
+        return true;
+    }
+
+    bool end_array() override {
+        json finished = std::move(nested.back());
+        nested.pop_back();
+        nestedKeys.pop_back();
+        return value(std::move(finished));
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        return fail(ex.what());
+    }
+};
+
+// 🛠️ Stream a JSON object into the sink, one batch at a time
+bool importJSONStream(std::istream& in, const ImportSink& sink) {
+    ImportHandler handler(sink);
+    if (!json::sax_parse(in, &handler) || !handler.flush()) {
+        if (handler.error.empty()) handler.error = "could not store the batch";
+        std::cerr << "Error importing JSON: " << handler.error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 🛠️ Parse one NDJSON chunk (whole lines only); `firstLine` is used for error messages
+bool parseNDJSONChunk(const std::string& chunk, size_t firstLine, ImportBatch& out, std::string& error) {
+    size_t line = firstLine;
+    for (size_t begin = 0; begin < chunk.size(); line++) {
+        size_t end = chunk.find('\n', begin);
+        if (end == std::string::npos) end = chunk.size();
+        size_t first = chunk.find_first_not_of(" \t\r", begin);
+        if (first < end) {
+            try {
+                json record = json::parse(chunk.begin() + begin, chunk.begin() + end);
+                if (!record.is_object() || !record.contains("key") || !record["key"].is_string() ||
+                    !record.contains("value")) {
+                    error = "line " + std::to_string(line) + ": expected {\"key\": ..., \"value\": ...}";
+                    return false;
+                }
+                out.emplace_back(record["key"].get<std::string>(), storedValue(record["value"]));
+            } catch (const std::exception& e) {
+                error = "line " + std::to_string(line) + ": " + e.what();
+                return false;
+            }
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+// 🛠️ Stream NDJSON into the sink: the file is read in newline-aligned chunks, one per
+// core, which are parsed in parallel and then applied in file order
+bool importNDJSONStream(std::istream& in, const ImportSink& sink) {
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::string carry;
+    size_t nextLine = 1;
+    bool eof = false;
+
+    while (!eof) {
+        std::vector<std::string> chunks;
+        while (chunks.size() < workers && !eof) {
+            std::string chunk = std::move(carry);
+            carry.clear();
+            size_t have = chunk.size();
+            chunk.resize(have + NDJSON_CHUNK_BYTES);
+            in.read(&chunk[have], NDJSON_CHUNK_BYTES);
+            chunk.resize(have + static_cast<size_t>(in.gcount()));
+            eof = !in;
+            if (!eof) {
+                // Hold back the partial last line; a line longer than a chunk just keeps growing
+                size_t cut = chunk.rfind('\n');
+                if (cut == std::string::npos) {
+                    carry = std::move(chunk);
+                    continue;
+                }
+                carry.assign(chunk, cut + 1, std::string::npos);
+                chunk.resize(cut + 1);
+            }
+            chunks.push_back(std::move(chunk));
+        }
+
+        std::vector<size_t> firstLines(chunks.size());
+        for (size_t i = 0; i < chunks.size(); i++) {
+            firstLines[i] = nextLine;
+            nextLine += std::count(chunks[i].begin(), chunks[i].end(), '\n');
+        }
+
+        std::vector<ImportBatch> parsed(chunks.size());
+        std::vector<std::string> errors(chunks.size());
+        std::vector<char> ok(chunks.size(), 1);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            threads.emplace_back([&, i] {
+                ok[i] = parseNDJSONChunk(chunks[i], firstLines[i], parsed[i], errors[i]);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (!ok[i]) {
+                std::cerr << "Error importing NDJSON: " << errors[i] << std::endl;
+                return false;
+            }
+            if (!parsed[i].empty() && !sink(parsed[i])) {
+                std::cerr << "Error importing NDJSON: could not store the batch from line "
+                          << firstLines[i] << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
 
 // 🛠️ Insert a node
 void Database::insertNode(const std::string& node) {
-    if (!graph.count(node)) graph[node] = {};
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    graph.addNode(node);
+    if (!componentsStale) syncComponentsLocked();
+}
+
+// 🛠️ Insert an edge, in both directions, and join its ends' components
+bool Database::insertEdge(const std::string& from, const std::string& to, int weight) {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    NodeId u = graph.addNode(from);
+    NodeId v = graph.addNode(to);
+    syncComponentsLocked();  // Rebuilds after removals, before this edge is in
+    bool added = graph.addEdge(u, v, weight);
+    graph.addEdge(v, u, weight);  // For undirected graphs
+    if (graph.shouldCompact()) graph.compact();
+    if (!added || components.unite(u, v)) return false;
+    cycleEdges++;
+    return true;
+}
+
+// 🛠️ Remove an edge in both directions. Components may split, which a union-find
+// can't follow, so they are rebuilt when next needed.
+bool Database::removeEdge(const std::string& from, const std::string& to) {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    NodeId u = graph.find(from);
+    NodeId v = graph.find(to);
+    if (u == Graph::NONE || v == Graph::NONE || !graph.removeEdge(u, v)) return false;
+    graph.removeEdge(v, u);
+    if (graph.shouldCompact()) graph.compact();
+    componentsStale = true;
+    return true;
+}
+
+// 🛠️ Bring the components up to date (caller holds graphMutex exclusively): add
+// singletons for new nodes, or rebuild from every edge once if they went stale
+void Database::syncComponentsLocked() const {
+    if (!componentsStale) {
+        while (components.size() < graph.nodeCount()) components.add();
+        return;
+    }
+    graph.compact();
+    components.reset(graph.nodeCount());
+    cycleEdges = 0;
+    for (NodeId u = 0; u < graph.nodeCount(); u++) {
+        const NodeId* row = graph.targetsOf(u);
+        for (size_t i = 0, n = graph.degree(u); i < n; i++) {
+            if (row[i] >= u && !components.unite(u, row[i])) cycleEdges++;  // Each edge once
+        }
+    }
+    componentsStale = false;
+}
+
+// 🛠️ Read-lock the graph with the delta buffer merged, compacting first if needed
+std::shared_lock<std::shared_mutex> Database::lockGraphCompacted() const {
+    std::shared_lock<std::shared_mutex> lock(graphMutex);
+    while (graph.pendingEdges()) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> writeLock(graphMutex);
+            graph.compact();
+        }
+        lock.lock();
+    }
+    return lock;
+}
+
+// 🛠️ BFS traversal
+std::vector<std::string> Database::bfs(const std::string& start) const {
+    return bfs(start, BfsOptions{}).nodes;
+}
+
+// 🛠️ BFS traversal with a depth limit and parents; the graph is its own reverse
+GraphBfs Database::bfs(const std::string& start, const BfsOptions& options) const {
+    GraphBfs traversal;
+    auto lock = lockGraphCompacted();
+    NodeId id = graph.find(start);
+    if (id == Graph::NONE) {
+        traversal.nodes = {start};
+        traversal.levelOffsets = {0, 1};
+        if (options.parents) traversal.parents = {start};
+        return traversal;
+    }
+    BfsResult result = parallelBfs(graph, graph, id, options);
+    traversal.nodes.reserve(result.order.size());
+    for (NodeId node : result.order) {
+        traversal.nodes.emplace_back(graph.name(node));
+        if (options.parents) traversal.parents.emplace_back(graph.name(result.parents[node]));
+    }
+    traversal.levelOffsets = std::move(result.levelOffsets);
+    return traversal;
+}
+
+// 🛠️ DFS traversal
+std::vector<std::string> Database::dfs(const std::string& start) const {
+    auto lock = lockGraphCompacted();
+    NodeId id = graph.find(start);
+    if (id == Graph::NONE) return {start};
+    std::vector<std::string> result;
+    for (NodeId node : graph.dfs(id)) result.emplace_back(graph.name(node));
+    return result;
+}
+
+namespace {
+
+void requireNonNegativeWeights(const Graph& graph) {
+    if (graph.hasNegativeWeights()) throw std::invalid_argument("shortest paths need non-negative edge weights");
+}
+
+GraphPath namedPath(const Graph& graph, const PathResult& result) {
+    GraphPath path;
+    path.found = result.found;
+    path.distance = result.found ? result.distance : 0;
+    path.settled = result.settled;
+    for (NodeId node : result.nodes) path.nodes.emplace_back(graph.name(node));
+    return path;
+}
+
+}  // namespace
+
+// 🛠️ Shortest path by bidirectional Dijkstra; the graph is its own reverse
+GraphPath Database::shortestPath(const std::string& from, const std::string& to) const {
+    auto lock = lockGraphCompacted();
+    requireNonNegativeWeights(graph);
+    NodeId source = graph.find(from);
+    NodeId target = graph.find(to);
+    if (source == Graph::NONE || target == Graph::NONE) return {};
+    return namedPath(graph, bidirectionalPath(graph, graph, source, target));
+}
+
+// 🛠️ Shortest path by A*, with the heuristic given node names
+GraphPath Database::shortestPath(const std::string& from, const std::string& to,
+                                 const std::function<uint64_t(std::string_view)>& heuristic) const {
+    auto lock = lockGraphCompacted();
+    requireNonNegativeWeights(graph);
+    NodeId source = graph.find(from);
+    NodeId target = graph.find(to);
+    if (source == Graph::NONE || target == Graph::NONE) return {};
+    auto byId = [&](NodeId node) { return heuristic(graph.name(node)); };
+    return namedPath(graph, astarPath(graph, source, target, byId));
+}
+
+// 🛠️ Distance from `source` to every node it reaches, nearest first
+std::vector<std::pair<std::string, uint64_t>> Database::shortestDistances(const std::string& source) const {
+    auto lock = lockGraphCompacted();
+    requireNonNegativeWeights(graph);
+    NodeId start = graph.find(source);
+    if (start == Graph::NONE) return {};
+    std::vector<uint64_t> dist = ::shortestDistances(graph, start);
+    std::vector<std::pair<std::string, uint64_t>> reached;
+    for (NodeId node = 0; node < dist.size(); node++) {
+        if (dist[node] != UNREACHABLE) reached.emplace_back(graph.name(node), dist[node]);
+    }
+    std::stable_sort(reached.begin(), reached.end(),
+                     [](const auto& a, const auto& b) { return a.second < b.second; });
+    return reached;
+}
+
+// 🛠️ Copy of the graph for a commit, compacted so checkouts restore it ready to read
+Graph Database::graphSnapshot() const {
+    auto lock = lockGraphCompacted();
+    return graph;
+}
+
+void Database::restoreGraph(Graph snapshot) {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    graph = std::move(snapshot);
+    componentsStale = true;
+}
+
+// 🛠️ Same component check
+bool Database::connected(const std::string& a, const std::string& b) const {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    NodeId u = graph.find(a);
+    NodeId v = graph.find(b);
+    if (u == Graph::NONE || v == Graph::NONE) return false;
+    syncComponentsLocked();
+    return components.connected(u, v);
+}
+
+size_t Database::componentCount() const {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    syncComponentsLocked();
+    return components.setCount();
+}
+
+size_t Database::componentSize(const std::string& node) const {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    NodeId id = graph.find(node);
+    if (id == Graph::NONE) return 0;
+    syncComponentsLocked();
+    return components.setSize(id);
+}
+
+std::vector<size_t> Database::componentSizes() const {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    syncComponentsLocked();
+    return components.setSizes();
+}
+
+bool Database::hasCycle() const {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    syncComponentsLocked();
+    return cycleEdges > 0;
+}
+
+// 🛠️ Constructor with B-Tree Initialization and shard allocation
+Database::Database(const std::string& filename, size_t shardCount)
+    : filename(filename), valueIndexReady(false), memoryBudget(0), stopCheckpointer(false), walReplayed(false),
+      snapshotFormat(SnapshotFormat::JSON), blobThreshold(DEFAULT_BLOB_THRESHOLD), writeSeq(0), openSnapshots(0), newestSnapshot(0),
+      savedVersions(0) {
+    size_t count = 1;
+    while (count < shardCount) count <<= 1;
+    shardMask = count - 1;
+    shards.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+// 🛠️ Destructor: stop the checkpointer and flush the log
+Database::~Database() {
+    {
+        std::lock_guard<std::mutex> lock(checkpointWaitMutex);
+        stopCheckpointer = true;
+    }
+    checkpointCv.notify_all();
+    if (checkpointer.joinable()) checkpointer.join();
+    if (wal) wal->close();
+}
+
+// 🛠️ Pick a key's shard from the high bits of its (mixed) hash
+size_t Database::shardIndexFor(std::string_view key) const {
+    uint64_t h = std::hash<std::string_view>{}(key) * 0x9E3779B97F4A7C15ull;
+    return (h >> 32) & shardMask;
+}
+
+Database::Shard& Database::shardFor(std::string_view key) const {
+    return *shards[shardIndexFor(key)];
+}
+
+// 🛠️ Lock every shard, always in ascending order
+std::vector<std::unique_lock<std::shared_mutex>> Database::lockAllShards() const {
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(shards.size());
+    for (const auto& shard : shards) locks.emplace_back(shard->mutex);
+    return locks;
+}
+
+std::vector<std::shared_lock<std::shared_mutex>> Database::lockAllShardsShared() const {
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    locks.reserve(shards.size());
+    for (const auto& shard : shards) locks.emplace_back(shard->mutex);
+    return locks;
+}
+
+// 🛠️ Drop every entry and the mapped snapshot (caller holds every shard lock and
+// resetMutex). Open read snapshots keep seeing the old data through saved versions.
+void Database::clearShardsLocked() {
+    if (openSnapshots.load(std::memory_order_relaxed)) {
+        uint64_t seq = ++writeSeq;
+        forEachEntry([&](std::string_view key, std::string_view) {
+            saveVersionLocked(shardFor(key), key, seq, true);
+        }, true);
+    }
+    for (auto& shard : shards) {
+        shard->entries.clear();
+        shard->maskedKeys.clear();
+        shard->residentBytes = 0;
+        shard->spilledValues = 0;
+        shard->recountShared();
+        shard->clockHand = 0;
+    }
+    mappedSnapshot.reset();
+    if (spill) spill->reset();
+}
+
+// 🛠️ Turn on write-ahead logging; mutations are appended to <filename>.wal. Checkpoints
+// wait for load() to replay whatever a previous run left in the log.
+bool Database::enableWAL(const WALOptions& options) {
+    if (wal) return true;
+    walOptions = options;
+    auto log = std::make_unique<WriteAheadLog>(filename + ".wal", options);
+    if (!log->open()) return false;
+    walReplayed = !log->hasRecords();
+    wal = std::move(log);
+    checkpointer = std::thread(&Database::checkpointLoop, this);
+    return true;
+}
+
+bool Database::isWALEnabled() const {
+    return wal != nullptr;
+}
+
+// 🛠️ Keep values of at least `threshold` bytes in <filename>.blobs. A reference must
+// never be logged before its blob is durable, so blobs are synced whenever the log is.
+bool Database::enableBlobStore(size_t threshold) {
+    if (blobs) return true;
+    // Anything shorter than a reference is cheaper to keep inline
+    blobThreshold = std::max(threshold, BlobRef::ENCODED_BYTES + 1);
+    auto store = std::make_unique<BlobStore>(filename + ".blobs", !wal || walOptions.syncOnCommit);
+    if (!store->open()) return false;
+    blobs = std::move(store);
+    return true;
+}
+
+bool Database::hasBlobStore() const {
+    return blobs != nullptr;
+}
+
+const BlobStore* Database::getBlobStore() const {
+    return blobs.get();
+}
+
+std::string Database::placeValue(std::string stored) {
+    BlobRef ref;
+    if (blobs && stored.size() >= blobThreshold && blobs->put(stored, ref)) return ref.encode();
+    return stored;  // Kept inline if the blob file can't be written
+}
+
+InternedString Database::placeValue(const InternedString& stored) {
+    BlobRef ref;
+    if (blobs && stored.size() >= blobThreshold && blobs->put(stored.view(), ref)) {
+        return InternedString(ref.encode());
+    }
+    return stored;
+}
+
+std::string Database::probeValue(std::string stored) const {
+    BlobRef ref;
+    if (blobs && stored.size() >= blobThreshold && blobs->find(stored, ref)) return ref.encode();
+    return stored;
+}
+
+// 🛠️ The bytes a stored value stands for; views into the blob file stay valid for the
+// life of the database
+std::string_view Database::resolveValue(std::string_view stored) const {
+    BlobRef ref;
+    if (!blobs || !BlobRef::decode(stored, ref)) return stored;
+    return blobs->view(ref);
+}
+
+// 🛠️ A stored value as get() shows it. Plain inline values already are, so they keep
+// their pool entry instead of interning a copy.
+InternedString Database::shownValue(const InternedString& stored) const {
+    std::string_view bytes = resolveValue(stored.view());
+    if (bytes.data() == stored.view().data() && TypedValue::isPlain(bytes)) return stored;
+    return InternedString(TypedValue::display(bytes));
+}
+
+// 🛠️ Hand storage over to a backend engine (before load(); opens the engine)
+bool Database::setStorageEngine(std::unique_ptr<StorageEngine> storage) {
+    if (engine || !storage || !storage->open()) return false;
+    engine = std::move(storage);
+    return true;
+}
+
+bool Database::hasStorageEngine() const {
+    return engine != nullptr;
+}
+
+// 🛠️ Background checkpointing: fold the log into the snapshot once it grows large
+void Database::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(checkpointWaitMutex);
+    while (!stopCheckpointer) {
+        checkpointCv.wait_for(lock, std::chrono::milliseconds(walOptions.checkpointIntervalMs),
+                              [&] { return stopCheckpointer; });
+        if (stopCheckpointer) break;
+        lock.unlock();
+        if (walReplayed) {
+            std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+            if (wal->sizeBytes() >= walOptions.checkpointBytes) checkpointLocked();
+        }
+        lock.lock();
+    }
+}
+
+// 🛠️ Write a snapshot and drop the log records it covers
+bool Database::checkpoint() {
+    if (engine) return engine->flush();
+    if (!wal) return save();
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+    return checkpointLocked();
+}
+
+// 🛠️ Checkpoint body (caller holds checkpointMutex)
+bool Database::checkpointLocked() {
+    if (!walReplayed) {
+        std::cerr << "Write-ahead log not replayed yet; load() before checkpointing" << std::endl;
+        return false;
+    }
+    // Open a read snapshot and rotate the log together so every record is covered by
+    // either the new snapshot or the fresh live log. Shared shard locks are enough:
+    // writers log while holding their shard exclusively, so none are mid-flight.
+    auto locks = lockAllShardsShared();
+    ReadSnapshot view(this, registerSnapshotLocked());
+    bool rotated = wal->rotate();
+    locks.clear();
+    if (!rotated) {
+        std::cerr << "Error rotating write-ahead log" << std::endl;
+        return false;
+    }
+
+    // Writers carry on while the snapshot is serialized
+    std::string contents = snapshotContentsAt(view.sequence());
+    if (!writeSnapshot(contents)) return false;
+    return wal->discardRotated();
+}
+
+void Database::setSnapshotFormat(SnapshotFormat format) {
+    snapshotFormat = format;
+}
+
+SnapshotFormat Database::getSnapshotFormat() const {
+    return snapshotFormat;
+}
+
+// 🛠️ Serialize the full database in the configured snapshot format
+std::string Database::snapshotContentsLocked() const {
+    if (snapshotFormat == SnapshotFormat::BINARY) {
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        std::deque<std::string> spilledValues;
+        forEachEntry([&](std::string_view key, std::string_view value) {
+            entries.emplace_back(key, value);
+        }, true, &spilledValues);
+        parallelSort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+        return BinarySnapshot::serialize(entries);
+    }
+
+    json j = json::object();
+    forEachEntry([&](std::string_view key, std::string_view value) {
+        j[std::string(key)] = jsonValue(resolveValue(value));
+    }, true);
+    return j.dump(4);
+}
+
+// 🛠️ The same, read at a snapshot
+std::string Database::snapshotContentsAt(uint64_t seq) const {
+    if (snapshotFormat == SnapshotFormat::BINARY) {
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        ScanPins pins;
+        forEachAt(seq, [&](const SnapshotRow& row) { entries.emplace_back(row.key, row.value); }, &pins);
+        parallelSort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+        return BinarySnapshot::serialize(entries);
+    }
+
+    json j = json::object();
+    forEachAt(seq, [&](const SnapshotRow& row) { j[std::string(row.key)] = jsonValue(resolveValue(row.value)); });
+    return j.dump(4);
+}
+
+// 🛠️ Visit every live entry: unmasked snapshot ones first, then in-memory ones shard by
+// shard. Without shardsLocked, a key rewritten mid-scan can be visited twice (the newer
+// value last) but a live key is never skipped.
+void Database::forEachEntry(const std::function<void(std::string_view, std::string_view)>& visit,
+                            bool shardsLocked, std::deque<std::string>* spilledValues) const {
+    if (engine) {
+        engine->scan("", "", [&](std::string_view key, std::string_view value) {
+            visit(key, value);
+            return true;
+        });
+        return;
+    }
+
+    std::shared_ptr<const BinarySnapshot> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards[0]->mutex, std::defer_lock);
+        if (!shardsLocked) lock.lock();
+        snapshot = mappedSnapshot;
+    }
+
+    if (snapshot) {
+        for (size_t i = 0; i < snapshot->size(); i++) {
+            std::string_view key = snapshot->keyAt(i);
+            std::string ownedKey(key);
+            const Shard& shard = shardFor(ownedKey);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex, std::defer_lock);
+            if (!shardsLocked) lock.lock();
+            if (!shard.maskedKeys.empty() && shard.maskedKeys.count(ownedKey)) continue;
+            visit(key, snapshot->valueAt(i));
+        }
+    }
+
+    std::string scratch;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex, std::defer_lock);
+        if (!shardsLocked) lock.lock();
+        for (const auto& [key, slot] : shard->entries) {
+            if (slot.value.valid()) {
+                visit(key, slot.value);
+                continue;
+            }
+            std::string& value = spilledValues ? spilledValues->emplace_back() : scratch;
+            readSlotLocked(slot, value);
+            visit(key, value);
+        }
+    }
+}
+
+// 🛠️ Write into the in-memory layer, shadowing any snapshot copy
+void Database::putLocked(Shard& shard, const InternedString& key, const InternedString& value) {
+    uint64_t seq = ++writeSeq;
+    if (openSnapshots.load(std::memory_order_relaxed)) saveVersionLocked(shard, key, seq, false);
+    auto [it, inserted] = shard.entries.try_emplace(key, value);
+    if (!inserted) {
+        ValueSlot& slot = it->second;
+        if (slot.value.valid()) shard.residentBytes -= slot.value.size();
+        else shard.spilledValues--;
+        if (spill) spill->release(slot.spilled);
+        slot.spilled = SpillRef();
+        slot.value = value;
+        slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    shard.residentBytes += value.size();
+    if (mappedSnapshot && mappedSnapshot->contains(key)) shard.maskedKeys.emplace(key.view());
+    if (overBudgetLocked(shard)) evictLocked(shard, shardBudget(), &it->second);
+}
+
+// 🛠️ Remove from the in-memory layer and hide any snapshot copy
+bool Database::eraseLocked(Shard& shard, std::string_view key) {
+    uint64_t seq = ++writeSeq;
+    if (openSnapshots.load(std::memory_order_relaxed)) saveVersionLocked(shard, key, seq, true);
+    bool erased = false;
+    if (!shard.entries.empty()) {
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            const ValueSlot& slot = it->second;
+            if (slot.value.valid()) shard.residentBytes -= slot.value.size();
+            else shard.spilledValues--;
+            if (spill) spill->release(slot.spilled);
+            shard.entries.erase(it);
+            erased = true;
+        }
+    }
+    if (mappedSnapshot) {
+        std::string ownedKey(key);
+        if (!shard.maskedKeys.count(ownedKey) && mappedSnapshot->contains(key)) {
+            shard.maskedKeys.insert(std::move(ownedKey));
+            erased = true;
+        }
+    }
+    return erased;
+}
+
+// 🛠️ Before write `seq` changes a key, save its current value (or its absence) for the
+// open snapshots. Only snapshots taken since the chain's last version can read the new
+// one, so a key gets at most one version per snapshot.
+void Database::saveVersionLocked(Shard& shard, std::string_view key, uint64_t seq, bool skipIfAbsent) {
+    InternedString internedKey = StringPool::instance().find(key);
+    auto chain = internedKey.valid() ? shard.versions.find(internedKey) : shard.versions.end();
+    if (chain != shard.versions.end() && newestSnapshot.load() < chain->second.back().seq) return;
+
+    InternedString previous;
+    if (const ValueSlot* slot = findSlotLocked(shard, key)) {
+        if (slot->value.valid()) {
+            previous = slot->value;
+        } else {
+            std::string spilled;
+            readSlotLocked(*slot, spilled);
+            previous = InternedString(spilled);
+        }
+    } else {
+        std::string_view mapped;
+        if (mappedSnapshot && !shard.maskedKeys.count(std::string(key)) && mappedSnapshot->find(key, mapped)) {
+            previous = InternedString(mapped);
+        }
+    }
+    if (!previous.valid() && skipIfAbsent) return;  // Removing a missing key changes nothing
+
+    if (chain == shard.versions.end()) {
+        chain = shard.versions.try_emplace(internedKey.valid() ? internedKey : InternedString(key)).first;
+    }
+    chain->second.push_back({seq, std::move(previous)});
+    savedVersions.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 🛠️ The version a snapshot at `seq` reads instead of the current value: the first one
+// saved by a later write. Null means the current value is the one to read.
+const Database::Version* Database::versionAtLocked(const Shard& shard, const InternedString& key,
+                                                   uint64_t seq) const {
+    auto chain = shard.versions.find(key);
+    if (chain == shard.versions.end()) return nullptr;
+    for (const Version& version : chain->second) {
+        if (version.seq > seq) return &version;
+    }
+    return nullptr;
+}
+
+const Database::Version* Database::versionAtLocked(const Shard& shard, std::string_view key,
+                                                   uint64_t seq) const {
+    if (shard.versions.empty()) return nullptr;
+    InternedString internedKey = StringPool::instance().find(key);
+    return internedKey.valid() ? versionAtLocked(shard, internedKey, seq) : nullptr;
+}
+
+// 🛠️ Open a snapshot at the latest write. With every shard read-locked no write is
+// half-applied, and each later write sees the snapshot once it takes its shard lock.
+uint64_t Database::registerSnapshotLocked() const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    uint64_t seq = writeSeq.load();
+    liveSnapshots.insert(seq);
+    newestSnapshot = *liveSnapshots.rbegin();
+    openSnapshots = liveSnapshots.size();
+    return seq;
+}
+
+Database::ReadSnapshot Database::openSnapshot() const {
+    if (engine) return ReadSnapshot(this, writeSeq.load());  // Reads go to the engine
+    auto locks = lockAllShardsShared();
+    return ReadSnapshot(this, registerSnapshotLocked());
+}
+
+// 🛠️ Close a snapshot and drop the versions no remaining snapshot can read: version i
+// of a chain serves the snapshots in [seq of version i-1, seq of version i). Shards are
+// locked one at a time.
+void Database::releaseSnapshot(uint64_t seq) const {
+    std::vector<uint64_t> live;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        auto it = liveSnapshots.find(seq);
+        if (it == liveSnapshots.end()) return;  // Engine snapshots aren't registered
+        liveSnapshots.erase(it);
+        newestSnapshot = liveSnapshots.empty() ? 0 : *liveSnapshots.rbegin();
+        openSnapshots = liveSnapshots.size();
+        live.assign(liveSnapshots.begin(), liveSnapshots.end());
+    }
+    if (!savedVersions.load()) return;
+
+    for (const auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        size_t dropped = 0;
+        for (auto chain = shard->versions.begin(); chain != shard->versions.end();) {
+            auto& versions = chain->second;
+            uint64_t from = 0;
+            size_t kept = 0;
+            for (auto& version : versions) {
+                auto reader = std::lower_bound(live.begin(), live.end(), from);
+                from = version.seq;
+                if (reader != live.end() && *reader < version.seq) versions[kept++] = std::move(version);
+            }
+            dropped += versions.size() - kept;
+            versions.resize(kept);
+            chain = versions.empty() ? shard->versions.erase(chain) : std::next(chain);
+        }
+        savedVersions.fetch_sub(dropped, std::memory_order_relaxed);
+    }
+}
+
+// 🛠️ Scan at a snapshot. Every key is visited once: unmasked rows of the mapped snapshot
+// in the first pass; then, shard by shard, the in-memory entries and the keys only
+// the version chains still know. A key whose version says it didn't exist is skipped.
+void Database::forEachAt(uint64_t seq, const std::function<void(const SnapshotRow&)>& visit,
+                         ScanPins* pins) const {
+    if (engine) {
+        engine->scan("", "", [&](std::string_view key, std::string_view value) {
+            visit({key, value, nullptr, nullptr});
+            return true;
+        });
+        return;
+    }
+
+    std::shared_lock<std::shared_mutex> resetLock(resetMutex);
+    ScanPins local;
+    ScanPins& keep = pins ? *pins : local;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards[0]->mutex);
+        keep.mapping = mappedSnapshot;
+    }
+    const BinarySnapshot* mapping = keep.mapping.get();
+
+    for (size_t i = 0; mapping && i < mapping->size(); i++) {
+        SnapshotRow row{mapping->keyAt(i), mapping->valueAt(i), nullptr, nullptr};
+        {
+            const Shard& shard = shardFor(row.key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (!shard.maskedKeys.empty() && shard.maskedKeys.count(std::string(row.key))) continue;
+            if (const Version* version = versionAtLocked(shard, row.key, seq)) {
+                if (!version->value.valid()) continue;
+                row.valueHandle = &keep.handles.emplace_back(version->value);
+                row.value = *row.valueHandle;
+            }
+        }
+        visit(row);
+        if (!pins) local.handles.clear();
+    }
+
+    std::vector<SnapshotRow> rows;
+    for (const auto& shard : shards) {
+        rows.clear();
+        {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            for (const auto& [key, slot] : shard->entries) {
+                const Version* version = shard->versions.empty() ? nullptr : versionAtLocked(*shard, key, seq);
+                if (version && !version->value.valid()) continue;
+                const InternedString* keyHandle = &keep.handles.emplace_back(key);
+                if (version || slot.value.valid()) {
+                    const InternedString* valueHandle = &keep.handles.emplace_back(version ? version->value : slot.value);
+                    rows.push_back({*keyHandle, *valueHandle, keyHandle, valueHandle});
+                } else {
+                    std::string& spilled = keep.buffers.emplace_back();
+                    readSlotLocked(slot, spilled);
+                    rows.push_back({*keyHandle, spilled, keyHandle, nullptr});
+                }
+            }
+            for (const auto& [key, versions] : shard->versions) {
+                // Keys with a current value were covered above
+                if (shard->entries.count(key)) continue;
+                if (mapping && mapping->contains(key) && !shard->maskedKeys.count(key.str())) continue;
+                const Version* version = versionAtLocked(*shard, key, seq);
+                if (!version || !version->value.valid()) continue;
+                const InternedString* keyHandle = &keep.handles.emplace_back(key);
+                const InternedString* valueHandle = &keep.handles.emplace_back(version->value);
+                rows.push_back({*keyHandle, *valueHandle, keyHandle, valueHandle});
+            }
+        }
+        for (const auto& row : rows) visit(row);
+        if (!pins) {
+            local.handles.clear();
+            local.buffers.clear();
+        }
+    }
+}
+
+Database::ReadSnapshot::~ReadSnapshot() {
+    if (db) db->releaseSnapshot(seq);
+}
+
+bool Database::ReadSnapshot::get(const std::string& key, std::string& value) const {
+    TypedValue typed;
+    if (!getTyped(key, typed)) return false;
+    value = typed.toString();
+    return true;
+}
+
+bool Database::ReadSnapshot::getTyped(const std::string& key, TypedValue& value) const {
+    std::string stored;
+    if (db->engine) {
+        if (!db->engine->get(key, stored)) return false;
+    } else {
+        const Shard& shard = db->shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (const Version* version = db->versionAtLocked(shard, std::string_view(key), seq)) {
+            if (!version->value.valid()) return false;
+            stored = version->value.str();
+        } else if (!db->lookupLocked(shard, key, stored)) {
+            return false;
+        }
+    }
+    value = TypedValue::decode(db->resolveValue(stored));
+    return true;
+}
+
+void Database::ReadSnapshot::forEach(
+        const std::function<void(std::string_view key, std::string_view value)>& visit) const {
+    db->forEachAt(seq, [&](const SnapshotRow& row) { visit(row.key, db->resolveValue(row.value)); });
+}
+
+InternedMap Database::ReadSnapshot::entries() const {
+    InternedMap all;
+    db->forEachAt(seq, [&](const SnapshotRow& row) {
+        all.emplace(row.keyHandle ? *row.keyHandle : InternedString(row.key),
+                    row.valueHandle ? *row.valueHandle : InternedString(row.value));
+    });
+    return all;
+}
+
+// 🛠️ Find a key's slot in the in-memory layer
+const Database::ValueSlot* Database::findSlotLocked(const Shard& shard, std::string_view key) const {
+    auto it = shard.entries.find(key);
+    return it != shard.entries.end() ? &it->second : nullptr;
+}
+
+// 🛠️ A slot's value, read back from the spill file if it has been evicted
+bool Database::readSlotLocked(const ValueSlot& slot, std::string& value) const {
+    if (slot.value.valid()) {
+        value.assign(slot.value.view());
+        return true;
+    }
+    return spill && spill->read(slot.spilled, value);
+}
+
+// 🛠️ Point lookup: in-memory layer, then the mapped snapshot
+bool Database::lookupLocked(const Shard& shard, std::string_view key, std::string& value) const {
+    std::string_view found;
+    if (!peekLocked(shard, key, value, found)) return false;
+    if (found.data() != value.data()) value.assign(found.data(), found.size());
+    return true;
+}
+
+// 🛠️ Point lookup that views the value in place: in the pool while it's resident, in
+// the mapping if it comes from the snapshot; only a spilled value is read into `scratch`
+bool Database::peekLocked(const Shard& shard, std::string_view key, std::string& scratch,
+                          std::string_view& value) const {
+    if (const ValueSlot* slot = findSlotLocked(shard, key)) {
+        if (slot->value.valid()) {
+            value = slot->value.view();
+        } else {
+            readSlotLocked(*slot, scratch);
+            value = scratch;
+        }
+        return true;
+    }
+    return mappedSnapshot && !shard.maskedKeys.count(std::string(key)) && mappedSnapshot->find(key, value);
+}
+
+// 🛠️ Replace the snapshot file atomically so a crash never leaves it half-written
+bool Database::writeSnapshot(const std::string& contents) const {
+    std::string tmpFilename = filename + ".tmp";
+    {
+        std::ofstream outFile(tmpFilename, std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cerr << "Error saving database to " << filename << std::endl;
+            return false;
+        }
+        outFile << contents;
+        if (!outFile.flush()) return false;
+    }
+
+    int fd = ::open(tmpFilename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+    // A binary snapshot can hold blob references, so their blobs must be on disk first
+    if (blobs && !blobs->sync()) return false;
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Error saving database to " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 🛠️ Load data from file, replay the write-ahead log tail and build B-Tree indices
+bool Database::load() {
+    // References into a blob file written by an earlier run need that file open to resolve
+    if (!blobs && ::access((filename + ".blobs").c_str(), F_OK) == 0 && !enableBlobStore()) {
+        std::cerr << "Error opening blob file " << filename << ".blobs" << std::endl;
+        return false;
+    }
+    if (engine) {
+        // The engine recovered its state when it was opened; report whether it has any
+        bool any = false;
+        engine->scan("", "", [&](std::string_view, std::string_view) { return !(any = true); });
+        return any;
+    }
+
+    std::ifstream inFile(filename);
+    if (!inFile.is_open() && !wal) return false;
+
+    try {
+        // Binary snapshots are mapped, not parsed: entries are read straight from the file
+        std::shared_ptr<const BinarySnapshot> mapped;
+        json j;
+        if (inFile.is_open()) {
+            if (BinarySnapshot::isBinarySnapshot(filename)) {
+                mapped = BinarySnapshot::open(filename);
+                if (!mapped) return false;
+                for (size_t i = 0; !blobs && i < mapped->size(); i++) {
+                    BlobRef ref;
+                    if (BlobRef::decode(mapped->valueAt(i), ref)) return missingBlobFile();
+                }
+            } else {
+                inFile >> j;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> resetLock(resetMutex);
+        auto locks = lockAllShards();
+        clearShardsLocked();
+        if (mapped && openSnapshots.load(std::memory_order_relaxed)) {
+            // Open snapshots must not see the mapped keys appear
+            uint64_t seq = ++writeSeq;
+            for (size_t i = 0; i < mapped->size(); i++) {
+                std::string_view key = mapped->keyAt(i);
+                saveVersionLocked(shardFor(key), key, seq, false);
+            }
+        }
+        mappedSnapshot = std::move(mapped);
+        if (mappedSnapshot) snapshotFormat = SnapshotFormat::BINARY;
+
+        for (auto& [key, value] : j.items()) {
+            putLocked(shardFor(key), InternedString(key), InternedString(placeValue(storedValue(value))));
+        }
+
+        size_t replayed = 0;
+        bool danglingRef = false;
+        if (wal) {
+            replayed = wal->replay([&](const WALRecord& record) {
+                Shard& shard = shardFor(record.key);
+                BlobRef ref;
+                if (!blobs && BlobRef::decode(record.value, ref)) danglingRef = true;
+                if (record.op == WALOp::INSERT) {
+                    putLocked(shard, InternedString(record.key), InternedString(record.value));
+                } else if (record.op == WALOp::REMOVE) {
+                    eraseLocked(shard, record.key);
+                }
+            });
+            if (danglingRef) return missingBlobFile();
+            walReplayed = true;
+        }
+
+        std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+        buildBTreeIndices();  // Build B-Tree indices on load
+        valueKeys.clear();    // Value indexes are rebuilt on first use
+        numericIndex.clear();
+        statistics.clear();
+        valueIndex.clear();
+        valueIndexReady = false;
+
+        for (auto& [_, index] : indices) {
+            buildSecondaryIndex(index);
+        }
+
+        return inFile.is_open() || replayed > 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading database: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool Database::missingBlobFile() const {
+    std::cerr << "Error loading database: values refer to blob file " << filename
+              << ".blobs, which is missing" << std::endl;
+    return false;
+}
+
+// 🛠️ Save data to file (in WAL mode this is a checkpoint)
+bool Database::save() {
+    if (engine) return engine->sync();
+    if (wal) return checkpoint();
+
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+    ReadSnapshot view = openSnapshot();
+    return writeSnapshot(snapshotContentsAt(view.sequence()));
+}
+
+// 🛠️ Insert key-value pair (the value is a STRING)
+void Database::insert(const std::string& key, const std::string& value) {
+    if (TypedValue::isPlain(value)) insertStored(key, value);
+    else insertStored(key, TypedValue::encodeString(value));
+}
+
+// 🛠️ Insert a typed value
+void Database::insertTyped(const std::string& key, const TypedValue& value) {
+    insertStored(key, value.encode());
+}
+
+// 🛠️ Insert an encoded value and update B-Trees
+void Database::insertStored(const std::string& key, const std::string& stored) {
+    std::string value = placeValue(stored);
+    if (engine) {
+        engine->put(key, value);
+        return;
+    }
+
+    uint64_t lsn = 0;
+    Shard& shard = shardFor(key);
+    InternedString internedKey(key);
+    InternedString internedValue(value);
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // Only the shared index structures need indexMutex; everything else is this shard's
+        PreparedWrite write = prepareWriteLocked(shard, internedKey, internedValue);
+        putLocked(shard, internedKey, internedValue);
+        {
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            applyWriteLocked(write);
+            keyIndex.insert(internedKey);
+            if (valueIndexReady) valueIndex.insert(shownValue(internedValue));
+        }
+        if (wal) lsn = wal->enqueue({WALOp::INSERT, key, value});
+    }
+    // Wait for the group commit outside the lock so concurrent writers share an fsync
+    if (wal) wal->waitDurable(lsn);
+}
+
+// 🛠️ Get value by key, shown as text ("" if the key is missing)
+std::string Database::get(const std::string& key) const {
+    std::string value;
+    getStored(key, value);
+    if (!TypedValue::isPlain(value)) value = TypedValue::display(resolveValue(value));
+    return value;
+}
+
+// 🛠️ Get value by key with its type
+bool Database::getTyped(const std::string& key, TypedValue& value) const {
+    std::string stored;
+    if (!getStored(key, stored)) return false;
+    value = TypedValue::decode(resolveValue(stored));
+    return true;
+}
+
+// 🛠️ Value by key as get() shows it, viewed in place when it lives in the blob file
+bool Database::getView(const std::string& key, std::string_view& value, std::string& scratch) const {
+    if (!getStored(key, scratch)) return false;
+    std::string_view stored = resolveValue(scratch);
+    if (stored.data() != scratch.data() && shownInPlace(stored, value)) return true;
+    if (!TypedValue::isPlain(stored)) scratch = TypedValue::display(stored);
+    value = scratch;
+    return true;
+}
+
+// 🛠️ Where in the blob file the value of `key`, as get() shows it, lies (false if the
+// value is inline)
+bool Database::locateBlob(const std::string& key, uint64_t& offset, uint64_t& length) const {
+    std::string stored;
+    BlobRef ref;
+    std::string_view shown;
+    if (!blobs || !getStored(key, stored) || !BlobRef::decode(stored, ref)) return false;
+    std::string_view bytes = blobs->view(ref);
+    if (bytes.empty() || !shownInPlace(bytes, shown)) return false;
+    offset = ref.offset + (shown.data() - bytes.data());
+    length = shown.size();
+    return true;
+}
+
+// 🛠️ Encoded value by key (only this key's shard is locked, and only for reading).
+// A spilled value is read under the shared lock, then faulted back in exclusively.
+bool Database::getStored(const std::string& key, std::string& value) const {
+    if (engine) return engine->get(key, value);
+
+    Shard& shard = shardFor(key);
+    SpillRef cold;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const ValueSlot* slot = findSlotLocked(shard, key);
+        if (!slot) return lookupLocked(shard, key, value);
+        if (slot->value.valid()) {
+            value.assign(slot->value.view());
+            if (memoryBudget) {
+                slot->referenced.store(true, std::memory_order_relaxed);
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        readSlotLocked(*slot, value);
+        cold = slot->spilled;
+    }
+
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    // Skip the fault-in if a writer or another reader got there first
+    if (it == shard.entries.end() || it->second.value.valid() || it->second.spilled.offset != cold.offset) {
+        return true;
+    }
+    ValueSlot& slot = it->second;
+    slot.value = InternedString(value);
+    slot.referenced.store(true, std::memory_order_relaxed);
+    shard.residentBytes += value.size();
+    shard.spilledValues--;
+    if (overBudgetLocked(shard)) evictLocked(shard, shardBudget());
+    return true;
+}
+
+// 🛠️ Remove key-value pair and update B-Trees
+bool Database::remove(const std::string& key) {
+    if (engine) {
+        std::string previous;
+        return engine->get(key, previous) && engine->remove(key);
+    }
+
+    uint64_t lsn = 0;
+    Shard& shard = shardFor(key);
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        std::string previous;
+        if (!lookupLocked(shard, key, previous)) return false;
+        eraseLocked(shard, key);
+        // Every index holds its keys interned, so an uninterned key is in none of them
+        InternedString internedKey = StringPool::instance().find(key);
+        {
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            keyIndex.remove(std::string_view(key));
+            unlinkValueLocked(key, internedKey, previous);
+            if (internedKey.valid()) removeFromIndices(internedKey);
+        }
+        if (wal) lsn = wal->enqueue({WALOp::REMOVE, key, ""});
+    }
+    if (wal) wal->waitDurable(lsn);
+    return true;
+}
+
+// 🛠️ Build the key B-Tree by bulk loading sorted keys
+// (caller holds every shard lock and indexMutex)
+void Database::buildBTreeIndices() {
+    std::vector<InternedString> keys;
+    for (const auto& shard : shards) {
+        for (const auto& [key, _] : shard->entries) keys.push_back(key);
+    }
+    parallelSort(keys.begin(), keys.end());
+    keyIndex = BTree<InternedString>(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+}
+
+// 🛠️ Bulk load the value B-Tree. It holds every value it indexes, so it is only built
+// on demand: under a memory budget it would otherwise pin every spilled value.
+void Database::buildValueIndexLocked() const {
+    std::vector<InternedString> values;
+    std::string scratch;
+    for (const auto& shard : shards) {
+        for (const auto& [_, slot] : shard->entries) {
+            if (slot.value.valid()) {
+                values.push_back(shownValue(slot.value));
+            } else if (readSlotLocked(slot, scratch)) {
+                values.emplace_back(TypedValue::display(resolveValue(scratch)));
+            }
+        }
+    }
+    parallelSort(values.begin(), values.end());
+    valueIndex = BTree<InternedString>(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+    valueIndexReady = true;
+}
+
+// 🛠️ Query by Prefix Using B-Tree
+std::vector<std::string> Database::queryByPrefixBTree(const std::string& prefix) const {
+    if (engine) return queryByPrefix(prefix);
+
+    std::vector<std::string> results;
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        for (const auto& key : keyIndex.rangeSearch(prefix)) results.push_back(key.str());
+    }
+
+    std::shared_ptr<const BinarySnapshot> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards[0]->mutex);
+        snapshot = mappedSnapshot;
+    }
+    if (snapshot) {
+        // Snapshot keys are sorted, so the prefix is one contiguous run
+        for (size_t i = snapshot->lowerBound(prefix); i < snapshot->size(); i++) {
+            std::string_view key = snapshot->keyAt(i);
+            if (key.compare(0, prefix.size(), prefix) != 0) break;
+            std::string ownedKey(key);
+            const Shard& shard = shardFor(ownedKey);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (!shard.maskedKeys.count(ownedKey)) results.push_back(std::move(ownedKey));
+        }
+    }
+    return results;
+}
+
+// 🛠️ Values starting with `value`, as get() shows them, through the value B-Tree
+std::vector<std::string> Database::queryByValueBTree(const std::string& value) const {
+    std::vector<std::string> results;
+    if (engine) {
+        forEachEntry([&](std::string_view, std::string_view val) {
+            std::string shown = TypedValue::display(resolveValue(val));
+            if (shown.compare(0, value.size(), value) == 0) results.push_back(std::move(shown));
+        });
+        std::sort(results.begin(), results.end());
+        results.erase(std::unique(results.begin(), results.end()), results.end());
+        return results;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (!valueIndexReady) {
+            // First lookup: build the index once, holding writers off while we do
+            indexLock.unlock();
+            {
+                auto locks = lockAllShardsShared();
+                std::unique_lock<std::shared_mutex> buildLock(indexMutex);
+                if (!valueIndexReady) buildValueIndexLocked();
+            }
+            indexLock.lock();
+        }
+        for (const auto& match : valueIndex.rangeSearch(value)) results.push_back(match.str());
+    }
+
+    std::shared_ptr<const BinarySnapshot> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards[0]->mutex);
+        snapshot = mappedSnapshot;
+    }
+    if (snapshot) {
+        for (size_t i = 0; i < snapshot->size(); i++) {
+            std::string shown = TypedValue::display(resolveValue(snapshot->valueAt(i)));
+            if (shown.compare(0, value.size(), value) != 0) continue;
+            std::string ownedKey(snapshot->keyAt(i));
+            const Shard& shard = shardFor(ownedKey);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (!shard.maskedKeys.count(ownedKey)) results.push_back(std::move(shown));
+        }
+    }
+    return results;
+}
+
+// 🛠️ Get all data, read at a snapshot so writers aren't held up
+std::unordered_map<std::string, std::string> Database::getAllData() const {
+    std::unordered_map<std::string, std::string> all;
+    openSnapshot().forEach([&](std::string_view key, std::string_view value) {
+        all.emplace(key, TypedValue::display(value));
+    });
+    return all;
+}
+
+// 🛠️ Keys whose entry matches the predicate (values shown as by get()), read at a snapshot
+std::vector<std::string> Database::query(
+    const std::function<bool(const std::string&, const std::string&)>& predicate) const {
+    std::vector<std::string> results;
+    std::string key;
+    openSnapshot().forEach([&](std::string_view stored, std::string_view value) {
+        key.assign(stored);
+        if (predicate(key, TypedValue::display(value))) results.push_back(key);
+    });
+    return results;
+}
+
+CursorOptions CursorOptions::all(CursorOrder order) {
+    CursorOptions options;
+    options.order = order;
+    return options;
+}
+
+CursorOptions CursorOptions::range(const std::string& lo, const std::string& hi, bool reverse) {
+    CursorOptions options;
+    options.lo = lo;
+    options.hi = hi;
+    options.reverse = reverse;
+    return options;
+}
+
+CursorOptions CursorOptions::prefix(const std::string& prefix, bool reverse) {
+    return range(prefix, prefixSuccessor(prefix), reverse);
+}
+
+Database::Cursor Database::openCursor(const CursorOptions& options) const {
+    return Cursor(*this, options);
+}
+
+// 🛠️ Pin the view and position on the first entry. Every shard is read-locked before
+// anything is read, so keyIndex, the shard tables and the mapped snapshot can't move.
+Database::Cursor::Cursor(const Database& db, CursorOptions options)
+    : db(&db), options(std::move(options)),
+      memIt(db.keyIndex.end()), memFirst(db.keyIndex.end()), memLast(db.keyIndex.end()) {
+    const CursorOptions& opts = this->options;
+    bool bounded = !opts.hi.empty();
+    if (bounded && opts.hi <= opts.lo) return;
+    if (db.engine) {
+        refill();
+        return;
+    }
+
+    locks = db.lockAllShardsShared();
+    snapshot = db.mappedSnapshot;
+    if (snapshot) {
+        snapFirst = snapshot->lowerBound(opts.lo);
+        snapLast = bounded ? snapshot->lowerBound(opts.hi) : snapshot->size();
+    }
+    if (opts.order == CursorOrder::KEY) {
+        memFirst = db.keyIndex.lowerBound(std::string_view(opts.lo));
+        memLast = bounded ? db.keyIndex.lowerBound(std::string_view(opts.hi)) : db.keyIndex.end();
+        memIt = opts.reverse ? memLast : memFirst;
+        snapIt = opts.reverse ? snapLast : snapFirst;
+    } else {
+        snapIt = snapFirst;
+        entryIt = db.shards[0]->entries.begin();
+    }
+    settle();
+}
+
+bool Database::Cursor::inBounds(std::string_view key) const {
+    return key >= options.lo && (options.hi.empty() || key < options.hi);
+}
+
+bool Database::Cursor::visibleInSnapshot(size_t i) const {
+    std::string_view key = snapshot->keyAt(i);
+    const Shard& shard = db->shardFor(key);
+    return shard.maskedKeys.empty() || !shard.maskedKeys.count(std::string(key));
+}
+
+void Database::Cursor::setSlot(Source from, const InternedString& key, const ValueSlot& slot) {
+    source = from;
+    currentKey = key.view();
+    currentKeyHandle = &key;
+    if (slot.value.valid()) {
+        currentValue = slot.value.view();
+        currentValueHandle = &slot.value;
+    } else {
+        db->readSlotLocked(slot, scratch);
+        currentValue = scratch;
+        currentValueHandle = nullptr;
+    }
+}
+
+// 🛠️ Make the next entry current. KEY order takes the smaller (in reverse, larger) of
+// the two run heads; a snapshot key that is masked lives in memory or nowhere, so the
+// runs never hold the same key.
+void Database::Cursor::settle() {
+    source = Source::NONE;
+    if (db->engine) {
+        if (bufferedPos < buffered.size()) {
+            source = Source::ENGINE;
+            currentKey = buffered[bufferedPos].first;
+            currentValue = buffered[bufferedPos].second;
+            currentKeyHandle = currentValueHandle = nullptr;
+        }
+        return;
+    }
+
+    currentKeyHandle = currentValueHandle = nullptr;
+    if (options.order == CursorOrder::HASH) {
+        for (; snapIt < snapLast; snapIt++) {
+            if (visibleInSnapshot(snapIt)) {
+                source = Source::SNAPSHOT;
+                currentKey = snapshot->keyAt(snapIt);
+                currentValue = snapshot->valueAt(snapIt);
+                return;
+            }
+        }
+        while (shardIndex < db->shards.size()) {
+            const auto& entries = db->shards[shardIndex]->entries;
+            for (; entryIt != entries.end(); ++entryIt) {
+                if (inBounds(entryIt->first)) {
+                    setSlot(Source::SHARD, entryIt->first, entryIt->second);
+                    return;
+                }
+            }
+            if (++shardIndex < db->shards.size()) entryIt = db->shards[shardIndex]->entries.begin();
+        }
+        return;
+    }
+
+    bool memory, mapped;
+    auto memHead = memIt;
+    size_t snapHead = snapIt;
+    if (options.reverse) {
+        while (snapIt > snapFirst && !visibleInSnapshot(snapIt - 1)) snapIt--;
+        memory = memIt != memFirst;
+        mapped = snapIt > snapFirst;
+        if (memory) --memHead;
+        if (mapped) snapHead = snapIt - 1;
+    } else {
+        while (snapIt < snapLast && !visibleInSnapshot(snapIt)) snapIt++;
+        memory = memIt != memLast;
+        mapped = snapIt < snapLast;
+        snapHead = snapIt;
+    }
+    if (memory && mapped) {
+        bool memoryFirst = (memHead->view() < snapshot->keyAt(snapHead)) != options.reverse;
+        memory = memoryFirst;
+        mapped = !memoryFirst;
+    }
+    if (memory) {
+        const InternedString& key = *memHead;
+        const Shard& shard = db->shardFor(key);
+        setSlot(Source::MEMORY, key, shard.entries.find(key)->second);
+    } else if (mapped) {
+        source = Source::SNAPSHOT;
+        currentKey = snapshot->keyAt(snapHead);
+        currentValue = snapshot->valueAt(snapHead);
+    }
+}
+
+// 🛠️ Advance past the current entry
+void Database::Cursor::next() {
+    switch (source) {
+        case Source::NONE:
+            return;
+        case Source::ENGINE:
+            if (++bufferedPos == buffered.size() && !engineDone) refill();
+            break;
+        case Source::MEMORY:
+            if (options.reverse) --memIt;
+            else ++memIt;
+            break;
+        case Source::SNAPSHOT:
+            if (options.order == CursorOrder::KEY && options.reverse) snapIt--;
+            else snapIt++;
+            break;
+        case Source::SHARD:
+            ++entryIt;
+            break;
+    }
+    settle();
+}
+
+// 🛠️ Fetch the next batch from the storage engine, resuming just past the last key.
+// The engine only scans forward, so a reverse cursor buffers its whole range at once.
+void Database::Cursor::refill() {
+    std::string from = buffered.empty() ? options.lo : buffered.back().first + '\0';
+    retired = std::move(buffered);
+    buffered.clear();
+    bufferedPos = 0;
+    refills++;
+
+    size_t limit = options.reverse ? std::numeric_limits<size_t>::max() : std::max<size_t>(options.batchSize, 1);
+    db->engine->scan(from, options.hi, [&](std::string_view key, std::string_view value) {
+        buffered.emplace_back(key, value);
+        return buffered.size() < limit;
+    });
+    engineDone = buffered.size() < limit;
+    if (options.reverse) std::reverse(buffered.begin(), buffered.end());
+    settle();
+}
+
+InternedString Database::Cursor::keyHandle() const {
+    return currentKeyHandle ? *currentKeyHandle : InternedString(currentKey);
+}
+
+InternedString Database::Cursor::valueHandle() const {
+    return currentValueHandle ? *currentValueHandle : InternedString(currentValue);
+}
+
+// 🛠️ Hand out entries in bulk. A value read back from the spill file is kept in
+// batchValues, and the batch stops after a refill so the engine's previous batch
+// (which its views point into) is still there.
+size_t Database::Cursor::nextBatch(std::vector<std::pair<std::string_view, std::string_view>>& batch,
+                                   size_t max) {
+    batch.clear();
+    batchValues.clear();
+    size_t startRefills = refills;
+    while (valid() && batch.size() < max) {
+        std::string_view value = currentValue;
+        if (!value.empty() && value.data() == scratch.data()) value = batchValues.emplace_back(scratch);
+        batch.emplace_back(currentKey, db->resolveValue(value));
+        next();
+        if (refills != startRefills) break;
+    }
+    return batch.size();
+}
+
+// 🛠️ Point a key at its new indexed value, unlinking the old one
+void SecondaryIndex::put(const InternedString& key, const InternedString& indexed) {
+    auto it = reverse.find(key);
+    if (it != reverse.end()) {
+        if (it->second == indexed) return;
+        auto posting = postings.find(it->second);
+        if (posting != postings.end()) {
+            posting->second.erase(key);
+            if (posting->second.empty()) postings.erase(posting);
+        }
+        it->second = indexed;
+    } else {
+        reverse.emplace(key, indexed);
+    }
+    postings[indexed].insert(key);
+}
+
+// 🛠️ Drop a key from the index
+void SecondaryIndex::erase(const InternedString& key) {
+    auto it = reverse.find(key);
+    if (it == reverse.end()) return;
+    auto posting = postings.find(it->second);
+    if (posting != postings.end()) {
+        posting->second.erase(key);
+        if (posting->second.empty()) postings.erase(posting);
+    }
+    reverse.erase(it);
+}
+
+// 🛠️ Check whether an index exists (caller holds indexMutex)
+bool Database::indexExists(const std::string& indexName) const {
+    return indices.count(indexName) > 0;
+}
+
+// 🛠️ Gather what a write's index updates need: the value it replaces and its
+// secondary index keys. Holding any shard lock keeps `indices` and the lazy indexes'
+// ready flags from changing, since they only change with every shard locked.
+Database::PreparedWrite Database::prepareWriteLocked(const Shard& shard, const InternedString& key,
+                                                     const InternedString& value) const {
+    PreparedWrite write{key, value, false, {}, {}};
+    if (valueKeys.ready || numericIndex.ready || statistics.ready) {
+        std::string scratch;
+        std::string_view previous;
+        const ValueSlot* slot = findSlotLocked(shard, key);
+        if (slot && slot->value.valid()) {
+            write.replaced = true;
+            write.previous = slot->value;
+        } else if (peekLocked(shard, key, scratch, previous)) {
+            write.replaced = true;
+            write.previous = InternedString(previous);
+        }
+    }
+    if (!indices.empty()) {
+        std::string shown = TypedValue::display(resolveValue(value));  // Indexers see values as get() shows them
+        write.indexed.reserve(indices.size());
+        for (const auto& [_, index] : indices) write.indexed.emplace_back(index.indexer(shown));
+    }
+    return write;
+}
+
+// 🛠️ Move a prepared write's key from its old value to its new one in every index
+// keyed by value (caller holds indexMutex)
+void Database::applyWriteLocked(const PreparedWrite& write) {
+    if (write.replaced) unlinkValueLocked(write.key.view(), write.key, write.previous.view());
+    if (valueKeys.ready) valueKeys.link(write.key, write.value);
+    if (numericIndex.ready) numericIndex.link(write.key, write.value);
+    if (statistics.ready) statistics.add(write.key.view(), write.value.view());
+    size_t i = 0;
+    for (auto& [_, index] : indices) index.put(write.key, write.indexed[i++]);
+}
+
+// 🛠️ Remove from indices (caller holds indexMutex)
+void Database::removeFromIndices(const InternedString& key) {
+    for (auto& [_, index] : indices) {
+        index.erase(key);
+    }
+}
+
+// 🛠️ Remove a whole batch from indices (caller holds indexMutex)
+void Database::removeFromIndicesBatch(const std::vector<InternedString>& keys) {
+    for (auto& [_, index] : indices) {
+        for (const auto& key : keys) {
+            index.erase(key);
+        }
+    }
+}
+
+// 🛠️ Populate an index from scratch: the indexer runs on every core, one slice of
+// the shards and mapped snapshot per thread, then the slices are merged
+void Database::buildSecondaryIndex(SecondaryIndex& index) const {
+    index.postings.clear();
+    index.reverse.clear();
+
+    size_t snapshotSize = mappedSnapshot ? mappedSnapshot->size() : 0;
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<std::pair<InternedString, std::string>>> slices(workers);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < workers; t++) {
+        threads.emplace_back([&, t] {
+            auto& slice = slices[t];
+            for (size_t i = t; i < shards.size(); i += workers) {
+                std::string value;
+                for (const auto& [key, slot] : shards[i]->entries) {
+                    readSlotLocked(slot, value);
+                    slice.emplace_back(key, index.indexer(TypedValue::display(resolveValue(value))));
+                }
+            }
+            size_t begin = snapshotSize * t / workers;
+            size_t end = snapshotSize * (t + 1) / workers;
+            for (size_t i = begin; i < end; i++) {
+                std::string key(mappedSnapshot->keyAt(i));
+                const Shard& shard = shardFor(key);
+                if (shard.maskedKeys.count(key)) continue;
+                slice.emplace_back(InternedString(key),
+                                   index.indexer(TypedValue::display(resolveValue(mappedSnapshot->valueAt(i)))));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    size_t total = 0;
+    for (const auto& slice : slices) total += slice.size();
+    index.reverse.reserve(total);
+    for (auto& slice : slices) {
+        for (auto& [key, indexed] : slice) {
+            InternedString internedIndexed(indexed);
+            index.postings[internedIndexed].insert(key);
+            index.reverse.emplace(std::move(key), std::move(internedIndexed));
+        }
+        slice.clear();
+    }
+}
+
+// 🛠️ Create a secondary index over the current data
+bool Database::createIndex(const std::string& indexName,
+                           const std::function<std::string(const std::string&)>& indexer) {
+    if (engine) return false;  // Secondary indexes are maintained by the in-memory shards only
+
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (indexExists(indexName)) return false;
+    }
+
+    // Shared shard locks hold writers off while the index is built; readers carry on
+    auto locks = lockAllShardsShared();
+    SecondaryIndex index;
+    index.indexer = indexer;
+    buildSecondaryIndex(index);
+
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+    return indices.emplace(indexName, std::move(index)).second;
+}
+
+// 🛠️ Query a secondary index: one hash lookup
+std::vector<std::string> Database::queryByIndex(const std::string& indexName, const std::string& value) const {
+    std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+    auto index = indices.find(indexName);
+    if (index == indices.end()) return {};
+    InternedString internedValue = StringPool::instance().find(value);
+    if (!internedValue.valid()) return {};
+    auto posting = index->second.postings.find(internedValue);
+    if (posting == index->second.postings.end()) return {};
+    std::vector<std::string> results;
+    for (const auto& key : posting->second) results.push_back(key.str());
+    return results;
+}
+
+// 🛠️ Batch insert: sort once, lock each touched shard once, log one record
+bool Database::batchInsert(const std::unordered_map<std::string, std::string>& entries) {
+    std::vector<std::pair<InternedString, InternedString>> batch;
+    batch.reserve(entries.size());
+    for (const auto& [key, value] : entries) {
+        batch.emplace_back(InternedString(key), InternedString(value));
+    }
+    return applyBatchInsert(batch);
+}
+
+// 🛠️ Batch insert from handles that already share the pool (e.g. a commit snapshot)
+bool Database::batchInsert(const InternedMap& entries) {
+    std::vector<std::pair<InternedString, InternedString>> batch(entries.begin(), entries.end());
+    return applyBatchInsert(batch);
+}
+
+bool Database::applyBatchInsert(std::vector<std::pair<InternedString, InternedString>>& batch) {
+    if (batch.empty()) return true;
+    if (blobs) {
+        for (auto& [_, value] : batch) value = placeValue(value);
+    }
+    if (engine) {
+        std::vector<std::pair<std::string_view, std::string_view>> entries(batch.begin(), batch.end());
+        return engine->putBatch(entries);
+    }
+
+    std::sort(batch.begin(), batch.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<bool> touched(shards.size(), false);
+    for (const auto& [key, _] : batch) touched[shardIndexFor(key)] = true;
+
+    uint64_t lsn = 0;
+    {
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (touched[i]) locks.emplace_back(shards[i]->mutex);
+        }
+
+        std::vector<PreparedWrite> writes;
+        writes.reserve(batch.size());
+        for (const auto& [key, value] : batch) {
+            Shard& shard = shardFor(key);
+            writes.push_back(prepareWriteLocked(shard, key, value));
+            putLocked(shard, key, value);
+        }
+
+        {
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            for (const auto& write : writes) applyWriteLocked(write);
+            // The batch is sorted, so a large one is merged into the B-Trees in one pass
+            std::vector<InternedString> keys;
+            keys.reserve(batch.size());
+            for (const auto& [key, _] : batch) keys.push_back(key);
+            keyIndex.insertSorted(keys.begin(), keys.end());
+            if (valueIndexReady) {
+                std::vector<InternedString> values;
+                values.reserve(batch.size());
+                for (const auto& [_, value] : batch) values.push_back(shownValue(value));
+                std::sort(values.begin(), values.end());
+                valueIndex.insertSorted(values.begin(), values.end());
+            }
+        }
+
+        if (wal) {
+            std::vector<std::pair<std::string_view, std::string_view>> record;
+            record.reserve(batch.size());
+            for (const auto& [key, value] : batch) record.emplace_back(key, value);
+            lsn = wal->enqueue(WriteAheadLog::batchInsertRecord(record));
+        }
+    }
+    if (wal) return wal->waitDurable(lsn);
+    return true;
+}
+
+// 🛠️ Batch remove: returns true if at least one key was removed
+bool Database::batchRemove(const std::vector<std::string>& keys) {
+    if (keys.empty()) return false;
+
+    std::vector<std::string_view> sorted(keys.begin(), keys.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    if (engine) {
+        std::vector<std::string_view> present;
+        std::string previous;
+        for (const auto& key : sorted) {
+            if (engine->get(key, previous)) present.push_back(key);
+        }
+        return !present.empty() && engine->removeBatch(present);
+    }
+
+    std::vector<bool> touched(shards.size(), false);
+    for (const auto& key : keys) touched[shardIndexFor(key)] = true;
+
+    uint64_t lsn = 0;
+    {
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (touched[i]) locks.emplace_back(shards[i]->mutex);
+        }
+
+        std::vector<std::string_view> removed;
+        std::vector<std::string> previousValues;
+        removed.reserve(sorted.size());
+        for (const auto& key : sorted) {
+            Shard& shard = shardFor(key);
+            std::string previous;
+            if (!lookupLocked(shard, key, previous)) continue;
+            eraseLocked(shard, key);
+            removed.push_back(key);
+            previousValues.push_back(std::move(previous));
+        }
+        if (removed.empty()) return false;
+
+        {
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            std::vector<InternedString> removedInterned;
+            for (size_t i = 0; i < removed.size(); i++) {
+                keyIndex.remove(removed[i]);
+                InternedString internedKey = StringPool::instance().find(removed[i]);
+                unlinkValueLocked(removed[i], internedKey, previousValues[i]);
+                if (internedKey.valid()) removedInterned.push_back(std::move(internedKey));
+            }
+            removeFromIndicesBatch(removedInterned);
+        }
+
+        if (wal) lsn = wal->enqueue(WriteAheadLog::batchRemoveRecord(removed));
+    }
+    if (wal) wal->waitDurable(lsn);
+    return true;
+}
+
+// 🛠️ Reset database
+void Database::reset(const std::string& newFilename) {
+    if (engine) return;  // The engine's files are the database; there is nothing to reload
+
+    // Hold off checkpoints until the reloaded state is in place
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+    {
+        std::unique_lock<std::shared_mutex> resetLock(resetMutex);
+        auto locks = lockAllShards();
+        if (wal && newFilename != filename) {
+            // The log belongs to the old file; fold it in before switching
+            if (wal->rotate() && writeSnapshot(snapshotContentsLocked())) wal->discardRotated();
+            wal->close();
+            wal = std::make_unique<WriteAheadLog>(newFilename + ".wal", walOptions);
+            wal->open();
+        }
+        filename = newFilename;
+        clearShardsLocked();
+
+        std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+        keyIndex.clear();
+        valueIndex.clear();
+        valueIndexReady = false;
+    }
+    load();
+}
+
+// 🛠️ Print B-Tree indices
+void Database::printKeyIndex() const {
+    std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+    std::cout << "Key B-Tree Index: ";
+    keyIndex.traverse();
+    std::cout << std::endl;
+}
+
+void Database::printValueIndex() const {
+    auto locks = lockAllShardsShared();
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+    if (!valueIndexReady) buildValueIndexLocked();
+    std::cout << "Value B-Tree Index: ";
+    valueIndex.traverse();
+    std::cout << std::endl;
+}
+
+// 🛠️ Inverted value index maintenance (caller holds indexMutex)
+void InvertedValueIndex::link(const InternedString& key, const InternedString& value) {
+    keyCount += postings[value].insert(key).second;
+}
+
+void InvertedValueIndex::unlink(const InternedString& key, std::string_view value) {
+    InternedString internedValue = StringPool::instance().find(value);
+    if (!internedValue.valid()) return;
+    auto posting = postings.find(internedValue);
+    if (posting == postings.end()) return;
+    keyCount -= posting->second.erase(key);
+    if (posting->second.empty()) postings.erase(posting);
+}
+
+std::vector<std::string> InvertedValueIndex::keysFor(std::string_view value) const {
+    InternedString internedValue = StringPool::instance().find(value);
+    if (!internedValue.valid()) return {};
+    auto posting = postings.find(internedValue);
+    if (posting == postings.end()) return {};
+    std::vector<std::string> keys;
+    keys.reserve(posting->second.size());
+    for (const auto& key : posting->second) keys.push_back(key.str());
+    return keys;
+}
+
+void InvertedValueIndex::clear() {
+    postings.clear();
+    keyCount = 0;
+    ready = false;
+}
+
+// 🛠️ Approximate footprint: handles, hash nodes and bucket arrays (the string bytes
+// themselves are shared through the StringPool and reported there). Each posting's
+// bucket array is taken to have about one bucket per key, the default load factor.
+size_t InvertedValueIndex::memoryUsage() const {
+    constexpr size_t nodeOverhead = 2 * sizeof(void*) + sizeof(size_t);  // Next pointer + cached hash
+
+    size_t bytes = sizeof(*this) + postings.bucket_count() * sizeof(void*);
+    bytes += postings.size() * (nodeOverhead + sizeof(InternedString) + sizeof(InternedSet));
+    bytes += keyCount * (nodeOverhead + sizeof(InternedString) + sizeof(void*));
+    return bytes;
+}
+
+// 🛠️ Build the inverted value index from every live entry
+void Database::buildValueKeysLocked() const {
+    valueKeys.clear();
+    forEachEntry([&](std::string_view key, std::string_view value) {
+        valueKeys.link(InternedString(key), InternedString(value));
+    }, true);
+    valueKeys.ready = true;
+}
+
+// 🛠️ Query by exact value: one hash lookup (two for a literal like 42 or true, which
+// matches both the string and the typed value), independent of table size
+std::vector<std::string> Database::queryByValue(const std::string& value) const {
+    // Large values are stored as blob references, so look those up instead
+    std::string asString = probeValue(TypedValue::encodeString(value));
+    TypedValue typed = TypedValue::parse(value);
+    std::string asTyped = typed.getType() == STRING ? std::string() : probeValue(typed.encode());
+
+    if (engine) {
+        std::vector<std::string> keys;
+        forEachEntry([&](std::string_view key, std::string_view val) {
+            if (val == asString || (!asTyped.empty() && val == asTyped)) keys.emplace_back(key);
+        });
+        return keys;
+    }
+
+    auto lookup = [&] {
+        std::vector<std::string> keys = valueKeys.keysFor(asString);
+        if (!asTyped.empty()) {
+            std::vector<std::string> typedKeys = valueKeys.keysFor(asTyped);
+            keys.insert(keys.end(), std::make_move_iterator(typedKeys.begin()),
+                        std::make_move_iterator(typedKeys.end()));
+        }
+        return keys;
+    };
+
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (valueKeys.ready) return lookup();
+    }
+
+    // First lookup: build the index once, holding writers off while we do
+    auto locks = lockAllShardsShared();
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+    if (!valueKeys.ready) buildValueKeysLocked();
+    return lookup();
 }
 
-// 🛠️ Insert an edge
-void Database::insertEdge(const std::string& from, const std::string& to, int weight) {
-    graph[from].insert({to, weight});
-    graph[to].insert({from, weight});  // For undirected graphs
+// 🛠️ Numeric index maintenance (caller holds indexMutex)
+void NumericIndex::link(const InternedString& key, std::string_view stored) {
+    double value;
+    if (!TypedValue::numberOf(stored, value) || std::isnan(value)) return;
+    byValue.insert(ByValue{value, key});
+    byKey.insert(ByKey{key, value});
 }
 
-// 🛠️ BFS traversal
-std::vector<std::string> Database::bfs(const std::string& start) {
-    std::vector<std::string> result;
-    std::queue<std::string> q;
-    std::set<std::string> visited;
+void NumericIndex::unlink(const InternedString& key, std::string_view stored) {
+    double value;
+    if (!TypedValue::numberOf(stored, value) || std::isnan(value)) return;
+    byValue.remove(ByValue{value, key});
+    byKey.remove(ByKey{key, value});
+}
 
-    q.push(start);
-    visited.insert(start);
+void NumericIndex::clear() {
+    byValue.clear();
+    byKey.clear();
+    ready = false;
+}
 
-    while (!q.empty()) {
-        auto node = q.front(); q.pop();
-        result.push_back(node);
-        for (const auto& edge : graph[node]) {
-            if (!visited.count(edge.to)) {
-                visited.insert(edge.to);
-                q.push(edge.to);
-            }
-        }
+size_t NumericIndex::memoryUsage() const {
+    return byValue.memoryUsage() + byKey.memoryUsage();
+}
+
+void NumericSummary::add(double value) {
+    if (count == 0 || value < min) min = value;
+    if (count == 0 || value > max) max = value;
+    sum += value;
+    count++;
+}
+
+// 🛠️ Table statistics maintenance (caller holds indexMutex)
+void TableStatistics::add(std::string_view key, std::string_view value) {
+    entries++;
+    keyBytes += key.size();
+    valueBytes += value.size();
+    values.add(value);
+}
+
+void TableStatistics::remove(std::string_view key, std::string_view value) {
+    entries--;
+    keyBytes -= key.size();
+    valueBytes -= value.size();
+    values.remove(value);
+}
+
+void TableStatistics::clear() {
+    entries = 0;
+    keyBytes = 0;
+    valueBytes = 0;
+    values.clear();
+    ready = false;
+}
+
+// 🛠️ Count every live entry once; writes keep the counts current from then on
+void Database::buildStatisticsLocked() const {
+    statistics.clear();
+    forEachEntry([&](std::string_view key, std::string_view value) {
+        statistics.add(key, value);
+    }, true);
+    statistics.ready = true;
+}
+
+// 🛠️ Take a key's old value out of the lazily built value indexes
+void Database::unlinkValueLocked(std::string_view key, const InternedString& internedKey,
+                                 std::string_view previous) {
+    if (statistics.ready) statistics.remove(key, previous);
+    // Every value index holds its keys interned, so an uninterned key is in none of them
+    if (!internedKey.valid()) return;
+    if (valueKeys.ready) valueKeys.unlink(internedKey, previous);
+    if (numericIndex.ready) numericIndex.unlink(internedKey, previous);
+}
+
+// 🛠️ Bulk load both numeric B+trees from every live numeric entry
+void Database::buildNumericIndexLocked() const {
+    std::vector<NumericIndex::ByValue> byValue;
+    std::vector<NumericIndex::ByKey> byKey;
+    forEachEntry([&](std::string_view key, std::string_view stored) {
+        double value;
+        if (!TypedValue::numberOf(stored, value) || std::isnan(value)) return;
+        InternedString internedKey(key);
+        byValue.push_back({value, internedKey});
+        byKey.push_back({std::move(internedKey), value});
+    }, true);
+    parallelSort(byValue.begin(), byValue.end());
+    parallelSort(byKey.begin(), byKey.end());
+    numericIndex.byValue = BTree<NumericIndex::ByValue>(byValue.begin(), byValue.end());
+    numericIndex.byKey = BTree<NumericIndex::ByKey>(byKey.begin(), byKey.end());
+    numericIndex.ready = true;
+}
+
+// 🛠️ First numeric query: build the index once, holding writers off while we do
+void Database::ensureNumericIndex() const {
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (numericIndex.ready) return;
     }
-    return result;
+    auto locks = lockAllShardsShared();
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+    if (!numericIndex.ready) buildNumericIndexLocked();
 }
 
-// 🛠️ DFS traversal
-std::vector<std::string> Database::dfs(const std::string& start) {
-    std::vector<std::string> result;
-    std::stack<std::string> s;
-    std::set<std::string> visited;
+// 🛠️ Keys whose numeric value lies in [lo, hi], in value order: one descent plus a leaf walk
+std::vector<std::string> Database::queryBetween(double lo, double hi, size_t limit) const {
+    size_t wanted = limit ? limit : std::numeric_limits<size_t>::max();
+    std::vector<std::string> keys;
 
-    s.push(start);
-    while (!s.empty()) {
-        auto node = s.top(); s.pop();
-        if (visited.count(node)) continue;
-        visited.insert(node);
-        result.push_back(node);
-        for (const auto& edge : graph[node]) {
-            s.push(edge.to);
+    if (engine) {
+        std::vector<std::pair<double, std::string>> matches;
+        forEachEntry([&](std::string_view key, std::string_view stored) {
+            double value;
+            if (TypedValue::numberOf(stored, value) && value >= lo && value <= hi) {
+                matches.emplace_back(value, std::string(key));
+            }
+        });
+        std::sort(matches.begin(), matches.end());
+        for (auto& [_, key] : matches) {
+            if (keys.size() == wanted) break;
+            keys.push_back(std::move(key));
         }
+        return keys;
+    }
+
+    while (true) {
+        ensureNumericIndex();
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (!numericIndex.ready) continue;  // clearCache() dropped it in between
+        const auto& index = numericIndex.byValue;
+        for (auto it = index.lowerBound(NumericIndex::ByValue{lo, InternedString()});
+             it != index.end() && it->value <= hi && keys.size() < wanted; ++it) {
+            keys.push_back(it->key.str());
+        }
+        return keys;
     }
-    return result;
 }
 
-// 🛠️ Constructor with B-Tree Initialization
-Database::Database(const std::string& filename) 
-    : filename(filename), keyIndex(3), valueIndex(3) {}
+// 🛠️ count/min/max/sum over the numeric values under a key prefix, read from the
+// key-ordered tree without touching the shards
+NumericSummary Database::summarizeNumeric(const std::string& prefix) const {
+    NumericSummary summary;
+    auto matches = [&](std::string_view key) { return key.compare(0, prefix.size(), prefix) == 0; };
 
-// 🛠️ Load data from file and build B-Tree indices
-bool Database::load() {
-    std::ifstream inFile(filename);
-    if (!inFile.is_open()) return false;
+    if (engine) {
+        engine->scan(prefix, prefixSuccessor(prefix), [&](std::string_view key, std::string_view stored) {
+            double value;
+            if (matches(key) && TypedValue::numberOf(stored, value)) summary.add(value);
+            return true;
+        });
+        return summary;
+    }
 
-    try {
-        json j;
-        inFile >> j;
+    while (true) {
+        ensureNumericIndex();
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (!numericIndex.ready) continue;
+        const auto& index = numericIndex.byKey;
+        for (auto it = index.lowerBound(std::string_view(prefix)); it != index.end() && matches(it->key); ++it) {
+            summary.add(it->value);
+        }
+        return summary;
+    }
+}
 
-        std::lock_guard<std::mutex> lock(dataMutex);
-        data.clear();
+// 🛠️ Ordered scan: each source yields at most `limit` keys from its sorted order,
+// then the two runs are merged
+std::vector<std::string> Database::scanKeys(const std::string& lo, const std::string& hi,
+                                            bool reverse, size_t limit) const {
+    bool bounded = !hi.empty();
+    if (bounded && hi <= lo) return {};
+    size_t wanted = limit ? limit : std::numeric_limits<size_t>::max();
 
-        for (auto& [key, value] : j.items()) {
-            if (value.is_string()) {
-                data[key] = value.get<std::string>();
-            } else {
-                data[key] = value.dump();
+    if (engine) {
+        // The engine only scans forward, so a reverse scan keeps the last `limit` keys
+        std::deque<std::string> keys;
+        engine->scan(lo, hi, [&](std::string_view key, std::string_view) {
+            keys.emplace_back(key);
+            if (keys.size() > wanted) keys.pop_front();
+            return reverse || keys.size() < wanted;
+        });
+        if (reverse) return std::vector<std::string>(keys.rbegin(), keys.rend());
+        return std::vector<std::string>(keys.begin(), keys.end());
+    }
+
+    std::vector<std::string> memory;
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        auto first = keyIndex.lowerBound(std::string_view(lo));
+        auto last = bounded ? keyIndex.lowerBound(std::string_view(hi)) : keyIndex.end();
+        if (reverse) {
+            for (auto it = last; it != first && memory.size() < wanted;) {
+                memory.push_back((--it)->str());
+            }
+        } else {
+            for (auto it = first; it != last && memory.size() < wanted; ++it) {
+                memory.push_back(it->str());
             }
         }
+    }
 
-        buildBTreeIndices();  // Build B-Tree indices on load
-
-        for (const auto& [key, value] : data) {
-            updateIndices(key, value);
+    std::shared_ptr<const BinarySnapshot> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards[0]->mutex);
+        snapshot = mappedSnapshot;
+    }
+    std::vector<std::string> mapped;
+    if (snapshot) {
+        // Masked snapshot keys are either removed or shadowed by an in-memory copy,
+        // which the first run already covers
+        auto visible = [&](size_t i) {
+            std::string key(snapshot->keyAt(i));
+            const Shard& shard = shardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (!shard.maskedKeys.count(key)) mapped.push_back(std::move(key));
+        };
+        size_t first = snapshot->lowerBound(lo);
+        size_t last = bounded ? snapshot->lowerBound(hi) : snapshot->size();
+        if (reverse) {
+            for (size_t i = last; i > first && mapped.size() < wanted;) visible(--i);
+        } else {
+            for (size_t i = first; i < last && mapped.size() < wanted; i++) visible(i);
         }
-
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading database: " << e.what() << std::endl;
-        return false;
     }
+
+    std::vector<std::string> results;
+    results.reserve(std::min(wanted, memory.size() + mapped.size()));
+    auto before = [reverse](const std::string& a, const std::string& b) {
+        return reverse ? b < a : a < b;
+    };
+    std::merge(std::make_move_iterator(memory.begin()), std::make_move_iterator(memory.end()),
+               std::make_move_iterator(mapped.begin()), std::make_move_iterator(mapped.end()),
+               std::back_inserter(results), before);
+    if (results.size() > wanted) results.resize(wanted);
+    return results;
 }
 
-// 🛠️ Save data to file
-bool Database::save() {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    json j(data);
+// 🛠️ Range query over [lo, hi)
+std::vector<std::string> Database::queryRange(const std::string& lo, const std::string& hi,
+                                              bool reverse, size_t limit) const {
+    return scanKeys(lo, hi, reverse, limit);
+}
 
-    std::ofstream outFile(filename);
-    if (!outFile.is_open()) {
-        std::cerr << "Error saving database to " << filename << std::endl;
-        return false;
+// 🛠️ Query by prefix: the range [prefix, successor of prefix)
+std::vector<std::string> Database::queryByPrefix(const std::string& prefix, bool reverse) const {
+    return scanKeys(prefix, prefixSuccessor(prefix), reverse, 0);
+}
+
+// Per-run state of a structured query
+struct Database::QueryRun {
+    struct Leaf {
+        std::string lo, hi;             // Key terms: [lo, hi), hi empty if unbounded
+        std::string asString, asTyped;  // Value terms: the stored forms that match
+        std::shared_ptr<const ValuePattern> pattern;
+        const SecondaryIndex* index = nullptr;
+        InternedString indexed;         // Invalid if no key is indexed under the value
+    };
+
+    explicit QueryRun(QueryExplain* explain) : explain(explain) {}
+
+    QueryExplain* explain;
+    std::unordered_map<const Query*, Leaf> leaves;
+    std::unordered_map<const Query*, size_t> estimates;
+    size_t rows = 0;  // Live entries
+    std::atomic<size_t> rowsExamined{0};
+    std::atomic<size_t> postingsRead{0};
+
+    // Add a plan line (when explaining) and return its slot, to fill in once counted
+    size_t note(size_t depth, const std::string& line) {
+        if (!explain) return 0;
+        explain->plan.push_back(std::string(depth * 2, ' ') + line);
+        return explain->plan.size() - 1;
     }
+    void amend(size_t slot, const std::string& line) {
+        if (explain) explain->plan[slot] += line;
+    }
+};
 
-    outFile << j.dump(4);
-    return true;
+struct Database::QueryRow {
+    std::string_view key;
+    const InternedString* keyHandle = nullptr;
+    bool loaded = false;   // `stored` and `present` are set
+    bool present = false;
+    std::string_view stored;
+    bool displayed = false;
+    std::string_view shown;  // The value as get() shows it, in place where possible
+    std::string formatted;
+    std::string scratch;
+};
+
+namespace {
+
+// Scan the table when the best index plan would still read more than 1/QUERY_SCAN_FRACTION
+// of it; intersect another term's key list only when it is at most QUERY_INTERSECT_RATIO
+// times the candidates so far (past that, testing each candidate is cheaper)
+constexpr size_t QUERY_SCAN_FRACTION = 2;
+constexpr size_t QUERY_INTERSECT_RATIO = 8;
+constexpr size_t PARALLEL_SCAN_MIN_ROWS = 1 << 14;
+
+bool needsValueKeys(const Query& query) {
+    if (query.kind == Query::Kind::VALUE_EQUALS) return true;
+    return std::any_of(query.children.begin(), query.children.end(), needsValueKeys);
 }
 
-// 🛠️ Insert key-value pair and update B-Trees
-void Database::insert(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    data[key] = value;
-    keyIndex.insert(key);
-    valueIndex.insert(value);
-    updateIndices(key, value);
+// 🛠️ Collect a posting set's keys as a sorted key list
+std::vector<std::string_view> sortedKeys(const InternedSet& keys) {
+    std::vector<std::string_view> list;
+    list.reserve(keys.size());
+    for (const auto& key : keys) list.push_back(key.view());
+    std::sort(list.begin(), list.end());
+    return list;
 }
 
-// 🛠️ Get value by key
-std::string Database::get(const std::string& key) const {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    if (data.find(key) != data.end()) {
-        return data.at(key);
-    }
-    return "";
+}  // namespace
+
+std::vector<std::string> Database::query(const Query& query) const {
+    return runQuery(query, nullptr);
 }
 
-// 🛠️ Remove key-value pair and update B-Trees
-bool Database::remove(const std::string& key) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    if (data.erase(key) > 0) {
-        keyIndex.remove(key);
-        removeFromIndices(key);
-        return true;
+// 🛠️ Keys whose value, shown as by get(), contains a match for `pattern`: a scan
+// with the compiled pattern's SIMD prefilter, in parallel chunks on large tables
+std::vector<std::string> Database::queryByValuePattern(const std::string& pattern) const {
+    return runQuery(Query::valueMatches(pattern), nullptr);
+}
+
+QueryExplain Database::explain(const Query& query) const {
+    QueryExplain explain;
+    explain.matches = runQuery(query, &explain).size();
+    return explain;
+}
+
+// 🛠️ Plan and run a structured query under every shard's read lock
+std::vector<std::string> Database::runQuery(const Query& query, QueryExplain* explain) const {
+    QueryRun run(explain);
+    std::vector<std::string> results;
+
+    if (engine) {
+        runQueryOnEngine(query, run, results);
+    } else {
+        auto locks = lockAllShardsShared();
+        if (needsValueKeys(query)) {
+            // The value index is built on first use, as by queryByValue()
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            if (!valueKeys.ready) buildValueKeysLocked();
+        }
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+
+        size_t masked = 0;
+        for (const auto& shard : shards) {
+            run.rows += shard->entries.size();
+            masked += shard->maskedKeys.size();
+        }
+        if (mappedSnapshot) run.rows += mappedSnapshot->size() - masked;
+
+        prepareQueryLocked(query, run);
+        size_t estimate = estimateLocked(query, run);
+        KeyList keys;
+        if (indexableLocked(query) && estimate <= run.rows / QUERY_SCAN_FRACTION) {
+            run.note(0, "index plan: at most " + std::to_string(estimate) + " of " +
+                        std::to_string(run.rows) + " rows");
+            keys = candidatesLocked(query, run, 1, "");
+        } else {
+            run.note(0, "scan plan: " + std::string(indexableLocked(query) ? "indexes would read " +
+                        std::to_string(estimate) + " of " : "no index covers the query, ") +
+                        std::to_string(run.rows) + " rows");
+            keys = scanQueryLocked(query, run, 1);
+        }
+        results.assign(keys.begin(), keys.end());
     }
-    return false;
+
+    // Say how each value pattern was matched
+    std::function<void(const Query&)> notePatterns = [&](const Query& term) {
+        if (term.kind == Query::Kind::VALUE_REGEX) {
+            run.note(1, "pattern " + term.toString() + ": " + run.leaves.at(&term).pattern->describe());
+        }
+        for (const auto& child : term.children) notePatterns(child);
+    };
+    if (explain) notePatterns(query);
+
+    if (explain) {
+        explain->rowsExamined = run.rowsExamined;
+        explain->postingsRead = run.postingsRead;
+    }
+    return results;
 }
 
-// 🛠️ Build B-Tree Indices
-void Database::buildBTreeIndices() {
-    for (const auto& [key, value] : data) {
-        keyIndex.insert(key);
-        valueIndex.insert(value);
+// 🛠️ A storage engine has no value or secondary indexes: scan it, within the key
+// bounds of the query's key terms
+void Database::runQueryOnEngine(const Query& query, QueryRun& run, std::vector<std::string>& results) const {
+    {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        prepareQueryLocked(query, run);
     }
+    std::string lo, hi;
+    auto narrow = [&](const Query& term) {
+        if (term.kind != Query::Kind::KEY_PREFIX && term.kind != Query::Kind::KEY_RANGE) return;
+        const auto& leaf = run.leaves.at(&term);
+        lo = std::max(lo, leaf.lo);
+        if (!leaf.hi.empty() && (hi.empty() || leaf.hi < hi)) hi = leaf.hi;
+    };
+    if (query.kind == Query::Kind::AND) {
+        for (const auto& child : query.children) narrow(child);
+    } else {
+        narrow(query);
+    }
+    run.note(0, "engine scan over [" + lo + ", " + (hi.empty() ? "*" : hi) + "): " + query.toString());
+    if (!hi.empty() && hi <= lo) return;
+
+    size_t examined = 0;
+    engine->scan(lo, hi, [&](std::string_view key, std::string_view stored) {
+        QueryRow row;
+        row.key = key;
+        row.loaded = row.present = true;
+        row.stored = stored;
+        examined++;
+        if (matchesLocked(query, row, run)) results.emplace_back(key);
+        return true;
+    });
+    run.rowsExamined = examined;
 }
 
-// 🛠️ Query by Prefix Using B-Tree
-std::vector<std::string> Database::queryByPrefixBTree(const std::string& prefix) const {
-    return keyIndex.rangeSearch(prefix);
+// 🛠️ Resolve each leaf once: key bounds, stored value forms, regexes, index postings
+void Database::prepareQueryLocked(const Query& query, QueryRun& run) const {
+    if (!query.isLeaf()) {
+        for (const auto& child : query.children) prepareQueryLocked(child, run);
+        return;
+    }
+    auto& leaf = run.leaves[&query];
+    switch (query.kind) {
+        case Query::Kind::KEY_PREFIX:
+            leaf.lo = query.first;
+            leaf.hi = prefixSuccessor(query.first);
+            break;
+        case Query::Kind::KEY_RANGE:
+            leaf.lo = query.first;
+            leaf.hi = query.second;
+            break;
+        case Query::Kind::VALUE_EQUALS: {
+            // Matches what queryByValue() matches: the string, or a literal's typed value
+            leaf.asString = probeValue(TypedValue::encodeString(query.first));
+            TypedValue typed = TypedValue::parse(query.first);
+            if (typed.getType() != STRING) leaf.asTyped = probeValue(typed.encode());
+            break;
+        }
+        case Query::Kind::VALUE_REGEX:
+            leaf.pattern = PatternCache::instance().get(query.first);  // Throws std::regex_error
+            break;
+        case Query::Kind::INDEX_EQUALS: {
+            auto index = indices.find(query.first);
+            if (index != indices.end()) {
+                leaf.index = &index->second;
+                leaf.indexed = StringPool::instance().find(query.second);
+            }
+            break;
+        }
+        default:
+            break;
+    }
 }
 
-// 🛠️ Query by Value Using B-Tree
-std::vector<std::string> Database::queryByValueBTree(const std::string& value) const {
-    return valueIndex.rangeSearch(value);
+bool Database::indexableLocked(const Query& query) const {
+    switch (query.kind) {
+        case Query::Kind::VALUE_REGEX:
+            return false;
+        case Query::Kind::AND:
+            return std::any_of(query.children.begin(), query.children.end(),
+                               [&](const Query& child) { return indexableLocked(child); });
+        case Query::Kind::OR:
+            return !query.children.empty() &&
+                   std::all_of(query.children.begin(), query.children.end(),
+                               [&](const Query& child) { return indexableLocked(child); });
+        default:
+            return true;
+    }
 }
 
-// 🛠️ Get all data
-std::unordered_map<std::string, std::string> Database::getAllData() const {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    return data;
-}
-
-// 🛠️ Update indices
-void Database::updateIndices(const std::string& key, const std::string& value) {
-    for (auto& [indexName, entries] : indices) {
-        bool found = false;
-        for (auto& entry : entries) {
-            if (entry.key == key) {
-                entry.value = value;
-                found = true;
+// 🛠️ How many keys a term can produce at most. Index terms read their posting sizes;
+// a key range counts the B+tree keys it covers, stopping once a scan would win anyway.
+size_t Database::estimateLocked(const Query& query, QueryRun& run) const {
+    auto cached = run.estimates.find(&query);
+    if (cached != run.estimates.end()) return cached->second;
+
+    size_t estimate = run.rows;
+    switch (query.kind) {
+        case Query::Kind::KEY_PREFIX:
+        case Query::Kind::KEY_RANGE: {
+            const auto& leaf = run.leaves.at(&query);
+            if (!leaf.hi.empty() && leaf.hi <= leaf.lo) {
+                estimate = 0;
                 break;
             }
+            size_t cap = run.rows / QUERY_SCAN_FRACTION + 1;
+            estimate = 0;
+            auto last = leaf.hi.empty() ? keyIndex.end() : keyIndex.lowerBound(std::string_view(leaf.hi));
+            for (auto it = keyIndex.lowerBound(std::string_view(leaf.lo)); it != last && estimate < cap; ++it) {
+                estimate++;
+            }
+            if (mappedSnapshot) {
+                size_t end = leaf.hi.empty() ? mappedSnapshot->size() : mappedSnapshot->lowerBound(leaf.hi);
+                estimate += end - mappedSnapshot->lowerBound(leaf.lo);
+            }
+            break;
         }
-        if (!found) {
-            entries.push_back({key, value});
+        case Query::Kind::VALUE_EQUALS: {
+            const auto& leaf = run.leaves.at(&query);
+            estimate = 0;
+            for (const std::string* stored : {&leaf.asString, &leaf.asTyped}) {
+                if (stored->empty()) continue;
+                InternedString value = StringPool::instance().find(*stored);
+                auto posting = value.valid() ? valueKeys.postings.find(value) : valueKeys.postings.end();
+                if (posting != valueKeys.postings.end()) estimate += posting->second.size();
+            }
+            break;
+        }
+        case Query::Kind::INDEX_EQUALS: {
+            const auto& leaf = run.leaves.at(&query);
+            estimate = 0;
+            if (leaf.index && leaf.indexed.valid()) {
+                auto posting = leaf.index->postings.find(leaf.indexed);
+                if (posting != leaf.index->postings.end()) estimate = posting->second.size();
+            }
+            break;
         }
+        case Query::Kind::AND:
+            for (const auto& child : query.children) {
+                if (indexableLocked(child)) estimate = std::min(estimate, estimateLocked(child, run));
+            }
+            break;
+        case Query::Kind::OR:
+            estimate = 0;
+            for (const auto& child : query.children) estimate += estimateLocked(child, run);
+            estimate = std::min(estimate, run.rows);
+            break;
+        default:
+            break;
     }
+    run.estimates.emplace(&query, estimate);
+    return estimate;
 }
 
-// 🛠️ Remove from indices
-void Database::removeFromIndices(const std::string& key) {
-    for (auto& [_, entries] : indices) {
-        entries.erase(std::remove_if(entries.begin(), entries.end(),
-                    [&key](const IndexEntry& entry) { return entry.key == key; }),
-                    entries.end());
-    }
-}
+// 🛠️ The keys an indexable term matches. An AND is driven by its most selective
+// indexed term; other indexed terms with short enough lists are intersected in, and
+// the remaining terms are tested on each surviving row.
+Database::KeyList Database::candidatesLocked(const Query& query, QueryRun& run, size_t depth,
+                                             const char* role) const {
+    std::string label = std::string(role) + query.toString();
+    KeyList keys;
 
-// 🛠️ Reset database
-void Database::reset(const std::string& newFilename) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    filename = newFilename;
-    data.clear();
-    keyIndex = BTree<std::string>(3);
-    valueIndex = BTree<std::string>(3);
-    load();
-}
+    switch (query.kind) {
+        case Query::Kind::KEY_PREFIX:
+        case Query::Kind::KEY_RANGE: {
+            const auto& leaf = run.leaves.at(&query);
+            if (!leaf.hi.empty() && leaf.hi <= leaf.lo) break;
+            KeyList memory, mapped;
+            auto last = leaf.hi.empty() ? keyIndex.end() : keyIndex.lowerBound(std::string_view(leaf.hi));
+            for (auto it = keyIndex.lowerBound(std::string_view(leaf.lo)); it != last; ++it) {
+                memory.push_back(it->view());
+            }
+            if (mappedSnapshot) {
+                // Masked snapshot keys are removed or shadowed by a key in the B+tree
+                size_t end = leaf.hi.empty() ? mappedSnapshot->size() : mappedSnapshot->lowerBound(leaf.hi);
+                for (size_t i = mappedSnapshot->lowerBound(leaf.lo); i < end; i++) {
+                    std::string_view key = mappedSnapshot->keyAt(i);
+                    if (!shardFor(key).maskedKeys.count(std::string(key))) mapped.push_back(key);
+                }
+            }
+            keys.reserve(memory.size() + mapped.size());
+            std::merge(memory.begin(), memory.end(), mapped.begin(), mapped.end(), std::back_inserter(keys));
+            run.postingsRead += keys.size();
+            run.note(depth, label + " -> " + std::to_string(keys.size()) + " keys (key B+tree)");
+            break;
+        }
+        case Query::Kind::VALUE_EQUALS: {
+            const auto& leaf = run.leaves.at(&query);
+            for (const std::string* stored : {&leaf.asString, &leaf.asTyped}) {
+                if (stored->empty()) continue;
+                InternedString value = StringPool::instance().find(*stored);
+                auto posting = value.valid() ? valueKeys.postings.find(value) : valueKeys.postings.end();
+                if (posting == valueKeys.postings.end()) continue;
+                KeyList found = sortedKeys(posting->second);
+                KeyList merged;
+                std::set_union(keys.begin(), keys.end(), found.begin(), found.end(), std::back_inserter(merged));
+                keys.swap(merged);
+            }
+            run.postingsRead += keys.size();
+            run.note(depth, label + " -> " + std::to_string(keys.size()) + " keys (value index)");
+            break;
+        }
+        case Query::Kind::INDEX_EQUALS: {
+            const auto& leaf = run.leaves.at(&query);
+            if (!leaf.index) {
+                run.note(depth, label + " -> 0 keys (no such index)");
+                break;
+            }
+            auto posting = leaf.indexed.valid() ? leaf.index->postings.find(leaf.indexed)
+                                                : leaf.index->postings.end();
+            if (posting != leaf.index->postings.end()) keys = sortedKeys(posting->second);
+            run.postingsRead += keys.size();
+            run.note(depth, label + " -> " + std::to_string(keys.size()) + " keys (index " + query.first + ")");
+            break;
+        }
+        case Query::Kind::AND: {
+            size_t slot = run.note(depth, std::string(role) + "AND");
+            std::vector<const Query*> indexed, residual;
+            for (const auto& child : query.children) {
+                (indexableLocked(child) ? indexed : residual).push_back(&child);
+            }
+            std::stable_sort(indexed.begin(), indexed.end(), [&](const Query* a, const Query* b) {
+                return estimateLocked(*a, run) < estimateLocked(*b, run);
+            });
 
-// 🛠️ Print B-Tree indices
-void Database::printKeyIndex() const {
-    std::cout << "Key B-Tree Index: ";
-    keyIndex.traverse();
-    std::cout << std::endl;
-}
+            keys = candidatesLocked(*indexed[0], run, depth + 1, "drive: ");
+            for (size_t i = 1; i < indexed.size(); i++) {
+                if (keys.empty() || estimateLocked(*indexed[i], run) > keys.size() * QUERY_INTERSECT_RATIO) {
+                    residual.push_back(indexed[i]);
+                    continue;
+                }
+                KeyList other = candidatesLocked(*indexed[i], run, depth + 1, "intersect: ");
+                KeyList both;
+                std::set_intersection(keys.begin(), keys.end(), other.begin(), other.end(),
+                                      std::back_inserter(both));
+                keys.swap(both);
+            }
 
-void Database::printValueIndex() const {
-    std::cout << "Value B-Tree Index: ";
-    valueIndex.traverse();
-    std::cout << std::endl;
+            if (!residual.empty()) {
+                std::string terms;
+                for (const Query* term : residual) terms += (terms.empty() ? "" : " AND ") + term->toString();
+                size_t tested = keys.size();
+                KeyList kept;
+                for (std::string_view key : keys) {
+                    QueryRow row;
+                    row.key = key;
+                    bool keep = true;
+                    for (const Query* term : residual) {
+                        if (!matchesLocked(*term, row, run)) {
+                            keep = false;
+                            break;
+                        }
+                    }
+                    if (keep) kept.push_back(key);
+                }
+                keys.swap(kept);
+                run.rowsExamined += tested;
+                run.note(depth + 1, "filter: " + terms + " over " + std::to_string(tested) + " rows -> " +
+                                    std::to_string(keys.size()) + " keys");
+            }
+            run.amend(slot, " -> " + std::to_string(keys.size()) + " keys");
+            break;
+        }
+        case Query::Kind::OR: {
+            size_t slot = run.note(depth, std::string(role) + "OR (union)");
+            for (const auto& child : query.children) {
+                KeyList found = candidatesLocked(child, run, depth + 1, "");
+                KeyList merged;
+                std::set_union(keys.begin(), keys.end(), found.begin(), found.end(), std::back_inserter(merged));
+                keys.swap(merged);
+            }
+            run.amend(slot, " -> " + std::to_string(keys.size()) + " keys");
+            break;
+        }
+        default:
+            break;
+    }
+    return keys;
 }
 
-// 🛠️ Query by exact value
-std::vector<std::string> Database::queryByValue(const std::string& value) const {
-    std::vector<std::string> results;
-    std::lock_guard<std::mutex> lock(dataMutex);  // Ensure thread safety
-    for (const auto& [key, val] : data) {
-        if (val == value) results.push_back(key);
+// 🛠️ Test every live entry, one slice of the shards and mapped snapshot per thread as
+// createIndex() does; small tables are scanned on the calling thread
+Database::KeyList Database::scanQueryLocked(const Query& query, QueryRun& run, size_t depth) const {
+    size_t snapshotSize = mappedSnapshot ? mappedSnapshot->size() : 0;
+    size_t workers = run.rows < PARALLEL_SCAN_MIN_ROWS
+        ? 1 : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), shards.size());
+    std::vector<KeyList> slices(workers);
+
+    auto scanSlice = [&](size_t t) {
+        KeyList& slice = slices[t];
+        size_t examined = 0;
+        for (size_t i = t; i < shards.size(); i += workers) {
+            for (const auto& [key, slot] : shards[i]->entries) {
+                QueryRow row;
+                row.key = key.view();
+                row.keyHandle = &key;
+                row.loaded = row.present = true;
+                if (slot.value.valid()) {
+                    row.stored = slot.value.view();
+                } else {
+                    readSlotLocked(slot, row.scratch);
+                    row.stored = row.scratch;
+                }
+                examined++;
+                if (matchesLocked(query, row, run)) slice.push_back(row.key);
+            }
+        }
+        size_t begin = snapshotSize * t / workers;
+        size_t end = snapshotSize * (t + 1) / workers;
+        for (size_t i = begin; i < end; i++) {
+            QueryRow row;
+            row.key = mappedSnapshot->keyAt(i);
+            if (shardFor(row.key).maskedKeys.count(std::string(row.key))) continue;
+            row.loaded = row.present = true;
+            row.stored = mappedSnapshot->valueAt(i);
+            examined++;
+            if (matchesLocked(query, row, run)) slice.push_back(row.key);
+        }
+        run.rowsExamined += examined;
+    };
+
+    if (workers == 1) {
+        scanSlice(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < workers; t++) threads.emplace_back(scanSlice, t);
+        for (auto& thread : threads) thread.join();
     }
-    return results;
+
+    KeyList keys;
+    size_t total = 0;
+    for (const auto& slice : slices) total += slice.size();
+    keys.reserve(total);
+    for (const auto& slice : slices) keys.insert(keys.end(), slice.begin(), slice.end());
+    std::sort(keys.begin(), keys.end());
+    run.note(depth, "parallel scan (" + std::to_string(workers) + (workers == 1 ? " thread" : " threads") +
+                    "): " + query.toString() + " -> " + std::to_string(keys.size()) + " keys");
+    return keys;
 }
 
-// 🛠️ Query by prefix
-std::vector<std::string> Database::queryByPrefix(const std::string& prefix) const {
-    std::vector<std::string> results;
-    std::lock_guard<std::mutex> lock(dataMutex);  // Ensure thread safety
-    for (const auto& [key, value] : data) {
-        if (key.find(prefix) == 0) results.push_back(key);
+// 🛠️ Test one row against a term, looking its value up only if a value term needs it
+bool Database::matchesLocked(const Query& query, QueryRow& row, const QueryRun& run) const {
+    auto value = [&]() -> bool {
+        if (!row.loaded) {
+            row.loaded = true;
+            row.present = peekLocked(shardFor(row.key), row.key, row.scratch, row.stored);
+        }
+        return row.present;
+    };
+
+    switch (query.kind) {
+        case Query::Kind::KEY_PREFIX:
+            return row.key.compare(0, query.first.size(), query.first) == 0;
+        case Query::Kind::KEY_RANGE:
+            return row.key >= query.first && (query.second.empty() || row.key < query.second);
+        case Query::Kind::VALUE_EQUALS: {
+            const auto& leaf = run.leaves.at(&query);
+            return value() && (row.stored == leaf.asString || (!leaf.asTyped.empty() && row.stored == leaf.asTyped));
+        }
+        case Query::Kind::VALUE_REGEX: {
+            if (!value()) return false;
+            if (!row.displayed) {
+                row.displayed = true;
+                std::string_view resolved = resolveValue(row.stored);
+                if (!shownInPlace(resolved, row.shown)) {
+                    row.formatted = TypedValue::display(resolved);
+                    row.shown = row.formatted;
+                }
+            }
+            return run.leaves.at(&query).pattern->matches(row.shown);
+        }
+        case Query::Kind::INDEX_EQUALS: {
+            // The index remembers what it filed each key under
+            const auto& leaf = run.leaves.at(&query);
+            if (!leaf.index || !leaf.indexed.valid()) return false;
+            InternedString key = row.keyHandle ? *row.keyHandle : StringPool::instance().find(row.key);
+            auto indexed = key.valid() ? leaf.index->reverse.find(key) : leaf.index->reverse.end();
+            return indexed != leaf.index->reverse.end() && indexed->second == leaf.indexed;
+        }
+        case Query::Kind::AND:
+            for (const auto& child : query.children) {
+                if (!matchesLocked(child, row, run)) return false;
+            }
+            return true;
+        case Query::Kind::OR:
+            for (const auto& child : query.children) {
+                if (matchesLocked(child, row, run)) return true;
+            }
+            return false;
     }
-    return results;
+    return false;
 }
 
 
-// 🛠️ Export data to file
+// 🛠️ Export data to file, streaming entries straight to disk as JSON or NDJSON. The
+// export reads a snapshot, so it is consistent and writers carry on while it runs.
 bool Database::exportTo(const std::string& filename) const {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    json j(data);
-    std::ofstream outFile(filename);
+    std::ofstream outFile(filename, std::ios::binary);
     if (!outFile.is_open()) return false;
-    outFile << j.dump(4);
+
+    bool ndjson = isNDJSONPath(filename);
+    bool first = true;
+    std::string record;
+    if (!ndjson) outFile << "{";
+    openSnapshot().forEach([&](std::string_view key, std::string_view value) {
+        record.clear();
+        if (ndjson) {
+            record += "{\"key\": ";
+            appendQuoted(record, key);
+            record += ", \"value\": ";
+            appendJSONValue(record, value);
+            record += "}\n";
+        } else {
+            record += first ? "\n    " : ",\n    ";
+            appendQuoted(record, key);
+            record += ": ";
+            appendJSONValue(record, value);
+        }
+        first = false;
+        outFile.write(record.data(), record.size());
+    });
+    if (!ndjson) outFile << (first ? "}" : "\n}");
+    return static_cast<bool>(outFile.flush());
+}
+
+// 🛠️ Apply one parsed import batch (touched shards locked once, in ascending order).
+// Like batchInsert, the batch is logged as one record and is durable on return.
+bool Database::applyImportBatch(const std::vector<std::pair<std::string, std::string>>& batch) {
+    if (engine) {
+        std::vector<std::string> placed;
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        placed.reserve(batch.size());
+        entries.reserve(batch.size());
+        for (const auto& [key, value] : batch) {
+            placed.push_back(placeValue(value));
+            entries.emplace_back(key, placed.back());
+        }
+        return engine->putBatch(entries);
+    }
+
+    std::vector<std::pair<InternedString, InternedString>> interned;
+    interned.reserve(batch.size());
+    std::vector<bool> touched(shards.size(), false);
+    for (const auto& [key, value] : batch) {
+        interned.emplace_back(InternedString(key), InternedString(placeValue(value)));
+        touched[shardIndexFor(key)] = true;
+    }
+
+    uint64_t lsn = 0;
+    {
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (touched[i]) locks.emplace_back(shards[i]->mutex);
+        }
+
+        // A batch can repeat a key, so each write is prepared right before it is applied
+        std::vector<PreparedWrite> writes;
+        writes.reserve(interned.size());
+        for (const auto& [key, value] : interned) {
+            Shard& shard = shardFor(key);
+            writes.push_back(prepareWriteLocked(shard, key, value));
+            putLocked(shard, key, value);
+        }
+
+        {
+            // keyIndex is bulk loaded once the whole import is in
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            for (const auto& write : writes) applyWriteLocked(write);
+            if (valueIndexReady) {
+                std::vector<InternedString> values;
+                values.reserve(interned.size());
+                for (const auto& [_, value] : interned) values.push_back(shownValue(value));
+                std::sort(values.begin(), values.end());
+                valueIndex.insertSorted(values.begin(), values.end());
+            }
+        }
+
+        if (wal) {
+            // Replay applies the pairs in order, so a repeated key still ends on its last value
+            std::vector<std::pair<std::string_view, std::string_view>> record;
+            record.reserve(interned.size());
+            for (const auto& [key, value] : interned) record.emplace_back(key, value);
+            lsn = wal->enqueue(WriteAheadLog::batchInsertRecord(record));
+            if (lsn == 0) return false;
+        }
+    }
+    if (wal) return wal->waitDurable(lsn);
     return true;
 }
 
-// 🛠️ Import data from file
+// 🛠️ Import data from file (JSON object, or NDJSON for .ndjson/.jsonl), streamed in
+// batches so peak memory doesn't grow with the file. On a parse or write error the
+// batches before it stay applied. B-Tree indices are bulk loaded once at the end.
 bool Database::importFrom(const std::string& filename, bool merge) {
-    std::ifstream inFile(filename);
+    std::ifstream inFile(filename, std::ios::binary);
     if (!inFile.is_open()) return false;
 
-    json j;
-    inFile >> j;
-
-    std::lock_guard<std::mutex> lock(dataMutex);
-    if (!merge) {
-        data.clear();
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+    if (!merge && engine) {
+        std::vector<std::string> existing;
+        forEachEntry([&](std::string_view key, std::string_view) { existing.emplace_back(key); });
+        std::vector<std::string_view> keys(existing.begin(), existing.end());
+        if (!keys.empty() && !engine->removeBatch(keys)) return false;
+    } else if (!merge) {
+        std::unique_lock<std::shared_mutex> resetLock(resetMutex);
+        auto locks = lockAllShards();
+        // The log has no record for a wipe, so the wipe is checkpointed instead: the log
+        // so far is moved aside, and dropped once an empty snapshot replaces the file
+        if (wal && !wal->rotate()) {
+            std::cerr << "Error rotating write-ahead log" << std::endl;
+            return false;
+        }
+        std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+        clearShardsLocked();
+        keyIndex.clear();
+        valueIndex.clear();
+        valueIndexReady = false;
+        for (auto& [_, index] : indices) {
+            index.postings.clear();
+            index.reverse.clear();
+        }
+        valueKeys.postings.clear();
+        valueKeys.keyCount = 0;
+        numericIndex.byValue.clear();
+        numericIndex.byKey.clear();
+        statistics.clear();  // Rebuilt by the next getStats()
+        if (wal && !(writeSnapshot(snapshotContentsLocked()) && wal->discardRotated())) {
+            std::cerr << "Error checkpointing the cleared database" << std::endl;
+            return false;
+        }
     }
 
-    for (auto& [key, value] : j.items()) {
-        data[key] = value.is_string() ? value.get<std::string>() : value.dump();
-        updateIndices(key, data[key]);
-    }
+    ImportSink sink = [this](const ImportBatch& batch) { return applyImportBatch(batch); };
+    bool imported = isNDJSONPath(filename) ? importNDJSONStream(inFile, sink)
+                                           : importJSONStream(inFile, sink);
 
+    auto locks = lockAllShards();
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
     buildBTreeIndices();  // Rebuild B-Tree indices after import
-    return true;
+    return imported;
 }
 
 // 🛠️ Get value distribution
 std::unordered_map<std::string, size_t> Database::getValueDistribution() const {
     std::unordered_map<std::string, size_t> distribution;
-    for (const auto& [_, value] : data) {
-        ++distribution[value];
-    }
+    forEachEntry([&](std::string_view, std::string_view value) {
+        ++distribution[TypedValue::display(resolveValue(value))];
+    });
     return distribution;
 }
 
-// 🛠️ Get database size
+// 🛠️ Get database size (shard locks taken one at a time)
 size_t Database::size() const {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    return data.size();
+    size_t total = 0;
+    if (engine) {
+        // Engines don't track a live count (a put may or may not overwrite), so count
+        engine->scan("", "", [&](std::string_view, std::string_view) { return ++total > 0; });
+        return total;
+    }
+
+    size_t masked = 0;
+    std::shared_ptr<const BinarySnapshot> snapshot;
+    for (size_t i = 0; i < shards.size(); i++) {
+        std::shared_lock<std::shared_mutex> lock(shards[i]->mutex);
+        if (i == 0) snapshot = mappedSnapshot;
+        total += shards[i]->entries.size();
+        masked += shards[i]->maskedKeys.size();
+    }
+    return total + (snapshot ? snapshot->size() - masked : 0);
+}
+
+// 🛠️ Gather statistics
+DatabaseStats Database::getStats(size_t topValues) const {
+    DatabaseStats stats;
+    if (engine) {
+        // Engine writes bypass the statistics, so count with a scan
+        std::unordered_map<std::string, uint64_t> distribution;
+        engine->scan("", "", [&](std::string_view key, std::string_view value) {
+            stats.entries++;
+            stats.keyBytes += key.size();
+            stats.valueBytes += value.size();
+            ++distribution[std::string(value)];
+            return true;
+        });
+        stats.topValues.assign(distribution.begin(), distribution.end());
+        size_t shown = std::min(topValues, stats.topValues.size());
+        std::partial_sort(stats.topValues.begin(), stats.topValues.begin() + shown, stats.topValues.end(),
+                          [](const auto& a, const auto& b) { return a.second > b.second; });
+        stats.topValues.resize(shown);
+        stats.topValuesExact = true;
+    } else {
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        if (!statistics.ready) {
+            // First call: count everything once, holding writers off while we do
+            indexLock.unlock();
+            {
+                auto locks = lockAllShardsShared();
+                std::unique_lock<std::shared_mutex> buildLock(indexMutex);
+                if (!statistics.ready) buildStatisticsLocked();
+            }
+            indexLock.lock();
+        }
+        stats.entries = statistics.entries;
+        stats.keyBytes = statistics.keyBytes;
+        stats.valueBytes = statistics.valueBytes;
+        stats.topValues = statistics.values.top(topValues);
+    }
+    for (auto& [value, _] : stats.topValues) {
+        if (!TypedValue::isPlain(value)) value = TypedValue::display(resolveValue(value));
+    }
+
+    std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+    stats.valueIndexReady = valueKeys.ready;
+    if (valueKeys.ready) {
+        stats.valueIndexDistinctValues = valueKeys.postings.size();
+        stats.valueIndexBytes = valueKeys.memoryUsage();
+    }
+    stats.numericIndexReady = numericIndex.ready;
+    if (numericIndex.ready) {
+        stats.numericIndexEntries = numericIndex.byKey.size();
+        stats.numericIndexBytes = numericIndex.memoryUsage();
+    }
+    stats.strings = StringPool::instance().stats();
+    indexLock.unlock();
+    stats.openSnapshots = openSnapshots.load();
+    stats.savedVersions = savedVersions.load();
+
+    if (engine) {
+        stats.hasEngine = true;
+        stats.engine = engine->stats();
+    }
+    if (blobs) {
+        stats.hasBlobStore = true;
+        stats.blobThreshold = blobThreshold;
+        stats.blobs = blobs->stats();
+    }
+    {
+        // Components aren't recounted here: after removals they are reported as stale
+        std::shared_lock<std::shared_mutex> graphLock(graphMutex);
+        stats.graphNodes = graph.nodeCount();
+        stats.graphEdges = graph.edgeCount();
+        stats.graphPendingEdges = graph.pendingEdges();
+        // Nodes the union-find hasn't seen yet are singletons
+        size_t unseen = graph.nodeCount() - std::min(components.size(), graph.nodeCount());
+        stats.graphComponents = components.setCount() + unseen;
+        stats.graphIndependentCycles = cycleEdges;
+        stats.graphComponentsStale = componentsStale;
+        stats.graphBytes = graph.memoryUsage() + components.memoryUsage();
+    }
+
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        stats.cache.budgetBytes = memoryBudget;
+        stats.cache.residentBytes += shard->residentBytes;
+        stats.cache.sharedBytes += std::min(std::max(shard->sharedSeen, shard->sharedBytes), shard->residentBytes);
+        stats.cache.residentValues += shard->entries.size() - shard->spilledValues;
+        stats.cache.spilledValues += shard->spilledValues;
+        stats.cache.hits += shard->hits.load(std::memory_order_relaxed);
+        stats.cache.misses += shard->misses.load(std::memory_order_relaxed);
+        stats.cache.evictions += shard->evictions;
+        if (spill && &shard == &shards.front()) {
+            stats.cache.spillFileBytes = spill->sizeBytes();
+            stats.cache.spillGarbageBytes = spill->garbageBytes();
+        }
+    }
+    return stats;
+}
+
+// 🛠️ Set the value cache's memory budget in bytes (0 = unlimited). The spill file is
+// opened with the first budget and the new limit is enforced straight away.
+bool Database::setMemoryBudget(size_t bytes) {
+    auto locks = lockAllShards();
+    if (bytes && !spill) {
+        auto file = std::make_unique<SpillFile>(filename + ".values");
+        if (!file->open()) return false;
+        spill = std::move(file);
+    }
+    memoryBudget = bytes;
+    if (memoryBudget) {
+        for (auto& shard : shards) {
+            shard->recountShared();
+            evictLocked(*shard, shardBudget());
+        }
+    }
+    return true;
+}
+
+size_t Database::getMemoryBudget() const {
+    std::shared_lock<std::shared_mutex> lock(shards[0]->mutex);
+    return memoryBudget;
+}
+
+// 🛠️ Each shard evicts independently, against an equal slice of the budget
+size_t Database::shardBudget() const {
+    return memoryBudget / shards.size();
+}
+
+bool Database::overBudgetLocked(const Shard& shard) const {
+    return memoryBudget && shard.residentBytes > shardBudget() + std::max(shard.sharedSeen, shard.sharedBytes);
+}
+
+// 🛠️ CLOCK eviction: the hand walks the shard's table slots, giving recently read
+// values a second chance, until the values spilling can actually free fit in
+// `targetBytes`. Shared values are skipped and counted towards the hand's current
+// turn, which carries over between calls, so each slot is counted once a turn however
+// many writes trigger a sweep. Two full turns are enough, since the first clears
+// every reference bit.
+void Database::evictLocked(Shard& shard, size_t targetBytes, const ValueSlot* writing) const {
+    size_t slots = shard.entries.capacity();
+    for (size_t turned = 0; turned < 2 * slots; turned++) {
+        if (shard.residentBytes <= targetBytes + std::max(shard.sharedSeen, shard.sharedBytes)) return;
+        size_t index = shard.clockHand++ % slots;
+        if (++shard.sweptSlots >= slots) {
+            shard.sharedBytes = shard.sharedSeen;
+            shard.sharedSeen = 0;
+            shard.sweptSlots = 0;
+        }
+        if (!shard.entries.occupied(index)) continue;
+        ValueSlot& slot = shard.entries.slotAt(index).second;
+        if (!slot.value.valid() || &slot == writing) continue;
+        if (slot.value.useCount() > 1) {
+            shard.sharedSeen += slot.value.size();
+            continue;
+        }
+        if (slot.referenced.exchange(false, std::memory_order_relaxed)) continue;
+        if (!spillSlotLocked(shard, slot)) return;  // Spill file unwritable: stay over budget
+    }
+}
+
+// 🛠️ Drop a slot's resident copy, writing it out first unless the spill file has it
+bool Database::spillSlotLocked(Shard& shard, ValueSlot& slot) const {
+    if (!spill) return false;
+    if (!slot.spilled.valid()) {
+        slot.spilled = spill->append(slot.value.view());
+        if (!slot.spilled.valid()) return false;
+    }
+    shard.residentBytes -= slot.value.size();
+    shard.spilledValues++;
+    shard.evictions++;
+    slot.value = InternedString();
+    return true;
+}
+
+// 🛠️ Rewrite the spill file with only the values still spilled. Resident values
+// lose their clean copy and are simply written again if evicted later.
+bool Database::compactSpillLocked() {
+    auto compacted = std::make_unique<SpillFile>(spill->getPath() + ".compact");
+    if (!compacted->open()) return false;
+
+    // Copy first and repoint the slots only once every copy succeeded
+    std::vector<std::pair<ValueSlot*, SpillRef>> moves;
+    std::string value;
+    for (auto& shard : shards) {
+        for (auto& [_, slot] : shard->entries) {
+            if (!slot.spilled.valid()) continue;
+            SpillRef moved;
+            if (!slot.value.valid()) {
+                moved = spill->read(slot.spilled, value) ? compacted->append(value) : SpillRef();
+                if (!moved.valid()) {
+                    std::cerr << "Error compacting value spill file" << std::endl;
+                    return false;
+                }
+            }
+            moves.emplace_back(&slot, moved);
+        }
+    }
+    for (auto& [slot, moved] : moves) slot->spilled = moved;
+
+    std::string path = spill->getPath();
+    spill.reset();  // Closes and deletes the old file
+    if (!compacted->renameTo(path)) std::cerr << "Error renaming compacted spill file" << std::endl;
+    spill = std::move(compacted);
+    return true;
+}
+
+// 🛠️ Evict down to the budget, recounting shared values from scratch, then compact
+// the spill file once most of it is garbage
+void Database::optimize() {
+    auto locks = lockAllShards();
+    if (memoryBudget) {
+        for (auto& shard : shards) {
+            shard->recountShared();
+            evictLocked(*shard, shardBudget());
+        }
+    }
+    if (spill && spill->garbageBytes() > spill->liveBytes()) compactSpillLocked();
+}
+
+// 🛠️ Drop the lazily built value indexes, which are rebuilt on their next use, then
+// evict every value (with a budget) that nothing else still holds
+void Database::clearCache() {
+    auto locks = lockAllShards();
+    {
+        std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+        valueKeys.clear();
+        numericIndex.clear();
+        valueIndex.clear();
+        valueIndexReady = false;
+    }
+
+    if (spill) {
+        for (auto& shard : shards) {
+            shard->recountShared();
+            for (auto& [_, slot] : shard->entries) {
+                if (!slot.value.valid()) continue;
+                if (slot.value.useCount() > 1) shard->sharedBytes += slot.value.size();
+                else spillSlotLocked(*shard, slot);
+            }
+        }
+    }
 }
@@ -0,0 +1,177 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t pairKey(NodeId from, NodeId to) {
+    return uint64_t(from) << 32 | to;
+}
+
+}  // namespace
+
+// 🛠️ Copy everything but the name index, which is rebuilt (its table isn't copyable)
+Graph::Graph(const Graph& other)
+    : names(other.names), offsets(other.offsets), targets(other.targets), weights(other.weights),
+      pending(other.pending), pendingPairs(other.pendingPairs), removedPairs(other.removedPairs),
+      negativeWeights(other.negativeWeights) {
+    ids.reserve(names.size());
+    for (NodeId id = 0; id < names.size(); id++) ids.try_emplace(names[id], id);
+}
+
+Graph& Graph::operator=(const Graph& other) {
+    if (this != &other) *this = Graph(other);
+    return *this;
+}
+
+// 🛠️ Intern a node name, giving it the next id
+NodeId Graph::addNode(std::string_view name) {
+    auto found = ids.find(name);
+    if (found != ids.end()) return found->second;
+    NodeId id = static_cast<NodeId>(names.size());
+    names.emplace_back(name);
+    ids.try_emplace(names.back(), id);
+    return id;
+}
+
+NodeId Graph::find(std::string_view name) const {
+    auto found = ids.find(name);
+    return found != ids.end() ? found->second : NONE;
+}
+
+// 🛠️ Binary search the sorted CSR row
+bool Graph::hasCompactedEdge(NodeId from, NodeId to) const {
+    const NodeId* first = targetsOf(from);
+    const NodeId* last = first + degree(from);
+    return std::binary_search(first, last, to);
+}
+
+bool Graph::hasEdge(NodeId from, NodeId to) const {
+    uint64_t key = pairKey(from, to);
+    return pendingPairs.count(key) || (hasCompactedEdge(from, to) && !removedPairs.count(key));
+}
+
+// 🛠️ Buffer a new edge; an existing one keeps its weight. A removed edge added back
+// is buffered as new, and its old copy stays marked removed.
+bool Graph::addEdge(NodeId from, NodeId to, int weight) {
+    uint64_t key = pairKey(from, to);
+    if (hasCompactedEdge(from, to) && !removedPairs.count(key)) return false;
+    if (!pendingPairs.insert(key).second) return false;
+    pending.push_back({from, to, weight});
+    negativeWeights += weight < 0;
+    return true;
+}
+
+// 🛠️ Drop a buffered edge, or mark a compacted one removed until the next compaction
+bool Graph::removeEdge(NodeId from, NodeId to) {
+    uint64_t key = pairKey(from, to);
+    if (pendingPairs.erase(key)) {
+        auto at = std::find_if(pending.begin(), pending.end(),
+                               [&](const PendingEdge& edge) { return edge.from == from && edge.to == to; });
+        negativeWeights -= at->weight < 0;
+        *at = pending.back();
+        pending.pop_back();
+        return true;
+    }
+    if (!hasCompactedEdge(from, to) || !removedPairs.insert(key).second) return false;
+    const NodeId* row = targetsOf(from);
+    negativeWeights -= weightsOf(from)[std::lower_bound(row, row + degree(from), to) - row] < 0;
+    return true;
+}
+
+bool Graph::shouldCompact() const {
+    return pendingEdges() >= std::max(COMPACT_MIN_PENDING, targets.size() / 8);
+}
+
+// 🛠️ Rebuild the CSR arrays with the delta buffer merged in and removed edges left
+// out: sort the buffer by (from, to), then merge it row by row with the old arrays in
+// one pass
+void Graph::compact() {
+    if (pending.empty() && removedPairs.empty() && offsets.size() == names.size() + 1) return;
+    std::sort(pending.begin(), pending.end(), [](const PendingEdge& a, const PendingEdge& b) {
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    });
+
+    size_t nodes = names.size();
+    std::vector<uint64_t> newOffsets(nodes + 1, 0);
+    std::vector<NodeId> newTargets(targets.size() + pending.size());
+    std::vector<int> newWeights(newTargets.size());
+
+    size_t out = 0;
+    size_t next = 0;  // Next pending edge
+    for (NodeId u = 0; u < nodes; u++) {
+        newOffsets[u] = out;
+        size_t i = u + 1 < offsets.size() ? offsets[u] : 0;
+        size_t end = u + 1 < offsets.size() ? offsets[u + 1] : 0;
+        while (i < end || (next < pending.size() && pending[next].from == u)) {
+            bool fromOld = next >= pending.size() || pending[next].from != u ||
+                           (i < end && targets[i] < pending[next].to);
+            if (fromOld && !removedPairs.empty() && removedPairs.count(pairKey(u, targets[i]))) {
+                i++;
+            } else if (fromOld) {
+                newTargets[out] = targets[i];
+                newWeights[out++] = weights[i++];
+            } else {
+                newTargets[out] = pending[next].to;
+                newWeights[out++] = pending[next++].weight;
+            }
+        }
+    }
+    newOffsets[nodes] = out;
+    newTargets.resize(out);
+    newWeights.resize(out);
+
+    offsets.swap(newOffsets);
+    targets.swap(newTargets);
+    weights.swap(newWeights);
+    pending.clear();
+    pending.shrink_to_fit();
+    pendingPairs = {};
+    removedPairs = {};
+}
+
+void Graph::clear() {
+    *this = Graph();
+}
+
+// 🛠️ Breadth-first order: the output doubles as the queue
+std::vector<NodeId> Graph::bfs(NodeId start) const {
+    std::vector<NodeId> order;
+    NodeBitset visited(names.size());
+    order.push_back(start);
+    visited.set(start);
+    for (size_t head = 0; head < order.size(); head++) {
+        NodeId u = order[head];
+        const NodeId* row = targetsOf(u);
+        for (size_t i = 0, n = degree(u); i < n; i++) {
+            if (!visited.testAndSet(row[i])) order.push_back(row[i]);
+        }
+    }
+    return order;
+}
+
+// 🛠️ Depth-first order. Visited neighbors are never pushed, which leaves the order
+// the same as pushing every neighbor and skipping visited ones on pop.
+std::vector<NodeId> Graph::dfs(NodeId start) const {
+    std::vector<NodeId> order;
+    std::vector<NodeId> stack{start};
+    NodeBitset visited(names.size());
+    while (!stack.empty()) {
+        NodeId u = stack.back();
+        stack.pop_back();
+        if (visited.testAndSet(u)) continue;
+        order.push_back(u);
+        const NodeId* row = targetsOf(u);
+        for (size_t i = 0, n = degree(u); i < n; i++) {
+            if (!visited.test(row[i])) stack.push_back(row[i]);
+        }
+    }
+    return order;
+}
+
+size_t Graph::memoryUsage() const {
+    return names.capacity() * sizeof(InternedString) + ids.memoryUsage() +
+           offsets.capacity() * sizeof(uint64_t) + targets.capacity() * sizeof(NodeId) +
+           weights.capacity() * sizeof(int) + pending.capacity() * sizeof(PendingEdge) +
+           (pendingPairs.size() + removedPairs.size()) * (sizeof(uint64_t) + 2 * sizeof(void*)) +
+           (pendingPairs.bucket_count() + removedPairs.bucket_count()) * sizeof(void*);
+}
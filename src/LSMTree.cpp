@@ -0,0 +1,770 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/LSMTree.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char RUN_MAGIC[8] = {'V', 'D', 'B', 'R', 'U', 'N', '\0', '\0'};
+const char* MANIFEST_MAGIC = "VDBLSM";
+
+constexpr size_t MEMTABLE_ENTRY_OVERHEAD = 64;  // Map node, strings and tombstone flag
+constexpr size_t RUN_WRITE_BUFFER = 1 << 20;
+
+// Bytes a record takes in the write-ahead log: frame header plus payload
+uint64_t loggedBytes(const WALRecord& record) {
+    return 8 + 1 + 4 + record.key.size() + 4 + record.value.size();
+}
+
+// One sorted input to a merge: a copied memtable range or a run
+struct MergeSource {
+    struct Row {
+        std::string key;
+        std::string value;
+        bool tombstone;
+    };
+
+    const std::vector<Row>* rows = nullptr;
+    const SortedRun* run = nullptr;
+    size_t pos = 0;
+    size_t end = 0;
+
+    std::string_view key() const { return run ? run->keyAt(pos) : std::string_view((*rows)[pos].key); }
+    std::string_view value() const { return run ? run->valueAt(pos) : std::string_view((*rows)[pos].value); }
+    bool tombstone() const { return run ? run->isTombstone(pos) : (*rows)[pos].tombstone; }
+    bool done() const { return pos >= end; }
+};
+
+// 🛠️ K-way merge of sources ordered newest first: each key is emitted once, with
+// the newest source's value. Stops early when `emit` returns false.
+template <typename Emit>
+void mergeSources(std::vector<MergeSource>& sources, Emit emit) {
+    // Min-heap on (key, source index); a lower index is a newer source
+    auto later = [&](size_t a, size_t b) {
+        int order = sources[a].key().compare(sources[b].key());
+        return order != 0 ? order > 0 : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (!sources[i].done()) heap.push(i);
+    }
+
+    while (!heap.empty()) {
+        size_t newest = heap.top();
+        heap.pop();
+        MergeSource& winner = sources[newest];
+        bool keepGoing = emit(winner.key(), winner.value(), winner.tombstone());
+
+        // Skip the older copies of this key
+        while (!heap.empty() && sources[heap.top()].key() == winner.key()) {
+            size_t older = heap.top();
+            heap.pop();
+            if (++sources[older].pos < sources[older].end) heap.push(older);
+        }
+        if (!keepGoing) return;
+        if (++winner.pos < winner.end) heap.push(newest);
+    }
+}
+
+}  // namespace
+
+// 🛠️ FNV-1a with a final avalanche, so the filter bits are stable across builds
+uint64_t BloomFilter::hash(std::string_view key) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (char c : key) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 0x100000001B3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint32_t BloomFilter::probesFor(size_t bitsPerKey) {
+    long probes = std::lround(bitsPerKey * 0.69);  // ln 2 minimizes false positives
+    return static_cast<uint32_t>(std::clamp(probes, 1L, 30L));
+}
+
+void BloomFilter::add(std::vector<uint8_t>& bits, uint32_t probes, uint64_t keyHash) {
+    uint64_t bitCount = bits.size() * 8;
+    uint64_t delta = (keyHash >> 17) | (keyHash << 47);
+    for (uint32_t i = 0; i < probes; i++) {
+        uint64_t bit = keyHash % bitCount;
+        bits[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+        keyHash += delta;
+    }
+}
+
+bool BloomFilter::mayContain(std::string_view key) const {
+    if (bitCount == 0) return true;
+    uint64_t h = hash(key);
+    uint64_t delta = (h >> 17) | (h << 47);
+    for (uint32_t i = 0; i < probes; i++) {
+        uint64_t bit = h % bitCount;
+        if (!(bits[bit / 8] & (1u << (bit % 8)))) return false;
+        h += delta;
+    }
+    return true;
+}
+
+SortedRun::SortedRun(const std::string& path, uint64_t id)
+    : path(path), id(id), base(nullptr), length(0), header(nullptr), slots(nullptr), obsolete(false) {}
+
+SortedRun::~SortedRun() {
+    if (base) munmap(const_cast<char*>(base), length);
+    if (obsolete) ::unlink(path.c_str());
+}
+
+// 🛠️ Map a run read-only and validate its section bounds
+std::shared_ptr<SortedRun> SortedRun::open(const std::string& path, uint64_t id) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RunHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return nullptr;
+
+    std::shared_ptr<SortedRun> run(new SortedRun(path, id));
+    run->base = static_cast<const char*>(mapped);
+    run->length = st.st_size;
+    run->header = reinterpret_cast<const RunHeader*>(run->base);
+
+    const RunHeader& h = *run->header;
+    if (std::memcmp(h.magic, RUN_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != FORMAT_VERSION || h.fileSize != run->length ||
+        h.valueHeapOffset > h.keyBlockOffset || h.keyBlockOffset > h.slotTableOffset ||
+        h.slotTableOffset + h.count * sizeof(RunSlot) > h.bloomOffset ||
+        h.bloomOffset + h.bloomBits / 8 > run->length ||
+        h.slotTableOffset % alignof(RunSlot) != 0) {
+        std::cerr << "Error loading sorted run " << path << ": bad header" << std::endl;
+        return nullptr;
+    }
+    run->slots = reinterpret_cast<const RunSlot*>(run->base + h.slotTableOffset);
+    run->bloom = BloomFilter(reinterpret_cast<const uint8_t*>(run->base + h.bloomOffset),
+                             h.bloomBits, h.bloomProbes);
+
+#ifdef MADV_RANDOM
+    madvise(const_cast<char*>(run->base), h.keyBlockOffset, MADV_RANDOM);
+#endif
+    return run;
+}
+
+size_t SortedRun::size() const {
+    return header->count;
+}
+
+std::string_view SortedRun::keyAt(size_t i) const {
+    const RunSlot& slot = slots[i];
+    return std::string_view(base + header->keyBlockOffset + slot.keyOffset, slot.keyLength);
+}
+
+std::string_view SortedRun::valueAt(size_t i) const {
+    const RunSlot& slot = slots[i];
+    if (slot.valueLength == RunSlot::TOMBSTONE) return std::string_view();
+    return std::string_view(base + header->valueHeapOffset + slot.valueOffset, slot.valueLength);
+}
+
+bool SortedRun::isTombstone(size_t i) const {
+    return slots[i].valueLength == RunSlot::TOMBSTONE;
+}
+
+// 🛠️ Binary search over the slot table
+size_t SortedRun::lowerBound(std::string_view key) const {
+    size_t lo = 0;
+    size_t hi = header->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+SortedRunWriter::SortedRunWriter(const std::string& path, size_t bitsPerKey)
+    : path(path), fd(-1), bitsPerKey(bitsPerKey), valueBytes(0), failed(false) {}
+
+SortedRunWriter::~SortedRunWriter() {
+    if (fd >= 0) {
+        // finish() was never reached: don't leave a half-written run behind
+        ::close(fd);
+        ::unlink(path.c_str());
+    }
+}
+
+bool SortedRunWriter::open() {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) std::cerr << "Error creating sorted run " << path << std::endl;
+    return fd >= 0;
+}
+
+bool SortedRunWriter::writeAt(uint64_t offset, const char* data, size_t size) {
+    for (size_t written = 0; written < size;) {
+        ssize_t n = ::pwrite(fd, data + written, size - written, offset + written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool SortedRunWriter::flushPending() {
+    if (pending.empty()) return true;
+    uint64_t offset = sizeof(RunHeader) + valueBytes - pending.size();
+    bool ok = writeAt(offset, pending.data(), pending.size());
+    pending.clear();
+    return ok;
+}
+
+void SortedRunWriter::add(std::string_view key, std::string_view value, bool tombstone) {
+    RunSlot slot{keyBlock.size(), valueBytes, static_cast<uint32_t>(key.size()),
+                 tombstone ? RunSlot::TOMBSTONE : static_cast<uint32_t>(value.size())};
+    slots.push_back(slot);
+    keyBlock.append(key.data(), key.size());
+    keyHashes.push_back(BloomFilter::hash(key));
+    if (!tombstone) {
+        pending.append(value.data(), value.size());
+        valueBytes += value.size();
+        if (pending.size() >= RUN_WRITE_BUFFER && !flushPending()) failed = true;
+    }
+}
+
+// 🛠️ Lay out key block, slot table and bloom filter after the values, then the header
+bool SortedRunWriter::finish(uint64_t& fileBytes) {
+    if (fd < 0 || failed || !flushPending()) return false;
+
+    RunHeader h{};
+    std::memcpy(h.magic, RUN_MAGIC, sizeof(h.magic));
+    h.version = SortedRun::FORMAT_VERSION;
+    h.bloomProbes = BloomFilter::probesFor(bitsPerKey);
+    h.count = slots.size();
+    h.valueHeapOffset = sizeof(RunHeader);
+    h.keyBlockOffset = h.valueHeapOffset + valueBytes;
+    uint64_t keyBlockEnd = h.keyBlockOffset + keyBlock.size();
+    h.slotTableOffset = (keyBlockEnd + alignof(RunSlot) - 1) / alignof(RunSlot) * alignof(RunSlot);
+    h.bloomOffset = h.slotTableOffset + h.count * sizeof(RunSlot);
+    h.bloomBits = std::max<uint64_t>(64, (h.count * bitsPerKey + 7) / 8 * 8);
+    h.fileSize = h.bloomOffset + h.bloomBits / 8;
+
+    std::vector<uint8_t> bloom(h.bloomBits / 8, 0);
+    for (uint64_t keyHash : keyHashes) BloomFilter::add(bloom, h.bloomProbes, keyHash);
+
+    bool ok = writeAt(h.keyBlockOffset, keyBlock.data(), keyBlock.size()) &&
+              writeAt(h.slotTableOffset, reinterpret_cast<const char*>(slots.data()),
+                      slots.size() * sizeof(RunSlot)) &&
+              writeAt(h.bloomOffset, reinterpret_cast<const char*>(bloom.data()), bloom.size()) &&
+              writeAt(0, reinterpret_cast<const char*>(&h), sizeof(h)) &&
+              ::ftruncate(fd, h.fileSize) == 0 && ::fsync(fd) == 0;
+    if (!ok) return false;
+
+    ::close(fd);
+    fd = -1;
+    fileBytes = h.fileSize;
+    return true;
+}
+
+// 🛠️ Constructor: nothing touches disk until open()
+LSMTree::LSMTree(const std::string& directory, const LSMOptions& options)
+    : directory(directory), options(options), active(std::make_unique<Memtable>()), activeBytes(0),
+      version(std::make_shared<const Version>()), nextRunId(1), stopping(false), failed(false),
+      userBytes(0), logBytes(0), flushBytes(0), compactionBytes(0), flushes(0), compactions(0),
+      bloomNegatives(0), runProbes(0) {}
+
+LSMTree::~LSMTree() {
+    close();
+}
+
+std::string LSMTree::runPath(uint64_t id) const {
+    return directory + "/run-" + std::to_string(id) + ".sst";
+}
+
+std::string LSMTree::manifestPath() const {
+    return directory + "/MANIFEST";
+}
+
+// 🛠️ Manifest: a text list of live runs per level, replaced atomically on every install
+//   VDBLSM 1
+//   next <run id>
+//   run <level> <run id>     (level 0 newest first)
+bool LSMTree::readManifest(Version& loaded) {
+    std::ifstream inFile(manifestPath());
+    if (!inFile.is_open()) return true;  // Fresh tree
+
+    std::string magic;
+    int formatVersion = 0;
+    if (!(inFile >> magic >> formatVersion) || magic != MANIFEST_MAGIC || formatVersion != 1) {
+        std::cerr << "Error loading LSM manifest " << manifestPath() << std::endl;
+        return false;
+    }
+    std::string tag;
+    while (inFile >> tag) {
+        if (tag == "next") {
+            inFile >> nextRunId;
+        } else if (tag == "run") {
+            size_t level;
+            uint64_t id;
+            inFile >> level >> id;
+            auto run = SortedRun::open(runPath(id), id);
+            if (!run) {
+                std::cerr << "Error loading LSM run " << runPath(id) << std::endl;
+                return false;
+            }
+            if (loaded.levels.size() <= level) loaded.levels.resize(level + 1);
+            loaded.levels[level].push_back(std::move(run));
+        }
+    }
+    return true;
+}
+
+bool LSMTree::writeManifest(const Version& next) const {
+    std::string tmpPath = manifestPath() + ".tmp";
+    {
+        std::ofstream outFile(tmpPath, std::ios::trunc);
+        if (!outFile.is_open()) return false;
+        outFile << MANIFEST_MAGIC << " 1\nnext " << nextRunId << "\n";
+        for (size_t level = 0; level < next.levels.size(); level++) {
+            for (const auto& run : next.levels[level]) {
+                outFile << "run " << level << " " << run->getId() << "\n";
+            }
+        }
+        if (!outFile.flush()) return false;
+    }
+    int fd = ::open(tmpPath.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+    return std::rename(tmpPath.c_str(), manifestPath().c_str()) == 0;
+}
+
+// 🛠️ Load the manifest, replay the log into the memtable and start the background threads
+bool LSMTree::open() {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Error creating LSM directory " << directory << std::endl;
+        return false;
+    }
+
+    Version loaded;
+    if (!readManifest(loaded)) return false;
+    version = std::make_shared<const Version>(std::move(loaded));
+
+    auto log = std::make_unique<WriteAheadLog>(directory + "/wal", options.wal);
+    if (!log->open()) return false;
+    wal = std::move(log);
+    wal->replay([this](const WALRecord& record) {
+        applyLocked(record.key, record.value, record.op == WALOp::REMOVE);
+    });
+
+    flusher = std::thread(&LSMTree::flusherLoop, this);
+    compactor = std::thread(&LSMTree::compactorLoop, this);
+    return true;
+}
+
+// 🛠️ Stop the background threads (a sealed memtable is flushed first) and close the log.
+// The live memtable stays in the log and is replayed on the next open().
+void LSMTree::close() {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        stopping = true;
+    }
+    sealedCv.notify_all();
+    installedCv.notify_all();
+    compactCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    if (compactor.joinable()) compactor.join();
+    if (wal) wal->close();
+}
+
+void LSMTree::applyLocked(std::string_view key, std::string_view value, bool tombstone) {
+    auto it = active->find(key);
+    if (it == active->end()) {
+        active->emplace(std::string(key), MemEntry{std::string(value), tombstone});
+        activeBytes += key.size() + value.size() + MEMTABLE_ENTRY_OVERHEAD;
+    } else {
+        activeBytes += value.size();
+        activeBytes -= std::min(activeBytes, it->second.value.size());
+        it->second.value.assign(value.data(), value.size());
+        it->second.tombstone = tombstone;
+    }
+}
+
+// 🛠️ Hand the full memtable to the flusher. The log is rotated at the same moment,
+// so the rotated log holds exactly the sealed memtable's records.
+bool LSMTree::sealLocked() {
+    if (!wal->rotate()) {
+        std::cerr << "Error rotating LSM write-ahead log" << std::endl;
+        return false;
+    }
+    immutable = std::shared_ptr<const Memtable>(std::move(active));
+    active = std::make_unique<Memtable>();
+    activeBytes = 0;
+    sealedCv.notify_one();
+    return true;
+}
+
+// 🛠️ Common write path: seal a full memtable (stalling while the previous one is still
+// being flushed), log the record and apply it, then wait for the group commit
+bool LSMTree::write(const WALRecord& record, uint64_t keyValueBytes,
+                    const std::function<void()>& apply) {
+    uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        while (activeBytes >= options.memtableBytes && !failed && !stopping) {
+            if (!immutable) {
+                if (!sealLocked()) break;
+                continue;
+            }
+            installedCv.wait(lock);
+        }
+        if (failed || stopping) return false;
+        lsn = wal->enqueue(record);
+        if (lsn == 0) return false;
+        apply();
+    }
+    userBytes += keyValueBytes;
+    logBytes += loggedBytes(record);
+    return wal->waitDurable(lsn);
+}
+
+bool LSMTree::put(std::string_view key, std::string_view value) {
+    WALRecord record{WALOp::INSERT, std::string(key), std::string(value)};
+    return write(record, key.size() + value.size(), [&] { applyLocked(key, value, false); });
+}
+
+bool LSMTree::remove(std::string_view key) {
+    WALRecord record{WALOp::REMOVE, std::string(key), ""};
+    return write(record, key.size(), [&] { applyLocked(key, std::string_view(), true); });
+}
+
+bool LSMTree::putBatch(const std::vector<std::pair<std::string_view, std::string_view>>& entries) {
+    if (entries.empty()) return true;
+    uint64_t bytes = 0;
+    for (const auto& [key, value] : entries) bytes += key.size() + value.size();
+    return write(WriteAheadLog::batchInsertRecord(entries), bytes, [&] {
+        for (const auto& [key, value] : entries) applyLocked(key, value, false);
+    });
+}
+
+bool LSMTree::removeBatch(const std::vector<std::string_view>& keys) {
+    if (keys.empty()) return true;
+    uint64_t bytes = 0;
+    for (const auto& key : keys) bytes += key.size();
+    return write(WriteAheadLog::batchRemoveRecord(keys), bytes, [&] {
+        for (const auto& key : keys) applyLocked(key, std::string_view(), true);
+    });
+}
+
+// 🛠️ Point lookup: memtables, then runs newest to oldest. A run whose bloom filter
+// rules the key out is never searched, so most misses don't touch its pages.
+bool LSMTree::get(std::string_view key, std::string& value) const {
+    std::shared_ptr<const Version> current;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (const Memtable* table : {static_cast<const Memtable*>(active.get()), immutable.get()}) {
+            if (!table) continue;
+            auto it = table->find(key);
+            if (it != table->end()) {
+                if (it->second.tombstone) return false;
+                value = it->second.value;
+                return true;
+            }
+        }
+        current = version;
+    }
+
+    for (const auto& level : current->levels) {
+        for (const auto& run : level) {
+            if (!run->mayContain(key)) {
+                bloomNegatives.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            runProbes.fetch_add(1, std::memory_order_relaxed);
+            size_t i = run->lowerBound(key);
+            if (i < run->size() && run->keyAt(i) == key) {
+                if (run->isTombstone(i)) return false;
+                value.assign(run->valueAt(i));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 🛠️ Ordered range scan: the memtables' slices of the range are copied under the lock,
+// then merged with every run's slice, newest copy of each key winning
+void LSMTree::scan(std::string_view lo, std::string_view hi, const ScanVisitor& visit) const {
+    bool bounded = !hi.empty();
+    if (bounded && hi <= lo) return;
+
+    std::vector<std::vector<MergeSource::Row>> copies;
+    std::shared_ptr<const Version> current;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (const Memtable* table : {static_cast<const Memtable*>(active.get()), immutable.get()}) {
+            if (!table) continue;
+            auto& rows = copies.emplace_back();
+            auto last = bounded ? table->lower_bound(hi) : table->end();
+            for (auto it = table->lower_bound(lo); it != last; ++it) {
+                rows.push_back({it->first, it->second.value, it->second.tombstone});
+            }
+        }
+        current = version;
+    }
+
+    std::vector<MergeSource> sources;
+    for (const auto& rows : copies) {
+        MergeSource source;
+        source.rows = &rows;
+        source.end = rows.size();
+        sources.push_back(source);
+    }
+    for (const auto& level : current->levels) {
+        for (const auto& run : level) {
+            MergeSource source;
+            source.run = run.get();
+            source.pos = run->lowerBound(lo);
+            source.end = bounded ? run->lowerBound(hi) : run->size();
+            sources.push_back(source);
+        }
+    }
+
+    mergeSources(sources, [&](std::string_view key, std::string_view value, bool tombstone) {
+        return tombstone || visit(key, value);
+    });
+}
+
+bool LSMTree::sync() {
+    return wal && wal->sync();
+}
+
+// 🛠️ Flush the live memtable to a run and wait for it to be installed
+bool LSMTree::flush() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    installedCv.wait(lock, [&] { return !immutable || failed || stopping; });
+    if (!active->empty() && !failed && !stopping) {
+        if (!sealLocked()) return false;
+        installedCv.wait(lock, [&] { return !immutable || failed || stopping; });
+    }
+    return !failed && !immutable;
+}
+
+// 🛠️ Flusher thread: write each sealed memtable out as the newest level-0 run
+void LSMTree::flusherLoop() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    while (true) {
+        sealedCv.wait(lock, [&] { return immutable || stopping; });
+        if (!immutable) break;
+        std::shared_ptr<const Memtable> sealed = immutable;
+        lock.unlock();
+
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> install(installMutex);
+            id = nextRunId++;
+        }
+        SortedRunWriter writer(runPath(id), options.bloomBitsPerKey);
+        uint64_t bytes = 0;
+        bool ok = writer.open();
+        if (ok) {
+            for (const auto& [key, entry] : *sealed) writer.add(key, entry.value, entry.tombstone);
+            ok = writer.finish(bytes);
+        }
+        std::shared_ptr<SortedRun> run = ok ? SortedRun::open(runPath(id), id) : nullptr;
+
+        std::lock_guard<std::mutex> install(installMutex);
+        if (run) {
+            Version next = *version;  // Only installs replace `version`, and we hold installMutex
+            if (next.levels.empty()) next.levels.resize(1);
+            next.levels[0].insert(next.levels[0].begin(), run);
+            ok = writeManifest(next);
+            lock.lock();
+            if (ok) {
+                // The run is durable and listed, so the log records it covers can go
+                wal->discardRotated();
+                version = std::make_shared<const Version>(std::move(next));
+                immutable.reset();
+            }
+        } else {
+            lock.lock();
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Error flushing LSM memtable to " << runPath(id) << std::endl;
+            failed = true;
+            installedCv.notify_all();
+            break;
+        }
+        flushes++;
+        flushBytes += bytes;
+        installedCv.notify_all();
+        compactCv.notify_one();
+    }
+}
+
+size_t LSMTree::levelTargetBytes(size_t level) const {
+    size_t target = options.level1Bytes;
+    for (size_t i = 1; i < level; i++) target *= options.levelRatio;
+    return target;
+}
+
+// 🛠️ Level 0 compacts by run count (its runs overlap); deeper levels by size
+bool LSMTree::pickCompaction(const Version& current, size_t& level) const {
+    if (!current.levels.empty() && current.levels[0].size() >= options.level0Runs) {
+        level = 0;
+        return true;
+    }
+    for (size_t i = 1; i < current.levels.size(); i++) {
+        uint64_t bytes = 0;
+        for (const auto& run : current.levels[i]) bytes += run->fileBytes();
+        if (bytes > levelTargetBytes(i)) {
+            level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 🛠️ Compactor thread: merge levels down whenever the shape calls for it
+void LSMTree::compactorLoop() {
+    while (true) {
+        size_t level = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            compactCv.wait(lock, [&] { return stopping || pickCompaction(*version, level); });
+            if (stopping) break;
+        }
+        if (!compact(level)) {
+            // Like a failed flush, this leaves the tree read-only rather than half-compacted
+            std::cerr << "Error compacting LSM level " << level << std::endl;
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            failed = true;
+            installedCv.notify_all();
+            break;
+        }
+    }
+}
+
+// 🛠️ Merge every run of `level` with the next level into a single run there.
+// Tombstones are dropped once nothing older could still hold the key.
+bool LSMTree::compact(size_t level) {
+    std::shared_ptr<const Version> current;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        current = version;
+    }
+    size_t target = level + 1;
+    std::vector<std::shared_ptr<SortedRun>> inputs = current->levels[level];
+    if (target < current->levels.size()) {
+        inputs.insert(inputs.end(), current->levels[target].begin(), current->levels[target].end());
+    }
+    bool bottom = true;
+    for (size_t i = target + 1; i < current->levels.size(); i++) {
+        if (!current->levels[i].empty()) bottom = false;
+    }
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> install(installMutex);
+        id = nextRunId++;
+    }
+    SortedRunWriter writer(runPath(id), options.bloomBitsPerKey);
+    if (!writer.open()) return false;
+
+    std::vector<MergeSource> sources;
+    for (const auto& run : inputs) {
+        MergeSource source;
+        source.run = run.get();
+        source.end = run->size();
+        sources.push_back(source);
+    }
+    mergeSources(sources, [&](std::string_view key, std::string_view value, bool tombstone) {
+        if (!(tombstone && bottom)) writer.add(key, value, tombstone);
+        return true;
+    });
+
+    std::shared_ptr<SortedRun> output;
+    uint64_t bytes = 0;
+    if (writer.size() > 0) {
+        if (!writer.finish(bytes)) return false;
+        output = SortedRun::open(runPath(id), id);
+        if (!output) return false;
+    }
+
+    std::lock_guard<std::mutex> install(installMutex);
+    // Flushes may have added level-0 runs meanwhile; only the inputs are replaced
+    Version next = *version;
+    if (next.levels.size() <= target) next.levels.resize(target + 1);
+    for (size_t i : {level, target}) {
+        auto& runs = next.levels[i];
+        runs.erase(std::remove_if(runs.begin(), runs.end(), [&](const auto& run) {
+            return std::find(inputs.begin(), inputs.end(), run) != inputs.end();
+        }), runs.end());
+    }
+    if (output) next.levels[target].push_back(output);
+    while (!next.levels.empty() && next.levels.back().empty()) next.levels.pop_back();
+    if (!writeManifest(next)) return false;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        version = std::make_shared<const Version>(std::move(next));
+    }
+    for (const auto& run : inputs) run->markObsolete();  // Deleted once no reader holds them
+
+    compactions++;
+    compactionBytes += bytes;
+    installedCv.notify_all();
+    return true;
+}
+
+// 🛠️ Wait until the flusher and compactor have nothing left to do
+void LSMTree::waitForCompactions() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    size_t level;
+    installedCv.wait(lock, [&] {
+        return failed || stopping || (!immutable && !pickCompaction(*version, level));
+    });
+}
+
+StorageEngineStats LSMTree::stats() const {
+    StorageEngineStats stats;
+    stats.name = "lsm";
+    stats.userBytes = userBytes;
+    stats.logBytes = logBytes;
+    stats.flushBytes = flushBytes;
+    stats.compactionBytes = compactionBytes;
+    stats.flushes = flushes;
+    stats.compactions = compactions;
+    stats.bloomNegatives = bloomNegatives;
+    stats.runProbes = runProbes;
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    stats.memtableBytes = activeBytes;
+    for (const auto& level : version->levels) {
+        stats.runsPerLevel.push_back(level.size());
+        uint64_t bytes = 0;
+        for (const auto& run : level) bytes += run->fileBytes();
+        stats.bytesPerLevel.push_back(bytes);
+    }
+    return stats;
+}
@@ -0,0 +1,207 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ParallelBFS.h"
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr size_t PARALLEL_MIN_NODES = 1 << 15;  // Smaller graphs aren't worth waking threads for
+constexpr size_t TOP_DOWN_CHUNK = 256;          // Frontier nodes a worker claims at a time
+constexpr size_t BOTTOM_UP_CHUNK = 4096;        // Nodes a worker claims at a time; whole bitmap words
+// Direction switching thresholds from Beamer et al.: go bottom-up once the frontier's
+// edges exceed 1/ALPHA of the unexplored edges, and back top-down once the frontier
+// shrinks below 1/BETA of the nodes
+constexpr uint64_t ALPHA = 14;
+constexpr uint64_t BETA = 24;
+
+// Reusable barrier for a fixed number of threads
+class Barrier {
+private:
+    std::mutex mutex;
+    std::condition_variable arrived;
+    size_t count;
+    size_t waiting = 0;
+    uint64_t generation = 0;
+
+public:
+    explicit Barrier(size_t count) : count(count) {}
+
+    void wait() {
+        if (count == 1) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t current = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            generation++;
+            arrived.notify_all();
+        } else {
+            arrived.wait(lock, [&] { return generation != current; });
+        }
+    }
+};
+
+// NodeBitset with atomic words, so workers can claim nodes concurrently
+class AtomicBitmap {
+private:
+    std::vector<std::atomic<uint64_t>> words;
+
+public:
+    explicit AtomicBitmap(size_t nodes) : words((nodes + 63) / 64) {
+        clear();
+    }
+
+    bool test(NodeId id) const {
+        return words[id >> 6].load(std::memory_order_relaxed) >> (id & 63) & 1;
+    }
+    void set(NodeId id) {
+        words[id >> 6].fetch_or(uint64_t(1) << (id & 63), std::memory_order_relaxed);
+    }
+    bool claim(NodeId id) {  // True if this call set the bit
+        uint64_t bit = uint64_t(1) << (id & 63);
+        return !(words[id >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+    }
+    uint64_t word(size_t index) const { return words[index].load(std::memory_order_relaxed); }
+    void clear() {
+        for (auto& word : words) word.store(0, std::memory_order_relaxed);
+    }
+};
+
+// One worker's share of a level
+struct WorkerState {
+    std::vector<NodeId> next;  // Nodes this worker reached
+    uint64_t nextEdges = 0;    // Their out-degrees summed
+};
+
+}  // namespace
+
+// 🛠️ Direction-optimizing BFS. Each level runs in three phases between barriers:
+// workers expand the frontier into their own buffers; thread 0 sizes the next level
+// and picks its direction; workers copy their buffers into place in `order`.
+BfsResult parallelBfs(const Graph& graph, const Graph& reverse, NodeId start, const BfsOptions& options) {
+    size_t nodes = graph.nodeCount();
+    BfsResult result;
+    result.order.reserve(nodes);
+    result.order.push_back(start);
+    result.levelOffsets = {0, 1};
+    if (options.parents) {
+        result.parents.assign(nodes, Graph::NONE);
+        result.parents[start] = start;
+    }
+    if (options.maxDepth == 0) return result;
+
+    size_t workers = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    if (nodes < PARALLEL_MIN_NODES) workers = 1;
+
+    AtomicBitmap visited(nodes);
+    AtomicBitmap frontierBits(nodes);  // The current level, while expanding bottom-up
+    visited.set(start);
+    std::vector<WorkerState> states(workers);
+    Barrier barrier(workers);
+    std::atomic<size_t> nextChunk{0};
+
+    // Level state, written by thread 0 between barriers
+    size_t begin = 0;
+    size_t end = 1;
+    uint32_t depth = 0;
+    bool bottomUp = false;
+    bool done = false;
+    uint64_t frontierEdges = graph.degree(start);
+    uint64_t unexploredEdges = graph.edgeCount() - frontierEdges;
+    std::vector<size_t> copyOffsets(workers);
+
+    auto topDownStep = [&](WorkerState& state) {
+        size_t size = end - begin;
+        for (size_t chunk; (chunk = nextChunk.fetch_add(TOP_DOWN_CHUNK)) < size;) {
+            for (size_t i = begin + chunk, last = begin + std::min(size, chunk + TOP_DOWN_CHUNK); i < last; i++) {
+                NodeId u = result.order[i];
+                const NodeId* row = graph.targetsOf(u);
+                for (size_t e = 0, n = graph.degree(u); e < n; e++) {
+                    NodeId v = row[e];
+                    if (visited.test(v) || !visited.claim(v)) continue;
+                    if (options.parents) result.parents[v] = u;
+                    state.next.push_back(v);
+                    state.nextEdges += graph.degree(v);
+                }
+            }
+        }
+    };
+
+    // Chunks cover whole bitmap words, so only this worker writes the visited bits of
+    // the nodes it checks
+    auto bottomUpStep = [&](WorkerState& state) {
+        for (size_t chunk; (chunk = nextChunk.fetch_add(BOTTOM_UP_CHUNK)) < nodes;) {
+            size_t last = std::min(nodes, chunk + BOTTOM_UP_CHUNK);
+            for (size_t v = chunk; v < last; v++) {
+                if ((v & 63) == 0 && visited.word(v >> 6) == ~uint64_t(0)) {
+                    v += 63;
+                    continue;
+                }
+                if (visited.test(static_cast<NodeId>(v))) continue;
+                const NodeId* row = reverse.targetsOf(static_cast<NodeId>(v));
+                for (size_t e = 0, n = reverse.degree(static_cast<NodeId>(v)); e < n; e++) {
+                    if (!frontierBits.test(row[e])) continue;
+                    visited.set(static_cast<NodeId>(v));
+                    if (options.parents) result.parents[v] = row[e];
+                    state.next.push_back(static_cast<NodeId>(v));
+                    state.nextEdges += graph.degree(static_cast<NodeId>(v));
+                    break;
+                }
+            }
+        }
+    };
+
+    // Thread 0 alone: size the next level and choose how to expand it
+    auto finishLevel = [&] {
+        if (bottomUp) result.bottomUpLevels++;
+        else result.topDownLevels++;
+        size_t total = 0;
+        uint64_t nextEdges = 0;
+        for (size_t t = 0; t < workers; t++) {
+            copyOffsets[t] = end + total;
+            total += states[t].next.size();
+            nextEdges += states[t].nextEdges;
+            states[t].nextEdges = 0;
+        }
+        size_t previousSize = end - begin;
+        begin = end;
+        end += total;
+        result.order.resize(end);
+        result.levelOffsets.push_back(end);
+        depth++;
+        done = total == 0 || depth >= options.maxDepth;
+        if (total == 0) result.levelOffsets.pop_back();
+
+        unexploredEdges -= std::min(unexploredEdges, nextEdges);
+        frontierEdges = nextEdges;
+        if (!bottomUp && frontierEdges > unexploredEdges / ALPHA) bottomUp = true;
+        else if (bottomUp && total < previousSize && total < nodes / BETA) bottomUp = false;
+        if (bottomUp && !done) frontierBits.clear();
+        nextChunk.store(0);
+    };
+
+    auto work = [&](size_t t) {
+        WorkerState& state = states[t];
+        while (true) {
+            if (bottomUp) bottomUpStep(state);
+            else topDownStep(state);
+            barrier.wait();
+            if (t == 0) finishLevel();
+            barrier.wait();
+            std::copy(state.next.begin(), state.next.end(), result.order.begin() + copyOffsets[t]);
+            if (bottomUp && !done) {
+                for (NodeId v : state.next) frontierBits.set(v);
+            }
+            state.next.clear();
+            if (done) return;
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workers; t++) threads.emplace_back(work, t);
+    work(0);
+    for (auto& thread : threads) thread.join();
+    return result;
+}
@@ -0,0 +1,426 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/PatternScan.h"
+#include <cctype>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// AVX2 is compiled per function and chosen at run time, so one binary runs anywhere
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PATTERN_SCAN_AVX2 1
+#endif
+
+namespace {
+
+constexpr size_t NPOS = std::string_view::npos;
+
+// Rough frequency rank of a byte in text values: higher is more common. Spaces,
+// lowercase letters (by English frequency) and digits are common; uppercase letters
+// less so, and punctuation and control bytes are rare.
+int byteRank(unsigned char c) {
+    static const char* common = " etaoinsrhldcumfpgwybvkxjqz";
+    if (const char* at = std::strchr(common, c); at && c) return 200 - int(at - common);
+    if (std::isdigit(c)) return 150;
+    if (std::isupper(c)) return 120;
+    if (c == '.' || c == ',' || c == '-' || c == '_' || c == ':' || c == '/' || c == '"') return 100;
+    return 50;
+}
+
+bool hasRegexSyntax(const std::string& pattern) {
+    return pattern.find_first_of("\\^$.|?*+()[]{}") != std::string::npos;
+}
+
+// Finish a search the SIMD loop stopped short of, where a full block no longer fits
+size_t findTail(std::string_view haystack, std::string_view needle, size_t from) {
+    return haystack.find(needle, from);
+}
+
+// Each kernel tests blocks of start positions [i, i + W), loading each block at the two
+// filter offsets. Both loads end before i + W + k - 1 <= n, so any start they flag has
+// room for the whole needle. The main loops take 64 positions per step and only
+// extract a bit mask when some position in it passed.
+#if defined(__SSE2__)
+inline uint32_t candidatesSSE2(const char* at, size_t rare, size_t other, __m128i rareByte, __m128i otherByte) {
+    __m128i atRare = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at + rare));
+    __m128i atOther = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at + other));
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(atRare, rareByte), _mm_cmpeq_epi8(atOther, otherByte))));
+}
+
+size_t findSSE2(std::string_view haystack, std::string_view needle, size_t rare, size_t other) {
+    const char* s = haystack.data();
+    size_t n = haystack.size();
+    size_t k = needle.size();
+    const __m128i rareByte = _mm_set1_epi8(needle[rare]);
+    const __m128i otherByte = _mm_set1_epi8(needle[other]);
+    size_t i = 0;
+    for (; i + k - 1 + 64 <= n; i += 64) {
+        uint64_t mask = candidatesSSE2(s + i, rare, other, rareByte, otherByte) |
+                        uint64_t(candidatesSSE2(s + i + 16, rare, other, rareByte, otherByte)) << 16 |
+                        uint64_t(candidatesSSE2(s + i + 32, rare, other, rareByte, otherByte)) << 32 |
+                        uint64_t(candidatesSSE2(s + i + 48, rare, other, rareByte, otherByte)) << 48;
+        for (; mask; mask &= mask - 1) {
+            size_t at = i + static_cast<size_t>(__builtin_ctzll(mask));
+            if (std::memcmp(s + at, needle.data(), k) == 0) return at;
+        }
+    }
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        for (uint32_t mask = candidatesSSE2(s + i, rare, other, rareByte, otherByte); mask; mask &= mask - 1) {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(s + at, needle.data(), k) == 0) return at;
+        }
+    }
+    return findTail(haystack, needle, i);
+}
+#endif
+
+#if defined(PATTERN_SCAN_AVX2)
+__attribute__((target("avx2")))
+inline __m256i candidatesAVX2(const char* at, size_t rare, size_t other, __m256i rareByte, __m256i otherByte) {
+    __m256i atRare = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at + rare));
+    __m256i atOther = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at + other));
+    return _mm256_and_si256(_mm256_cmpeq_epi8(atRare, rareByte), _mm256_cmpeq_epi8(atOther, otherByte));
+}
+
+__attribute__((target("avx2")))
+size_t findAVX2(std::string_view haystack, std::string_view needle, size_t rare, size_t other) {
+    const char* s = haystack.data();
+    size_t n = haystack.size();
+    size_t k = needle.size();
+    const __m256i rareByte = _mm256_set1_epi8(needle[rare]);
+    const __m256i otherByte = _mm256_set1_epi8(needle[other]);
+    size_t i = 0;
+    for (; i + k - 1 + 64 <= n; i += 64) {
+        __m256i low = candidatesAVX2(s + i, rare, other, rareByte, otherByte);
+        __m256i high = candidatesAVX2(s + i + 32, rare, other, rareByte, otherByte);
+        if (_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high))) continue;
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(low)) |
+                        uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32;
+        for (; mask; mask &= mask - 1) {
+            size_t at = i + static_cast<size_t>(__builtin_ctzll(mask));
+            if (std::memcmp(s + at, needle.data(), k) == 0) return at;
+        }
+    }
+    // Short values, and what is left of long ones, still get a vector pass
+    if (i + k - 1 + 16 <= n) {
+        size_t found = findSSE2(haystack.substr(i), needle, rare, other);
+        return found == NPOS ? NPOS : i + found;
+    }
+    return findTail(haystack, needle, i);
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+size_t findNEON(std::string_view haystack, std::string_view needle, size_t rare, size_t other) {
+    const char* s = haystack.data();
+    size_t n = haystack.size();
+    size_t k = needle.size();
+    const uint8x16_t rareByte = vdupq_n_u8(static_cast<uint8_t>(needle[rare]));
+    const uint8x16_t otherByte = vdupq_n_u8(static_cast<uint8_t>(needle[other]));
+    size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        uint8x16_t atRare = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i + rare));
+        uint8x16_t atOther = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i + other));
+        uint8x16_t both = vandq_u8(vceqq_u8(atRare, rareByte), vceqq_u8(atOther, otherByte));
+        // Narrow each lane to 4 bits: lane j of the block is nibble j of the mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(both), 4)), 0);
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctzll(mask)) / 4;
+            if (std::memcmp(s + i + bit, needle.data(), k) == 0) return i + bit;
+            mask &= ~(uint64_t(0xF) << (bit * 4));
+        }
+    }
+    return findTail(haystack, needle, i);
+}
+#endif
+
+}  // namespace
+
+bool searchKernelSupported(SearchKernel kernel) {
+    switch (kernel) {
+        case SearchKernel::SCALAR:
+            return true;
+        case SearchKernel::SSE2:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case SearchKernel::AVX2:
+#if defined(PATTERN_SCAN_AVX2)
+        {
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            return avx2;
+        }
+#else
+            return false;
+#endif
+        case SearchKernel::NEON:
+#if defined(__ARM_NEON) && defined(__aarch64__)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+SearchKernel bestSearchKernel() {
+    static const SearchKernel best = [] {
+        for (SearchKernel kernel : {SearchKernel::AVX2, SearchKernel::SSE2, SearchKernel::NEON}) {
+            if (searchKernelSupported(kernel)) return kernel;
+        }
+        return SearchKernel::SCALAR;
+    }();
+    return best;
+}
+
+const char* searchKernelName(SearchKernel kernel) {
+    switch (kernel) {
+        case SearchKernel::SCALAR: return "scalar";
+        case SearchKernel::SSE2: return "sse2";
+        case SearchKernel::AVX2: return "avx2";
+        case SearchKernel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+// 🛠️ Pick the filter bytes: the needle's rarest byte and its last one. (The two
+// rarest often sit in a shared stem, e.g. "example." of .com and .org, and pass together.)
+SubstringSearcher::SubstringSearcher(std::string needle, SearchKernel kernel)
+    : text(std::move(needle)), rare(0), other(0),
+      searchKernel(searchKernelSupported(kernel) ? kernel : SearchKernel::SCALAR) {
+    if (text.size() < 2) return;
+    other = text.size() - 1;
+    for (size_t i = 1; i < other; i++) {
+        if (byteRank(static_cast<unsigned char>(text[i])) < byteRank(static_cast<unsigned char>(text[rare]))) rare = i;
+    }
+}
+
+size_t SubstringSearcher::find(std::string_view haystack) const {
+    size_t k = text.size();
+    if (k == 0) return 0;
+    if (k > haystack.size()) return NPOS;
+    if (k == 1) {
+        const void* hit = std::memchr(haystack.data(), text[0], haystack.size());
+        return hit ? static_cast<size_t>(static_cast<const char*>(hit) - haystack.data()) : NPOS;
+    }
+
+    switch (searchKernel) {
+#if defined(PATTERN_SCAN_AVX2)
+        case SearchKernel::AVX2:
+            return findAVX2(haystack, text, rare, other);
+#endif
+#if defined(__SSE2__)
+        case SearchKernel::SSE2:
+            return findSSE2(haystack, text, rare, other);
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        case SearchKernel::NEON:
+            return findNEON(haystack, text, rare, other);
+#endif
+        default:
+            return haystack.find(text);
+    }
+}
+
+size_t findSubstring(std::string_view haystack, std::string_view needle) {
+    return SubstringSearcher(std::string(needle)).find(haystack);
+}
+
+ValuePattern::ValuePattern(const std::string& pattern)
+    : pattern(pattern),
+      literal(hasRegexSyntax(pattern) ? extractRequiredLiteral(pattern) : pattern),
+      literalOnly(!hasRegexSyntax(pattern)) {
+    if (!literalOnly) regex = std::make_unique<std::regex>(pattern, std::regex::ECMAScript | std::regex::optimize);
+}
+
+bool ValuePattern::matches(std::string_view text) const {
+    if (!literal.needle().empty() && literal.find(text) == NPOS) return false;
+    return literalOnly || std::regex_search(text.data(), text.data() + text.size(), *regex);
+}
+
+std::string ValuePattern::describe() const {
+    std::string how = searchKernelName(literal.kernel());
+    if (literalOnly) return "literal search for '" + literal.needle() + "' (" + how + ")";
+    if (literal.needle().empty()) return "regex, no required literal to prefilter on";
+    return "regex, prefiltered on '" + literal.needle() + "' (" + how + ")";
+}
+
+// 🛠️ Walk the regex once, collecting runs of bytes that must appear in order. An atom
+// that is not a plain byte ends the run; a quantifier that allows zero repeats also
+// takes the byte before it out of the run.
+std::string ValuePattern::extractRequiredLiteral(const std::string& p) {
+    // Skip a bracketed class or a group starting at p[i]; returns the index of its end
+    auto skipClass = [&](size_t i) {
+        for (i++; i < p.size() && p[i] != ']'; i++) {
+            if (p[i] == '\\') i++;
+        }
+        return i;
+    };
+    auto skipGroup = [&](size_t i) {
+        int depth = 0;
+        for (; i < p.size(); i++) {
+            if (p[i] == '\\') {
+                i++;
+            } else if (p[i] == '[') {
+                i = skipClass(i);
+            } else if (p[i] == '(') {
+                depth++;
+            } else if (p[i] == ')' && --depth == 0) {
+                break;
+            }
+        }
+        return i;
+    };
+
+    // With top-level alternation no one literal is required
+    for (size_t i = 0; i < p.size(); i++) {
+        if (p[i] == '\\') {
+            i++;
+        } else if (p[i] == '[') {
+            i = skipClass(i);
+        } else if (p[i] == '(') {
+            i = skipGroup(i);
+        } else if (p[i] == '|') {
+            return std::string();
+        }
+    }
+
+    std::string best, run;
+    bool lastIsLiteral = false;  // run's last byte is the atom just read
+    auto flush = [&] {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+        lastIsLiteral = false;
+    };
+    auto dropLast = [&] {
+        if (lastIsLiteral && !run.empty()) run.pop_back();
+    };
+    auto skipLazy = [&](size_t& i) {
+        if (i + 1 < p.size() && p[i + 1] == '?') i++;
+    };
+
+    for (size_t i = 0; i < p.size(); i++) {
+        char c = p[i];
+        switch (c) {
+            case '\\': {
+                if (i + 1 >= p.size()) {
+                    flush();
+                    break;
+                }
+                char d = p[++i];
+                char byte = d;
+                if (d == 'n') byte = '\n';
+                else if (d == 't') byte = '\t';
+                else if (d == 'r') byte = '\r';
+                else if (d == 'f') byte = '\f';
+                else if (d == 'v') byte = '\v';
+                else if (std::isalnum(static_cast<unsigned char>(d))) {
+                    // A class (\d, \w), an assertion (\b), a backreference or a code escape
+                    flush();
+                    if (d == 'x') i += 2;
+                    else if (d == 'u') i += 4;
+                    else if (d == 'c') i += 1;
+                    break;
+                }
+                run += byte;
+                lastIsLiteral = true;
+                break;
+            }
+            case '[':
+                i = skipClass(i);
+                flush();
+                break;
+            case '(':
+                i = skipGroup(i);
+                flush();
+                break;
+            case '*':
+            case '?':
+                dropLast();
+                flush();
+                skipLazy(i);
+                break;
+            case '+':
+                flush();
+                skipLazy(i);
+                break;
+            case '{': {
+                size_t j = i + 1;
+                while (j < p.size() && std::isdigit(static_cast<unsigned char>(p[j]))) j++;
+                if (j == i + 1 || std::stoul(p.substr(i + 1, j - i - 1)) == 0) dropLast();
+                flush();
+                size_t close = p.find('}', i);
+                if (close != std::string::npos) i = close;
+                skipLazy(i);
+                break;
+            }
+            case '.':
+            case '^':
+            case '$':
+            case '|':
+            case ')':
+            case ']':
+            case '}':
+                flush();
+                break;
+            default:
+                run += c;
+                lastIsLiteral = true;
+                break;
+        }
+    }
+    flush();
+    return best;
+}
+
+PatternCache::PatternCache(size_t capacity) : capacity(capacity ? capacity : 1), hits(0), misses(0) {}
+
+PatternCache& PatternCache::instance() {
+    static PatternCache cache;
+    return cache;
+}
+
+// 🛠️ Look a pattern up, compiling it outside the lock on a miss
+std::shared_ptr<const ValuePattern> PatternCache::get(const std::string& pattern) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = byPattern.find(pattern);
+        if (found != byPattern.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            hits++;
+            return found->second->second;
+        }
+        misses++;
+    }
+
+    auto compiled = std::make_shared<const ValuePattern>(pattern);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = byPattern.find(pattern);
+    if (found != byPattern.end()) return found->second->second;  // Compiled by another thread meanwhile
+    entries.emplace_front(pattern, compiled);
+    byPattern.emplace(pattern, entries.begin());
+    while (entries.size() > capacity) {
+        byPattern.erase(entries.back().first);
+        entries.pop_back();
+    }
+    return compiled;
+}
+
+size_t PatternCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+uint64_t PatternCache::hitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+uint64_t PatternCache::missCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
@@ -0,0 +1,284 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Query.h"
+#include <cctype>
+#include <utility>
+
+namespace {
+
+// 🛠️ Append `children` to a new AND/OR node, splicing in children of the same kind
+Query combine(Query::Kind kind, std::vector<Query> children) {
+    Query node;
+    node.kind = kind;
+    for (auto& child : children) {
+        if (child.kind == kind) {
+            for (auto& grandchild : child.children) node.children.push_back(std::move(grandchild));
+        } else {
+            node.children.push_back(std::move(child));
+        }
+    }
+    return node;
+}
+
+// 🛠️ An argument as parse() reads it back: bare if that round-trips, else quoted
+// (`stop` as in Parser::parseArgument)
+std::string quoteIfNeeded(const std::string& text, char stop = 0) {
+    bool bare = !text.empty() && text != "*";
+    int depth = 0;
+    for (size_t i = 0; i < text.size() && bare; i++) {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)) || c == '"' || c == '\\') bare = false;
+        if (c == '(') depth++;
+        if (c == ')' && --depth < 0) bare = false;
+        if (stop == '.' && c == '.' && i + 1 < text.size() && text[i + 1] == '.') bare = false;
+        if (stop == '=' && c == '=') bare = false;
+    }
+    if (depth != 0) bare = false;
+    if (bare) return text;
+
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+// Recursive-descent parser over the query text
+class Parser {
+public:
+    explicit Parser(const std::string& text) : text(text) {}
+
+    bool parse(Query& query, std::string& error) {
+        if (!parseOr(query)) {
+            error = message;
+            return false;
+        }
+        skipSpace();
+        if (pos < text.size()) {
+            error = "unexpected '" + text.substr(pos, 16) + "' at offset " + std::to_string(pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const std::string& text;
+    size_t pos = 0;
+    std::string message;
+
+    bool fail(const std::string& what) {
+        if (message.empty()) message = what + " at offset " + std::to_string(pos);
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    // Consume an operator word (AND, OR, in any case) or its symbol (&&, ||)
+    bool takeOperator(const char* word, const char* symbol) {
+        skipSpace();
+        if (text.compare(pos, 2, symbol) == 0) {
+            pos += 2;
+            return true;
+        }
+        size_t n = std::char_traits<char>::length(word);
+        if (pos + n > text.size()) return false;
+        for (size_t i = 0; i < n; i++) {
+            if (std::toupper(static_cast<unsigned char>(text[pos + i])) != word[i]) return false;
+        }
+        if (pos + n < text.size() && !std::isspace(static_cast<unsigned char>(text[pos + n])) &&
+            text[pos + n] != '(') {
+            return false;
+        }
+        pos += n;
+        return true;
+    }
+
+    bool parseOr(Query& query) {
+        std::vector<Query> terms(1);
+        if (!parseAnd(terms.back())) return false;
+        while (takeOperator("OR", "||")) {
+            terms.emplace_back();
+            if (!parseAnd(terms.back())) return false;
+        }
+        query = terms.size() == 1 ? std::move(terms[0]) : combine(Query::Kind::OR, std::move(terms));
+        return true;
+    }
+
+    bool parseAnd(Query& query) {
+        std::vector<Query> terms(1);
+        if (!parsePrimary(terms.back())) return false;
+        while (takeOperator("AND", "&&")) {
+            terms.emplace_back();
+            if (!parsePrimary(terms.back())) return false;
+        }
+        query = terms.size() == 1 ? std::move(terms[0]) : combine(Query::Kind::AND, std::move(terms));
+        return true;
+    }
+
+    bool parsePrimary(Query& query) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == '(') {
+            pos++;
+            if (!parseOr(query)) return false;
+            skipSpace();
+            if (pos >= text.size() || text[pos] != ')') return fail("expected ')'");
+            pos++;
+            return true;
+        }
+
+        size_t colon = text.find(':', pos);
+        if (colon == std::string::npos) return fail("expected a term like prefix:P");
+        std::string kind = text.substr(pos, colon - pos);
+        pos = colon + 1;
+
+        std::string a, b;
+        if (kind == "prefix") {
+            if (!parseArgument(a, 0)) return false;
+            query = Query::keyPrefix(a);
+        } else if (kind == "range") {
+            if (!parseArgument(a, '.')) return false;
+            if (text.compare(pos, 2, "..") != 0) return fail("expected '..' in range");
+            pos += 2;
+            if (!parseArgument(b, 0)) return false;
+            if (b == "*" && text[pos - 1] == '*') b.clear();  // A bare * is unbounded, a quoted one a key
+            query = Query::keyRange(a, b);
+        } else if (kind == "value") {
+            if (!parseArgument(a, 0)) return false;
+            query = Query::valueEquals(a);
+        } else if (kind == "regex") {
+            if (!parseArgument(a, 0)) return false;
+            query = Query::valueMatches(a);
+        } else if (kind == "index") {
+            if (!parseArgument(a, '=')) return false;
+            if (pos >= text.size() || text[pos] != '=') return fail("expected '=' in index term");
+            pos++;
+            if (!parseArgument(b, 0)) return false;
+            query = Query::indexEquals(a, b);
+        } else {
+            return fail("unknown term '" + kind + "'");
+        }
+        return true;
+    }
+
+    // A quoted argument, or a bare one running to whitespace, an unbalanced ')' or
+    // `stop` ('.' stops at "..", '=' at the first '=')
+    bool parseArgument(std::string& out, char stop) {
+        if (pos < text.size() && text[pos] == '"') {
+            for (pos++; pos < text.size() && text[pos] != '"'; pos++) {
+                if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+                out += text[pos];
+            }
+            if (pos >= text.size()) return fail("unterminated quote");
+            pos++;
+            return true;
+        }
+
+        int depth = 0;
+        size_t start = pos;
+        for (; pos < text.size(); pos++) {
+            char c = text[pos];
+            if (std::isspace(static_cast<unsigned char>(c))) break;
+            if (c == ')' && depth == 0) break;
+            if (stop == '.' && c == '.' && text.compare(pos, 2, "..") == 0) break;
+            if (stop == '=' && c == '=') break;
+            if (c == '(') depth++;
+            if (c == ')') depth--;
+        }
+        out = text.substr(start, pos - start);
+        if (out.empty() && stop != '.') return fail("expected an argument");
+        return true;
+    }
+};
+
+}  // namespace
+
+Query Query::keyPrefix(const std::string& prefix) {
+    Query query;
+    query.kind = Kind::KEY_PREFIX;
+    query.first = prefix;
+    return query;
+}
+
+Query Query::keyRange(const std::string& lo, const std::string& hi) {
+    Query query;
+    query.kind = Kind::KEY_RANGE;
+    query.first = lo;
+    query.second = hi;
+    return query;
+}
+
+Query Query::valueEquals(const std::string& value) {
+    Query query;
+    query.kind = Kind::VALUE_EQUALS;
+    query.first = value;
+    return query;
+}
+
+Query Query::valueMatches(const std::string& pattern) {
+    Query query;
+    query.kind = Kind::VALUE_REGEX;
+    query.first = pattern;
+    return query;
+}
+
+Query Query::indexEquals(const std::string& indexName, const std::string& value) {
+    Query query;
+    query.kind = Kind::INDEX_EQUALS;
+    query.first = indexName;
+    query.second = value;
+    return query;
+}
+
+Query Query::allOf(std::vector<Query> children) {
+    return combine(Kind::AND, std::move(children));
+}
+
+Query Query::anyOf(std::vector<Query> children) {
+    return combine(Kind::OR, std::move(children));
+}
+
+Query operator&&(Query a, Query b) {
+    std::vector<Query> children;
+    children.push_back(std::move(a));
+    children.push_back(std::move(b));
+    return Query::allOf(std::move(children));
+}
+
+Query operator||(Query a, Query b) {
+    std::vector<Query> children;
+    children.push_back(std::move(a));
+    children.push_back(std::move(b));
+    return Query::anyOf(std::move(children));
+}
+
+// 🛠️ Print the query so that parse() gives it back; ORs under an AND are parenthesized
+std::string Query::toString() const {
+    switch (kind) {
+        case Kind::KEY_PREFIX:
+            return "prefix:" + quoteIfNeeded(first);
+        case Kind::KEY_RANGE:
+            return "range:" + quoteIfNeeded(first, '.') + ".." + (second.empty() ? "*" : quoteIfNeeded(second));
+        case Kind::VALUE_EQUALS:
+            return "value:" + quoteIfNeeded(first);
+        case Kind::VALUE_REGEX:
+            return "regex:" + quoteIfNeeded(first);
+        case Kind::INDEX_EQUALS:
+            return "index:" + quoteIfNeeded(first, '=') + "=" + quoteIfNeeded(second);
+        case Kind::AND:
+        case Kind::OR: {
+            std::string text;
+            for (size_t i = 0; i < children.size(); i++) {
+                if (i) text += kind == Kind::AND ? " AND " : " OR ";
+                bool group = kind == Kind::AND && children[i].kind == Kind::OR;
+                text += group ? "(" + children[i].toString() + ")" : children[i].toString();
+            }
+            return text;
+        }
+    }
+    return std::string();
+}
+
+bool Query::parse(const std::string& text, Query& query, std::string& error) {
+    return Parser(text).parse(query, error);
+}
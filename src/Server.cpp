@@ -10,6 +10,7 @@
 
 int main() {
     Database db("data/mydb.json");
+    db.enableBlobStore();
     db.load();
     VersionControl vc(db, "RemoteUser");
 
@@ -43,6 +44,15 @@ int main() {
             vc.commit(message);
             std::cout << "[Server] Commit received: " << message << std::endl;  // Log received commit
             send(new_socket, "Commit received", strlen("Commit received"), 0);
+        } else if (command == "get") {
+            // Large values go from the blob file to the socket without a user-space copy
+            uint64_t offset, length;
+            if (db.locateBlob(message, offset, length)) {
+                db.getBlobStore()->sendTo(new_socket, offset, length);
+            } else {
+                std::string value = db.get(message);
+                send(new_socket, value.data(), value.size(), 0);
+            }
         } else {
             send(new_socket, "Invalid command", strlen("Invalid command"), 0);
         }
@@ -0,0 +1,279 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ShortestPath.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Monotone priority queue: every key pushed must be at least the last key popped.
+// Bucket i > 0 holds keys whose highest bit differing from `last` is bit i - 1, and
+// bucket 0 keys equal to `last`. When bucket 0 runs dry, the lowest non-empty bucket
+// is spread over the buckets below it around its minimum, so each entry moves down at
+// most 64 times over its life.
+template <typename Value>
+class RadixHeap {
+private:
+    std::vector<std::pair<uint64_t, Value>> buckets[65];
+    uint64_t last = 0;
+    size_t count = 0;
+
+    static size_t bucketFor(uint64_t key, uint64_t last) {
+        return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+    }
+
+    void refill() {
+        if (!buckets[0].empty()) return;
+        size_t i = 1;
+        while (buckets[i].empty()) i++;
+        uint64_t lowest = UINT64_MAX;
+        for (const auto& entry : buckets[i]) lowest = std::min(lowest, entry.first);
+        last = lowest;
+        for (const auto& entry : buckets[i]) buckets[bucketFor(entry.first, last)].push_back(entry);
+        buckets[i].clear();
+    }
+
+public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push(uint64_t key, Value value) {
+        buckets[bucketFor(key, last)].emplace_back(key, value);
+        count++;
+    }
+
+    uint64_t topKey() {
+        refill();
+        return last;
+    }
+
+    std::pair<uint64_t, Value> pop() {
+        refill();
+        auto entry = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return entry;
+    }
+};
+
+// 4-ary min-heap; keys may arrive in any order
+template <typename Value>
+class DaryHeap {
+private:
+    static constexpr size_t ARITY = 4;
+    std::vector<std::pair<uint64_t, Value>> heap;
+
+public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    uint64_t topKey() const { return heap.front().first; }
+
+    void push(uint64_t key, Value value) {
+        size_t at = heap.size();
+        heap.emplace_back();
+        while (at > 0 && heap[(at - 1) / ARITY].first > key) {
+            heap[at] = heap[(at - 1) / ARITY];
+            at = (at - 1) / ARITY;
+        }
+        heap[at] = {key, value};
+    }
+
+    std::pair<uint64_t, Value> pop() {
+        auto top = heap.front();
+        auto moved = heap.back();
+        heap.pop_back();
+        size_t n = heap.size();
+        if (n == 0) return top;
+        size_t at = 0;
+        while (true) {
+            size_t first = at * ARITY + 1;
+            if (first >= n) break;
+            size_t best = first;
+            for (size_t child = first + 1; child < std::min(first + ARITY, n); child++) {
+                if (heap[child].first < heap[best].first) best = child;
+            }
+            if (heap[best].first >= moved.first) break;
+            heap[at] = heap[best];
+            at = best;
+        }
+        heap[at] = moved;
+        return top;
+    }
+};
+
+// 🛠️ Walk parent links back from `to` and return the path in order
+std::vector<NodeId> tracePath(const std::vector<NodeId>& parent, NodeId from, NodeId to) {
+    std::vector<NodeId> path{to};
+    while (path.back() != from) path.push_back(parent[path.back()]);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// 🛠️ Dijkstra from `source`, stopping early once `target` (if not NONE) is settled.
+// Entries left behind by a later improvement are skipped when popped.
+template <typename Heap>
+size_t runDijkstra(const Graph& graph, NodeId source, NodeId target, std::vector<uint64_t>& dist,
+                   std::vector<NodeId>* parent) {
+    Heap queue;
+    size_t settled = 0;
+    dist[source] = 0;
+    queue.push(0, source);
+    while (!queue.empty()) {
+        auto [d, u] = queue.pop();
+        if (d != dist[u]) continue;
+        settled++;
+        if (u == target) break;
+        const NodeId* row = graph.targetsOf(u);
+        const int* rowWeights = graph.weightsOf(u);
+        for (size_t i = 0, n = graph.degree(u); i < n; i++) {
+            uint64_t next = d + static_cast<uint64_t>(rowWeights[i]);
+            if (next < dist[row[i]]) {
+                dist[row[i]] = next;
+                if (parent) (*parent)[row[i]] = u;
+                queue.push(next, row[i]);
+            }
+        }
+    }
+    return settled;
+}
+
+}  // namespace
+
+// 🛠️ Distances from `source` to every node
+std::vector<uint64_t> shortestDistances(const Graph& graph, NodeId source, PathHeap heap) {
+    std::vector<uint64_t> dist(graph.nodeCount(), UNREACHABLE);
+    if (heap == PathHeap::RADIX) runDijkstra<RadixHeap<NodeId>>(graph, source, Graph::NONE, dist, nullptr);
+    else runDijkstra<DaryHeap<NodeId>>(graph, source, Graph::NONE, dist, nullptr);
+    return dist;
+}
+
+// 🛠️ One shortest path, by plain Dijkstra
+PathResult dijkstraPath(const Graph& graph, NodeId from, NodeId to, PathHeap heap) {
+    PathResult result;
+    std::vector<uint64_t> dist(graph.nodeCount(), UNREACHABLE);
+    std::vector<NodeId> parent(graph.nodeCount(), Graph::NONE);
+    if (heap == PathHeap::RADIX) result.settled = runDijkstra<RadixHeap<NodeId>>(graph, from, to, dist, &parent);
+    else result.settled = runDijkstra<DaryHeap<NodeId>>(graph, from, to, dist, &parent);
+    if (dist[to] != UNREACHABLE) {
+        result.found = true;
+        result.distance = dist[to];
+        result.nodes = tracePath(parent, from, to);
+    }
+    return result;
+}
+
+// 🛠️ One shortest path, searching from both ends. `best` is the shortest from-to
+// distance through any node both searches have reached; once the queue minimums sum
+// to at least that, no unsettled node can lie on a shorter path.
+PathResult bidirectionalPath(const Graph& graph, const Graph& reverse, NodeId from, NodeId to) {
+    PathResult result;
+    if (from == to) {
+        result.found = true;
+        result.distance = 0;
+        result.nodes = {from};
+        return result;
+    }
+
+    struct Side {
+        const Graph* graph;
+        std::vector<uint64_t> dist;
+        std::vector<NodeId> parent;
+        RadixHeap<NodeId> queue;
+    };
+    size_t nodes = std::max(graph.nodeCount(), reverse.nodeCount());
+    Side forward{&graph, std::vector<uint64_t>(nodes, UNREACHABLE), std::vector<NodeId>(nodes, Graph::NONE), {}};
+    Side backward{&reverse, std::vector<uint64_t>(nodes, UNREACHABLE), std::vector<NodeId>(nodes, Graph::NONE), {}};
+    forward.dist[from] = 0;
+    forward.queue.push(0, from);
+    backward.dist[to] = 0;
+    backward.queue.push(0, to);
+
+    uint64_t best = UNREACHABLE;
+    NodeId meet = Graph::NONE;
+    while (!forward.queue.empty() && !backward.queue.empty()) {
+        if (forward.queue.topKey() + backward.queue.topKey() >= best) break;
+        bool goForward = forward.queue.size() <= backward.queue.size();
+        Side& side = goForward ? forward : backward;
+        const Side& other = goForward ? backward : forward;
+
+        auto [d, u] = side.queue.pop();
+        if (d != side.dist[u]) continue;
+        result.settled++;
+        const NodeId* row = side.graph->targetsOf(u);
+        const int* rowWeights = side.graph->weightsOf(u);
+        for (size_t i = 0, n = side.graph->degree(u); i < n; i++) {
+            NodeId v = row[i];
+            uint64_t next = d + static_cast<uint64_t>(rowWeights[i]);
+            if (next < side.dist[v]) {
+                side.dist[v] = next;
+                side.parent[v] = u;
+                side.queue.push(next, v);
+            }
+            if (other.dist[v] != UNREACHABLE && side.dist[v] + other.dist[v] < best) {
+                best = side.dist[v] + other.dist[v];
+                meet = v;
+            }
+        }
+    }
+
+    if (meet != Graph::NONE) {
+        result.found = true;
+        result.distance = best;
+        result.nodes = tracePath(forward.parent, from, meet);
+        for (NodeId at = meet; at != to;) {
+            at = backward.parent[at];
+            result.nodes.push_back(at);
+        }
+    }
+    return result;
+}
+
+// 🛠️ One shortest path, by A*. Without a closed set, a node reached more cheaply after
+// it was settled (possible when the heuristic isn't consistent) is simply queued again.
+PathResult astarPath(const Graph& graph, NodeId from, NodeId to, const PathHeuristic& heuristic) {
+    struct Label {  // A node's search state, read together on every relaxation
+        uint64_t dist = UNREACHABLE;
+        uint64_t queuedKey = UNREACHABLE;  // Key of the node's live entry
+        NodeId parent = Graph::NONE;
+    };
+    PathResult result;
+    std::vector<Label> labels(graph.nodeCount());
+    DaryHeap<NodeId> queue;
+
+    auto enqueue = [&](NodeId v, uint64_t d) {
+        uint64_t estimate = heuristic(v);
+        if (estimate == UNREACHABLE) return;
+        labels[v].queuedKey = d + estimate;
+        queue.push(d + estimate, v);
+    };
+    labels[from].dist = 0;
+    enqueue(from, 0);
+    while (!queue.empty()) {
+        auto [key, u] = queue.pop();
+        if (key != labels[u].queuedKey) continue;
+        labels[u].queuedKey = UNREACHABLE;
+        result.settled++;
+        if (u == to) {
+            result.found = true;
+            break;
+        }
+        const NodeId* row = graph.targetsOf(u);
+        const int* rowWeights = graph.weightsOf(u);
+        for (size_t i = 0, n = graph.degree(u); i < n; i++) {
+            uint64_t next = labels[u].dist + static_cast<uint64_t>(rowWeights[i]);
+            Label& label = labels[row[i]];
+            if (next < label.dist) {
+                label.dist = next;
+                label.parent = u;
+                enqueue(row[i], next);
+            }
+        }
+    }
+
+    if (result.found) {
+        result.distance = labels[to].dist;
+        std::vector<NodeId> nodes{to};
+        while (nodes.back() != from) nodes.push_back(labels[nodes.back()].parent);
+        std::reverse(nodes.begin(), nodes.end());
+        result.nodes = std::move(nodes);
+    }
+    return result;
+}
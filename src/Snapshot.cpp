@@ -0,0 +1,149 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Snapshot.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'V', 'D', 'B', 'S', 'N', 'A', 'P', '\0'};
+
+}  // namespace
+
+BinarySnapshot::BinarySnapshot()
+    : base(nullptr), length(0), header(nullptr), slots(nullptr) {}
+
+BinarySnapshot::~BinarySnapshot() {
+    if (base) munmap(const_cast<char*>(base), length);
+}
+
+// 🛠️ Check the magic bytes without mapping the file
+bool BinarySnapshot::isBinarySnapshot(const std::string& path) {
+    std::ifstream inFile(path, std::ios::binary);
+    char magic[8] = {0};
+    if (!inFile.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+// 🛠️ Map a snapshot file read-only and validate its section bounds
+std::unique_ptr<BinarySnapshot> BinarySnapshot::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return nullptr;
+
+    std::unique_ptr<BinarySnapshot> snapshot(new BinarySnapshot());
+    snapshot->base = static_cast<const char*>(mapped);
+    snapshot->length = st.st_size;
+    snapshot->header = reinterpret_cast<const SnapshotHeader*>(snapshot->base);
+
+    const SnapshotHeader& h = *snapshot->header;
+    uint64_t tableBytes = h.count * sizeof(SnapshotSlot);
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != FORMAT_VERSION || h.fileSize != snapshot->length ||
+        h.keyBlockOffset > h.offsetTableOffset ||
+        h.offsetTableOffset + tableBytes > h.valueHeapOffset ||
+        h.valueHeapOffset > snapshot->length ||
+        h.offsetTableOffset % alignof(SnapshotSlot) != 0) {
+        std::cerr << "Error loading snapshot " << path << ": bad header" << std::endl;
+        return nullptr;
+    }
+    snapshot->slots = reinterpret_cast<const SnapshotSlot*>(snapshot->base + h.offsetTableOffset);
+
+#ifdef MADV_RANDOM
+    // Point lookups jump around the value heap; don't waste readahead on it
+    madvise(const_cast<char*>(snapshot->base + h.valueHeapOffset),
+            snapshot->length - h.valueHeapOffset, MADV_RANDOM);
+#endif
+    return snapshot;
+}
+
+// 🛠️ Lay out header, key block, offset table and value heap
+std::string BinarySnapshot::serialize(
+    const std::vector<std::pair<std::string_view, std::string_view>>& sortedEntries) {
+    uint64_t keyBytes = 0;
+    uint64_t valueBytes = 0;
+    for (const auto& [key, value] : sortedEntries) {
+        keyBytes += key.size();
+        valueBytes += value.size();
+    }
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = FORMAT_VERSION;
+    h.count = sortedEntries.size();
+    h.keyBlockOffset = sizeof(SnapshotHeader);
+    uint64_t keyBlockEnd = h.keyBlockOffset + keyBytes;
+    h.offsetTableOffset = (keyBlockEnd + alignof(SnapshotSlot) - 1) / alignof(SnapshotSlot) * alignof(SnapshotSlot);
+    h.valueHeapOffset = h.offsetTableOffset + h.count * sizeof(SnapshotSlot);
+    h.fileSize = h.valueHeapOffset + valueBytes;
+
+    std::string image(h.fileSize, '\0');
+    std::memcpy(&image[0], &h, sizeof(h));
+
+    uint64_t keyOffset = 0;
+    uint64_t valueOffset = 0;
+    for (size_t i = 0; i < sortedEntries.size(); i++) {
+        const auto& [key, value] = sortedEntries[i];
+        SnapshotSlot slot{keyOffset, valueOffset,
+                          static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size())};
+        std::memcpy(&image[h.keyBlockOffset + keyOffset], key.data(), key.size());
+        std::memcpy(&image[h.offsetTableOffset + i * sizeof(SnapshotSlot)], &slot, sizeof(slot));
+        std::memcpy(&image[h.valueHeapOffset + valueOffset], value.data(), value.size());
+        keyOffset += key.size();
+        valueOffset += value.size();
+    }
+    return image;
+}
+
+size_t BinarySnapshot::size() const {
+    return header->count;
+}
+
+std::string_view BinarySnapshot::keyAt(size_t i) const {
+    const SnapshotSlot& slot = slots[i];
+    return std::string_view(base + header->keyBlockOffset + slot.keyOffset, slot.keyLength);
+}
+
+std::string_view BinarySnapshot::valueAt(size_t i) const {
+    const SnapshotSlot& slot = slots[i];
+    return std::string_view(base + header->valueHeapOffset + slot.valueOffset, slot.valueLength);
+}
+
+// 🛠️ Binary search over the offset table
+size_t BinarySnapshot::lowerBound(std::string_view key) const {
+    size_t lo = 0;
+    size_t hi = header->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool BinarySnapshot::find(std::string_view key, std::string_view& value) const {
+    size_t i = lowerBound(key);
+    if (i == header->count || keyAt(i) != key) return false;
+    value = valueAt(i);
+    return true;
+}
+
+bool BinarySnapshot::contains(std::string_view key) const {
+    size_t i = lowerBound(key);
+    return i < header->count && keyAt(i) == key;
+}
@@ -0,0 +1,79 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/SpillFile.h"
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 🛠️ Constructor
+SpillFile::SpillFile(const std::string& path)
+    : path(path), fd(-1), endOffset(0), deadBytes(0) {}
+
+// 🛠️ Spilled values only mirror memory, so the file goes away with the cache
+SpillFile::~SpillFile() {
+    if (fd >= 0) {
+        ::close(fd);
+        ::unlink(path.c_str());
+    }
+}
+
+// 🛠️ Create (or truncate) the spill file
+bool SpillFile::open() {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error opening value spill file " << path << std::endl;
+        return false;
+    }
+    endOffset = 0;
+    deadBytes = 0;
+    return true;
+}
+
+bool SpillFile::reset() {
+    if (fd < 0 || ::ftruncate(fd, 0) != 0) return false;
+    endOffset = 0;
+    deadBytes = 0;
+    return true;
+}
+
+// 🛠️ Write a value at the end of the file (safe to call from several threads)
+SpillRef SpillFile::append(std::string_view value) {
+    if (fd < 0 || value.size() > std::numeric_limits<uint32_t>::max()) return SpillRef();
+
+    uint64_t offset = endOffset.fetch_add(value.size(), std::memory_order_relaxed);
+    for (size_t written = 0; written < value.size();) {
+        ssize_t n = ::pwrite(fd, value.data() + written, value.size() - written, offset + written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            deadBytes.fetch_add(value.size(), std::memory_order_relaxed);  // The range is lost
+            return SpillRef();
+        }
+        written += static_cast<size_t>(n);
+    }
+    return {offset, static_cast<uint32_t>(value.size())};
+}
+
+// 🛠️ Read a spilled value back
+bool SpillFile::read(const SpillRef& ref, std::string& value) const {
+    value.resize(ref.length);
+    for (size_t done = 0; done < ref.length;) {
+        ssize_t n = ::pread(fd, &value[done], ref.length - done, ref.offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            value.clear();
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void SpillFile::release(const SpillRef& ref) {
+    if (ref.valid()) deadBytes.fetch_add(ref.length, std::memory_order_relaxed);
+}
+
+bool SpillFile::renameTo(const std::string& newPath) {
+    if (std::rename(path.c_str(), newPath.c_str()) != 0) return false;
+    path = newPath;
+    return true;
+}
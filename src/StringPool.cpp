@@ -0,0 +1,191 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/StringPool.h"
+#include <cstdlib>
+#include <new>
+
+// A run of interned entries; `live` counts the entries not yet released
+struct ArenaBlock {
+    ArenaBlock* prev;
+    ArenaBlock* next;
+    size_t capacity;
+    size_t used;
+    size_t live;
+    bool dedicated;  // Holds one oversized string and is never carved further
+
+    char* bytes() { return reinterpret_cast<char*>(this + 1); }
+};
+
+// A released entry's slot on its stripe's free list. It overlays the entry, so no
+// entry is smaller than this.
+struct FreeSlot {
+    ArenaBlock* block;
+    FreeSlot* prev;
+    FreeSlot* next;
+    size_t bytes;
+};
+
+namespace {
+
+constexpr size_t ENTRY_ALIGN = alignof(InternedEntry);
+
+size_t entryBytes(size_t length) {
+    size_t bytes = (sizeof(InternedEntry) + length + ENTRY_ALIGN - 1) / ENTRY_ALIGN * ENTRY_ALIGN;
+    return bytes < sizeof(FreeSlot) ? sizeof(FreeSlot) : bytes;
+}
+
+}  // namespace
+
+size_t StringPool::stripeFor(std::string_view text) {
+    return std::hash<std::string_view>()(text) % STRIPE_COUNT;
+}
+
+// 🛠️ Reuse a released slot of the same size, else carve an entry out of the stripe's
+// current block, starting a new block when it's full. Strings bigger than a quarter
+// block get a block of their own.
+InternedEntry* StringPool::allocateLocked(Stripe& stripe, uint32_t stripeIndex, std::string_view text) {
+    size_t needed = entryBytes(text.size());
+    size_t sizeClass = needed / ENTRY_ALIGN;
+    ArenaBlock* block = stripe.current;
+    char* slot;
+    if (sizeClass < stripe.freeSlots.size() && stripe.freeSlots[sizeClass]) {
+        FreeSlot* reused = stripe.freeSlots[sizeClass];
+        unlinkFreeLocked(stripe, reused);
+        block = reused->block;
+        slot = reinterpret_cast<char*>(reused);
+    } else {
+        if (!block || block->capacity - block->used < needed) {
+            bool dedicated = needed > BLOCK_BYTES / 4;
+            size_t capacity = dedicated ? needed : BLOCK_BYTES;
+            void* raw = std::malloc(sizeof(ArenaBlock) + capacity);
+            if (!raw) throw std::bad_alloc();
+            block = new (raw) ArenaBlock{nullptr, stripe.blocks, capacity, 0, 0, dedicated};
+            if (stripe.blocks) stripe.blocks->prev = block;
+            stripe.blocks = block;
+            stripe.totals.arenaBytes.fetch_add(sizeof(ArenaBlock) + capacity, std::memory_order_relaxed);
+
+            if (!dedicated) {
+                ArenaBlock* retired = stripe.current;
+                stripe.current = block;
+                if (retired && retired->live == 0) freeBlockLocked(stripe, retired);
+            }
+        }
+        slot = block->bytes() + block->used;
+        block->used += needed;
+    }
+    block->live++;
+
+    InternedEntry* entry = new (slot) InternedEntry;
+    entry->refs.store(1, std::memory_order_relaxed);
+    entry->length = static_cast<uint32_t>(text.size());
+    entry->stripe = stripeIndex;
+    entry->hash = InternedString::hashText(text);
+    entry->block = block;
+    std::char_traits<char>::copy(const_cast<char*>(entry->data()), text.data(), text.size());
+    return entry;
+}
+
+// 🛠️ Free a block whose strings have all been released, taking their slots off the
+// free list first
+void StringPool::freeBlockLocked(Stripe& stripe, ArenaBlock* block) {
+    if (!block->dedicated) {
+        for (size_t offset = 0; offset < block->used;) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(block->bytes() + offset);
+            offset += slot->bytes;
+            unlinkFreeLocked(stripe, slot);
+        }
+    }
+    if (block->prev) block->prev->next = block->next;
+    else stripe.blocks = block->next;
+    if (block->next) block->next->prev = block->prev;
+    stripe.totals.arenaBytes.fetch_sub(sizeof(ArenaBlock) + block->capacity, std::memory_order_relaxed);
+    std::free(block);
+}
+
+void StringPool::pushFreeLocked(Stripe& stripe, ArenaBlock* block, void* slot, size_t bytes) {
+    size_t sizeClass = bytes / ENTRY_ALIGN;
+    if (sizeClass >= stripe.freeSlots.size()) stripe.freeSlots.resize(sizeClass + 1, nullptr);
+    FreeSlot* head = stripe.freeSlots[sizeClass];
+    FreeSlot* free = new (slot) FreeSlot{block, nullptr, head, bytes};
+    if (head) head->prev = free;
+    stripe.freeSlots[sizeClass] = free;
+    stripe.totals.freeBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void StringPool::unlinkFreeLocked(Stripe& stripe, FreeSlot* slot) {
+    if (slot->prev) slot->prev->next = slot->next;
+    else stripe.freeSlots[slot->bytes / ENTRY_ALIGN] = slot->next;
+    if (slot->next) slot->next->prev = slot->prev;
+    stripe.totals.freeBytes.fetch_sub(slot->bytes, std::memory_order_relaxed);
+}
+
+// 🛠️ Return the shared copy of `text`, interning it on first sight
+InternedString StringPool::intern(std::string_view text) {
+    size_t index = stripeFor(text);
+    Stripe& stripe = stripes[index];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.table.find(text);
+    if (it != stripe.table.end()) {
+        addReference(it->second);
+        return InternedString(it->second);
+    }
+    InternedEntry* entry = allocateLocked(stripe, static_cast<uint32_t>(index), text);
+    stripe.table.emplace(std::string_view(entry->data(), entry->length), entry);
+    Counters& totals = stripe.totals;
+    totals.references.fetch_add(1, std::memory_order_relaxed);
+    totals.logicalBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    totals.uniqueStrings.fetch_add(1, std::memory_order_relaxed);
+    totals.storedBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    return InternedString(entry);
+}
+
+// 🛠️ Look a string up without interning it
+InternedString StringPool::find(std::string_view text) const {
+    const Stripe& stripe = stripes[stripeFor(text)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.table.find(text);
+    if (it == stripe.table.end()) return InternedString();
+    addReference(it->second);
+    return InternedString(it->second);
+}
+
+// 🛠️ Drop one reference. Counts only reach zero under the stripe lock, so a concurrent
+// intern() either sees the entry with a live count or doesn't see it at all.
+void StringPool::release(InternedEntry* entry) {
+    // Read before letting go: once our reference is dropped another thread may free the entry
+    size_t length = entry->length;
+    Stripe& stripe = instance().stripes[entry->stripe];
+    Counters& totals = stripe.totals;
+    totals.references.fetch_sub(1, std::memory_order_relaxed);
+    totals.logicalBytes.fetch_sub(length, std::memory_order_relaxed);
+
+    uint32_t refs = entry->refs.load(std::memory_order_relaxed);
+    while (refs > 1) {
+        if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel)) return;
+    }
+
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    totals.uniqueStrings.fetch_sub(1, std::memory_order_relaxed);
+    totals.storedBytes.fetch_sub(length, std::memory_order_relaxed);
+    stripe.table.erase(std::string_view(entry->data(), entry->length));
+    ArenaBlock* block = entry->block;
+    size_t bytes = entryBytes(entry->length);
+    entry->~InternedEntry();
+    if (!block->dedicated) pushFreeLocked(stripe, block, entry, bytes);
+    if (--block->live == 0 && block != stripe.current) freeBlockLocked(stripe, block);
+}
+
+// 🛠️ Total up the running counters; no stripe is locked
+StringPoolStats StringPool::stats() const {
+    StringPoolStats stats;
+    for (const Stripe& stripe : stripes) {
+        const Counters& totals = stripe.totals;
+        stats.uniqueStrings += totals.uniqueStrings.load(std::memory_order_relaxed);
+        stats.references += totals.references.load(std::memory_order_relaxed);
+        stats.storedBytes += totals.storedBytes.load(std::memory_order_relaxed);
+        stats.logicalBytes += totals.logicalBytes.load(std::memory_order_relaxed);
+        stats.arenaBytes += totals.arenaBytes.load(std::memory_order_relaxed);
+        stats.freeBytes += totals.freeBytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,158 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/TypedValue.h"
+#include </opt/homebrew/Cellar/nlohmann-json/3.11.3/include/nlohmann/json.hpp>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+using json = nlohmann::json;
+
+namespace {
+
+constexpr size_t NUMBER_BYTES = TypedValue::HEADER_BYTES + 8;
+
+void appendLE64(std::string& out, uint64_t bits) {
+    for (int i = 0; i < 8; i++) out += static_cast<char>((bits >> (8 * i)) & 0xFF);
+}
+
+uint64_t readLE64(const char* p) {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; i--) bits = (bits << 8) | static_cast<unsigned char>(p[i]);
+    return bits;
+}
+
+// Shortest text that reads back as the same double; integral values keep a ".0" so
+// they come back as FLOAT rather than INTEGER
+std::string formatDouble(double value) {
+    if (std::isnan(value)) return "nan";
+    if (std::isinf(value)) return value < 0 ? "-inf" : "inf";
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    std::string text(buffer, result.ptr);
+    if (text.find_first_of(".e") == std::string::npos) text += ".0";
+    return text;
+}
+
+}  // namespace
+
+// 🛠️ Infer a literal's type the way a JSON parser would
+TypedValue TypedValue::parse(std::string_view literal) {
+    json j = json::parse(literal.begin(), literal.end(), nullptr, false);
+    if (j.is_discarded()) return ofString(std::string(literal));
+    return fromJSON(j);
+}
+
+// 🛠️ Decode stored bytes; anything that isn't a well-formed header is plain text
+TypedValue TypedValue::decode(std::string_view stored) {
+    if (isPlain(stored) || stored.size() < HEADER_BYTES) return ofString(std::string(stored));
+    std::string_view payload = stored.substr(HEADER_BYTES);
+    switch (static_cast<DataType>(stored[1])) {
+        case STRING:
+            return ofString(std::string(payload));
+        case INTEGER:
+            if (stored.size() == NUMBER_BYTES) return ofInteger(static_cast<int64_t>(readLE64(payload.data())));
+            break;
+        case FLOAT:
+            if (stored.size() == NUMBER_BYTES) {
+                uint64_t bits = readLE64(payload.data());
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return ofFloat(value);
+            }
+            break;
+        case BOOLEAN:
+            if (payload.size() == 1) return ofBoolean(payload[0] != 0);
+            break;
+        case ARRAY:
+            return ofArray(std::string(payload));
+        case OBJECT:
+            return ofObject(std::string(payload));
+    }
+    return ofString(std::string(stored));
+}
+
+DataType TypedValue::typeOf(std::string_view stored) {
+    return isPlain(stored) ? STRING : decode(stored).getType();
+}
+
+// 🛠️ Read a stored INTEGER or FLOAT without decoding anything else
+bool TypedValue::numberOf(std::string_view stored, double& value) {
+    if (stored.size() != NUMBER_BYTES || stored[0] != MARKER) return false;
+    uint64_t bits = readLE64(stored.data() + HEADER_BYTES);
+    if (stored[1] == INTEGER) {
+        value = static_cast<double>(static_cast<int64_t>(bits));
+        return true;
+    }
+    if (stored[1] == FLOAT) {
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    return false;
+}
+
+std::string TypedValue::display(std::string_view stored) {
+    return isPlain(stored) ? std::string(stored) : decode(stored).toString();
+}
+
+std::string TypedValue::encodeString(std::string_view text) {
+    if (isPlain(text)) return std::string(text);
+    std::string stored;
+    stored.reserve(HEADER_BYTES + text.size());
+    stored += MARKER;
+    stored += static_cast<char>(STRING);
+    stored += text;
+    return stored;
+}
+
+const char* TypedValue::typeName(DataType type) {
+    switch (type) {
+        case STRING: return "string";
+        case INTEGER: return "integer";
+        case FLOAT: return "float";
+        case BOOLEAN: return "boolean";
+        case ARRAY: return "array";
+        case OBJECT: return "object";
+    }
+    return "unknown";
+}
+
+// 🛠️ Encode for storage (see the layout above)
+std::string TypedValue::encode() const {
+    if (type == STRING) return encodeString(text);
+
+    std::string stored;
+    stored += MARKER;
+    stored += static_cast<char>(type);
+    switch (type) {
+        case INTEGER:
+            appendLE64(stored, static_cast<uint64_t>(integer));
+            break;
+        case FLOAT: {
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            appendLE64(stored, bits);
+            break;
+        }
+        case BOOLEAN:
+            stored += static_cast<char>(integer != 0);
+            break;
+        default:
+            stored += text;
+    }
+    return stored;
+}
+
+std::string TypedValue::toString() const {
+    switch (type) {
+        case INTEGER: return std::to_string(integer);
+        case FLOAT: return formatDouble(number);
+        case BOOLEAN: return integer ? "true" : "false";
+        default: return text;
+    }
+}
+
+std::string TypedValue::toJSON() const {
+    switch (type) {
+        case STRING: return json(text).dump(-1, ' ', false, json::error_handler_t::replace);
+        case FLOAT: return std::isfinite(number) ? formatDouble(number) : "null";
+        default: return toString();
+    }
+}
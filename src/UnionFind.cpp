@@ -0,0 +1,57 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/UnionFind.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+uint32_t UnionFind::add() {
+    uint32_t id = static_cast<uint32_t>(parent.size());
+    parent.push_back(id);
+    rank.push_back(0);
+    sizes.push_back(1);
+    sets++;
+    return id;
+}
+
+void UnionFind::reset(size_t count) {
+    parent.resize(count);
+    std::iota(parent.begin(), parent.end(), 0);
+    rank.assign(count, 0);
+    sizes.assign(count, 1);
+    sets = count;
+}
+
+// 🛠️ Find the root, pointing every other node on the way at its grandparent
+uint32_t UnionFind::find(uint32_t id) {
+    while (parent[id] != id) {
+        parent[id] = parent[parent[id]];
+        id = parent[id];
+    }
+    return id;
+}
+
+// 🛠️ Merge two sets, hanging the shallower tree under the deeper one
+bool UnionFind::unite(uint32_t a, uint32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (rank[a] < rank[b]) std::swap(a, b);
+    parent[b] = a;
+    sizes[a] += sizes[b];
+    if (rank[a] == rank[b]) rank[a]++;
+    sets--;
+    return true;
+}
+
+std::vector<size_t> UnionFind::setSizes() const {
+    std::vector<size_t> result;
+    result.reserve(sets);
+    for (uint32_t id = 0; id < parent.size(); id++) {
+        if (parent[id] == id) result.push_back(sizes[id]);
+    }
+    std::sort(result.begin(), result.end(), std::greater<size_t>());
+    return result;
+}
+
+size_t UnionFind::memoryUsage() const {
+    return parent.capacity() * sizeof(uint32_t) + rank.capacity() + sizes.capacity() * sizeof(uint32_t);
+}
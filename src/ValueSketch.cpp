@@ -0,0 +1,120 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ValueSketch.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Finalizer from MurmurHash3: spreads std::hash output over every bit
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+}  // namespace
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth) : width(1), depth(depth) {
+    while (this->width < width) this->width <<= 1;
+    counters.assign(this->width * depth, 0);
+}
+
+// 🛠️ Rows are indexed by double hashing: h1 + row * h2
+void CountMinSketch::add(std::string_view item, int64_t delta) {
+    uint64_t h = mix(std::hash<std::string_view>()(item));
+    uint64_t h1 = h & 0xFFFFFFFF;
+    uint64_t h2 = (h >> 32) | 1;
+    for (size_t row = 0; row < depth; row++) {
+        uint32_t& counter = counters[row * width + ((h1 + row * h2) & (width - 1))];
+        if (delta < 0 && counter < static_cast<uint64_t>(-delta)) counter = 0;
+        else counter = static_cast<uint32_t>(counter + delta);
+    }
+}
+
+uint64_t CountMinSketch::estimate(std::string_view item) const {
+    uint64_t h = mix(std::hash<std::string_view>()(item));
+    uint64_t h1 = h & 0xFFFFFFFF;
+    uint64_t h2 = (h >> 32) | 1;
+    uint64_t smallest = std::numeric_limits<uint64_t>::max();
+    for (size_t row = 0; row < depth; row++) {
+        smallest = std::min<uint64_t>(smallest, counters[row * width + ((h1 + row * h2) & (width - 1))]);
+    }
+    return smallest;
+}
+
+void CountMinSketch::clear() {
+    std::fill(counters.begin(), counters.end(), 0);
+}
+
+HeavyHitters::HeavyHitters(size_t capacity) : capacity(capacity), floor(0) {}
+
+// 🛠️ Offer an item that isn't in the table; a full table gives up its smallest entry
+void HeavyHitters::admit(std::string_view item, uint64_t estimate) {
+    if (candidates.size() < capacity) {
+        candidates.emplace(std::string(item), estimate);
+        if (candidates.size() == capacity) {
+            floor = std::numeric_limits<uint64_t>::max();
+            for (const auto& [_, count] : candidates) floor = std::min(floor, count);
+        }
+        return;
+    }
+    if (estimate <= floor) return;
+
+    // The floor may be stale (table entries only grow between rescans); find the real minimum
+    auto smallest = candidates.begin();
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        if (it->second < smallest->second) smallest = it;
+    }
+    if (estimate > smallest->second) {
+        candidates.erase(smallest);
+        candidates.emplace(std::string(item), estimate);
+    }
+    floor = std::numeric_limits<uint64_t>::max();
+    for (const auto& [_, count] : candidates) floor = std::min(floor, count);
+}
+
+void HeavyHitters::add(std::string_view item) {
+    sketch.add(item, 1);
+    uint64_t estimate = sketch.estimate(item);
+    auto it = candidates.find(item);
+    if (it != candidates.end()) it->second = estimate;
+    else admit(item, estimate);
+}
+
+void HeavyHitters::remove(std::string_view item) {
+    sketch.add(item, -1);
+    auto it = candidates.find(item);
+    if (it == candidates.end()) return;
+    uint64_t estimate = sketch.estimate(item);
+    if (estimate == 0) {
+        candidates.erase(it);
+    } else {
+        it->second = estimate;
+        floor = std::min(floor, estimate);
+    }
+}
+
+void HeavyHitters::clear() {
+    sketch.clear();
+    candidates.clear();
+    floor = 0;
+}
+
+std::vector<std::pair<std::string, uint64_t>> HeavyHitters::top(size_t k) const {
+    std::vector<std::pair<std::string, uint64_t>> items;
+    items.assign(candidates.begin(), candidates.end());
+    k = std::min(k, items.size());
+    std::partial_sort(items.begin(), items.begin() + k, items.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    items.resize(k);
+    return items;
+}
+
+size_t HeavyHitters::memoryUsage() const {
+    size_t bytes = sketch.memoryUsage();
+    for (const auto& [item, _] : candidates) bytes += sizeof(item) + item.capacity() + sizeof(uint64_t) + 4 * sizeof(void*);
+    return bytes;
+}
@@ -23,13 +23,18 @@ VersionControl::VersionControl(Database& db, const std::string& author)
 void VersionControl::saveCommits() const {
     json j;
     for (const auto& commit : commits) {
+        json snapshot = json::object();
+        for (const auto& [key, value] : commit->snapshot) {
+            // Out-of-line values are written out, so commits.json stands on its own
+            snapshot[key.str()] = TypedValue::decode(db.resolveValue(value)).toJSONValue<json>();
+        }
         j.push_back({
             {"id", commit->id},
             {"message", commit->message},
             {"branchName", commit->branchName},
             {"author", commit->author},
             {"timestamp", std::chrono::system_clock::to_time_t(commit->timestamp)},
-            {"snapshot", commit->snapshot}
+            {"snapshot", std::move(snapshot)}
         });
     }
     std::ofstream outFile("data/commits.json");
@@ -68,7 +73,9 @@ void VersionControl::loadCommits() {
             commit->branchName = item["branchName"];
             commit->author = item["author"];
             commit->timestamp = std::chrono::system_clock::from_time_t(item["timestamp"]);
-            commit->snapshot = item["snapshot"].get<std::unordered_map<std::string, std::string>>();
+            for (const auto& [key, value] : item["snapshot"].items()) {
+                commit->snapshot.emplace(InternedString(key), InternedString(TypedValue::fromJSON(value).encode()));
+            }
             commits.push_back(commit);
             branches[commit->branchName].push_back(commit->id);
             currentVersion = std::max(currentVersion, commit->id + 1);
@@ -88,8 +95,8 @@ bool VersionControl::commit(const std::string& message) {
     commit->branchName = currentBranch;
     commit->author = author;
     commit->timestamp = std::chrono::system_clock::now();
-    commit->snapshot = db.getAllData();
-    commit->graphSnapshot = graph; 
+    commit->snapshot = db.openSnapshot().entries();  // Writers aren't held up meanwhile
+    commit->graphSnapshot = db.graphSnapshot();
     commits.push_back(commit);
     branches[currentBranch].push_back(commit->id);
     saveCommits();  // 🛠️ Save commits to file after every commit
@@ -146,24 +153,40 @@ bool VersionControl::merge(const std::string& branchName) {
 
     // Track conflicts
     std::unordered_map<std::string, std::string> conflicts;
+    InternedMap merged;  // Applied as one batch below
 
-    // Iterate through commits in the branch to merge
+    // Current values of the keys the branch touches, read in one pass over a snapshot
+    // (keys are views into the commit snapshots, which outlive this call)
+    std::unordered_map<std::string_view, std::string> current;
     for (int version : branches[branchName]) {
         if (version >= commits.size()) return false;
+        for (const auto& [key, _] : commits[version]->snapshot) current.emplace(key.view(), std::string());
+    }
+    db.openSnapshot().forEach([&](std::string_view key, std::string_view value) {
+        auto it = current.find(key);
+        if (it != current.end()) it->second = TypedValue::display(value);
+    });
 
+    // Iterate through commits in the branch to merge
+    for (int version : branches[branchName]) {
         // Compare snapshots for conflicts
         for (const auto& [key, value] : commits[version]->snapshot) {
-            std::string currentValue = db.get(key);
+            auto pending = merged.find(key);
+            std::string currentValue = pending != merged.end()
+                                           ? TypedValue::display(db.resolveValue(pending->second))
+                                           : current[key.view()];
+            std::string incomingValue = TypedValue::display(db.resolveValue(value));  // Compared as get() shows them
 
-            if (!currentValue.empty() && currentValue != value) {
+            if (!currentValue.empty() && currentValue != incomingValue) {
                 // 🛠️ Conflict detected
-                conflicts[key] = value;
+                conflicts[key.str()] = incomingValue;
             } else {
                 // No conflict, apply change
-                db.insert(key, value);
+                merged[key] = value;
             }
         }
     }
+    db.batchInsert(merged);
 
     if (!conflicts.empty()) {
         // Save conflicts for later resolution
@@ -197,10 +220,8 @@ bool VersionControl::resolveConflict(const std::string& key, const std::string&
 bool VersionControl::checkout(int version) {
     if (version < 0 || version >= commits.size()) return false;
     db.reset("data/mydb.json");
-    for (const auto& [key, value] : commits[version]->snapshot) {
-        db.insert(key, value);
-    }
-    graph = commits[version]->graphSnapshot;  
+    db.batchInsert(commits[version]->snapshot);
+    db.restoreGraph(commits[version]->graphSnapshot);
     return db.save();
 }
 
@@ -0,0 +1,383 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/WriteAheadLog.h"
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+// 🛠️ CRC-32 (IEEE 802.3), table generated on first use
+uint32_t crc32(const char* data, size_t length) {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void putU32(std::string& out, uint32_t v) {
+    char bytes[4] = {
+        static_cast<char>(v & 0xFF), static_cast<char>((v >> 8) & 0xFF),
+        static_cast<char>((v >> 16) & 0xFF), static_cast<char>((v >> 24) & 0xFF)
+    };
+    out.append(bytes, 4);
+}
+
+uint32_t getU32(const char* p) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(p[0])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(p[2])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(p[3])) << 24;
+}
+
+}  // namespace
+
+// 🛠️ Constructor
+WriteAheadLog::WriteAheadLog(const std::string& path, const WALOptions& options)
+    : path(path), options(options), fd(-1), pendingRecords(0), appendedLsn(0),
+      durableLsn(0), stopping(false), failed(false), fileBytes(0) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+// 🛠️ Open the live log for appending and start the group-commit flusher
+bool WriteAheadLog::open() {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        std::cerr << "Error opening write-ahead log " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    fileBytes = (fstat(fd, &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+    stopping = false;
+    flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+    return true;
+}
+
+// 🛠️ Flush anything pending and stop the flusher
+void WriteAheadLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0 && !flusher.joinable()) return;
+        stopping = true;
+    }
+    flushCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    {
+        std::lock_guard<std::mutex> ioLock(ioMutex);
+        flushPending();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    durableCv.notify_all();
+}
+
+// 🛠️ Serialize a record with its length and checksum header
+std::string WriteAheadLog::encode(const WALRecord& record) {
+    std::string payload;
+    payload.reserve(9 + record.key.size() + record.value.size());
+    payload.push_back(static_cast<char>(record.op));
+    putU32(payload, static_cast<uint32_t>(record.key.size()));
+    payload += record.key;
+    putU32(payload, static_cast<uint32_t>(record.value.size()));
+    payload += record.value;
+
+    std::string out;
+    out.reserve(8 + payload.size());
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(payload.data(), payload.size()));
+    out += payload;
+    return out;
+}
+
+// 🛠️ Pack a batch of inserts as [u32 key length][key][u32 value length][value]...
+WALRecord WriteAheadLog::batchInsertRecord(
+    const std::vector<std::pair<std::string_view, std::string_view>>& entries) {
+    WALRecord record{WALOp::BATCH_INSERT, "", ""};
+    for (const auto& [key, value] : entries) {
+        putU32(record.value, static_cast<uint32_t>(key.size()));
+        record.value.append(key.data(), key.size());
+        putU32(record.value, static_cast<uint32_t>(value.size()));
+        record.value.append(value.data(), value.size());
+    }
+    return record;
+}
+
+// 🛠️ Pack a batch of removals as [u32 key length][key]...
+WALRecord WriteAheadLog::batchRemoveRecord(const std::vector<std::string_view>& keys) {
+    WALRecord record{WALOp::BATCH_REMOVE, "", ""};
+    for (const auto& key : keys) {
+        putU32(record.value, static_cast<uint32_t>(key.size()));
+        record.value.append(key.data(), key.size());
+    }
+    return record;
+}
+
+// 🛠️ Expand a batch record into its individual mutations
+bool WriteAheadLog::applyBatch(const WALRecord& batch,
+                               const std::function<void(const WALRecord&)>& apply) {
+    const std::string& packed = batch.value;
+    bool inserting = batch.op == WALOp::BATCH_INSERT;
+    size_t offset = 0;
+    WALRecord record{inserting ? WALOp::INSERT : WALOp::REMOVE, "", ""};
+    while (offset < packed.size()) {
+        if (offset + 4 > packed.size()) return false;
+        uint32_t keyLength = getU32(packed.data() + offset);
+        offset += 4;
+        if (offset + keyLength > packed.size()) return false;
+        record.key.assign(packed, offset, keyLength);
+        offset += keyLength;
+        if (inserting) {
+            if (offset + 4 > packed.size()) return false;
+            uint32_t valueLength = getU32(packed.data() + offset);
+            offset += 4;
+            if (offset + valueLength > packed.size()) return false;
+            record.value.assign(packed, offset, valueLength);
+            offset += valueLength;
+        }
+        apply(record);
+    }
+    return true;
+}
+
+// 🛠️ Queue a record for the next group commit
+uint64_t WriteAheadLog::enqueue(const WALRecord& record) {
+    std::string bytes = encode(record);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0 || failed) return 0;
+    buffer += bytes;
+    uint64_t lsn = ++appendedLsn;
+    if (++pendingRecords >= options.groupCommitSize) flushCv.notify_one();
+    return lsn;
+}
+
+// 🛠️ With syncOnCommit, wait until the group holding `lsn` has been fsync'd
+bool WriteAheadLog::waitDurable(uint64_t lsn) {
+    if (lsn == 0) return false;
+    if (!options.syncOnCommit) return true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    durableCv.wait(lock, [&] { return durableLsn >= lsn || failed || fd < 0; });
+    return durableLsn >= lsn;
+}
+
+bool WriteAheadLog::append(const WALRecord& record) {
+    return waitDurable(enqueue(record));
+}
+
+// 🛠️ Force every pending record to disk
+bool WriteAheadLog::sync() {
+    std::lock_guard<std::mutex> ioLock(ioMutex);
+    return flushPending();
+}
+
+// 🛠️ Write and fsync the pending buffer (caller holds ioMutex)
+bool WriteAheadLog::flushPending() {
+    std::string batch;
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (buffer.empty()) return !failed;
+        batch.swap(buffer);
+        pendingRecords = 0;
+        target = appendedLsn;
+    }
+
+    bool ok = writeAndSync(batch);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ok) {
+            durableLsn = target;
+        } else {
+            failed = true;
+        }
+    }
+    durableCv.notify_all();
+    return ok;
+}
+
+bool WriteAheadLog::writeAndSync(const std::string& bytes) {
+    if (fd < 0) return false;
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t n = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error writing write-ahead log: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    fileBytes += bytes.size();
+    return ::fsync(fd) == 0;
+}
+
+// 🛠️ Group commit: one fsync covers every record queued since the last one
+void WriteAheadLog::flusherLoop() {
+    auto interval = std::chrono::milliseconds(options.groupCommitIntervalMs);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            flushCv.wait_for(lock, interval, [&] {
+                return stopping || pendingRecords >= options.groupCommitSize;
+            });
+            if (stopping) return;
+            if (buffer.empty()) continue;
+        }
+        std::lock_guard<std::mutex> ioLock(ioMutex);
+        flushPending();
+    }
+}
+
+// 🛠️ Apply every intact record in a log file, stopping at the first torn or corrupt one
+size_t WriteAheadLog::replayFile(const std::string& path,
+                                 const std::function<void(const WALRecord&)>& apply,
+                                 bool truncateTornTail) {
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open()) return 0;
+    std::string contents((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    inFile.close();
+
+    size_t offset = 0;
+    size_t applied = 0;
+    while (offset + 8 <= contents.size()) {
+        uint32_t length = getU32(contents.data() + offset);
+        uint32_t checksum = getU32(contents.data() + offset + 4);
+        if (length < 9 || offset + 8 + length > contents.size()) break;
+
+        const char* payload = contents.data() + offset + 8;
+        if (crc32(payload, length) != checksum) break;
+
+        WALRecord record;
+        record.op = static_cast<WALOp>(payload[0]);
+        uint32_t keyLength = getU32(payload + 1);
+        if (5 + keyLength + 4 > length) break;
+        record.key.assign(payload + 5, keyLength);
+        uint32_t valueLength = getU32(payload + 5 + keyLength);
+        if (9 + keyLength + valueLength != length) break;
+        record.value.assign(payload + 9 + keyLength, valueLength);
+
+        if (record.op == WALOp::BATCH_INSERT || record.op == WALOp::BATCH_REMOVE) {
+            // The checksum already vouched for the whole batch; a malformed body is a bug
+            if (!applyBatch(record, apply)) {
+                std::cerr << "Write-ahead log " << path << ": malformed batch record" << std::endl;
+                break;
+            }
+        } else {
+            apply(record);
+        }
+        applied++;
+        offset += 8 + length;
+    }
+
+    if (offset < contents.size()) {
+        std::cerr << "Write-ahead log " << path << ": discarding " << (contents.size() - offset)
+                  << " bytes of torn or corrupt tail" << std::endl;
+        if (truncateTornTail && ::truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+            std::cerr << "Error truncating write-ahead log " << path << std::endl;
+        }
+    }
+    return applied;
+}
+
+// 🛠️ Replay the rotated log left behind by an unfinished checkpoint, then the live log
+size_t WriteAheadLog::replay(const std::function<void(const WALRecord&)>& apply) {
+    std::lock_guard<std::mutex> ioLock(ioMutex);
+    size_t applied = replayFile(rotatedPath(), apply, false);
+    applied += replayFile(path, apply, true);
+
+    struct stat st;
+    fileBytes = (::stat(path.c_str(), &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+    return applied;
+}
+
+// 🛠️ fsync the directory holding `path`, so a rename or unlink in it is durable
+bool WriteAheadLog::syncDirectoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int dirFd = ::open(dir.c_str(), O_RDONLY);
+    if (dirFd < 0) return false;
+    bool ok = ::fsync(dirFd) == 0;
+    ::close(dirFd);
+    return ok;
+}
+
+// 🛠️ Move the live log aside; new records go to a fresh file. The rotated copy is
+// made durable before the live log gives up its records.
+bool WriteAheadLog::rotate() {
+    std::lock_guard<std::mutex> ioLock(ioMutex);
+    if (!flushPending()) return false;
+
+    std::string rotated = rotatedPath();
+    struct stat st;
+    if (::stat(rotated.c_str(), &st) == 0) {
+        // A previous checkpoint never finished: keep its records and append ours after them
+        std::ifstream live(path, std::ios::binary);
+        if (!live.is_open()) return false;
+        std::string contents((std::istreambuf_iterator<char>(live)), std::istreambuf_iterator<char>());
+        int oldFd = ::open(rotated.c_str(), O_WRONLY | O_APPEND);
+        if (oldFd < 0) return false;
+        size_t written = 0;
+        while (written < contents.size()) {
+            ssize_t n = ::write(oldFd, contents.data() + written, contents.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) break;
+            written += static_cast<size_t>(n);
+        }
+        bool ok = written == contents.size() && ::fsync(oldFd) == 0;
+        ::close(oldFd);
+        if (!ok || ::ftruncate(fd, 0) != 0) return false;
+    } else {
+        if (std::rename(path.c_str(), rotated.c_str()) != 0) return false;
+        ::close(fd);
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0 || !syncDirectoryOf(path)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            return false;
+        }
+    }
+    fileBytes = 0;
+    return true;
+}
+
+// 🛠️ Drop the rotated log once the snapshot covering it is durable: syncing the
+// directory first makes the snapshot's rename stick before the unlink can
+bool WriteAheadLog::discardRotated() {
+    std::lock_guard<std::mutex> ioLock(ioMutex);
+    if (!syncDirectoryOf(path)) return false;
+    return std::remove(rotatedPath().c_str()) == 0 || errno == ENOENT;
+}
+
+size_t WriteAheadLog::sizeBytes() const {
+    return fileBytes.load();
+}
+
+bool WriteAheadLog::hasRecords() const {
+    struct stat st;
+    return fileBytes.load() > 0 || ::stat(rotatedPath().c_str(), &st) == 0;
+}
+
+std::string WriteAheadLog::rotatedPath() const {
+    return path + ".ckpt";
+}
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include "/Users/gaganphadke/Versioning/versioned-db/include/Database.h"
 #include "/Users/gaganphadke/Versioning/versioned-db/include/VersionControl.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/LSMTree.h"
 #include "Client.cpp" 
 
 // Helper function to split string by spaces while preserving quoted sections
@@ -37,19 +38,40 @@ void printMenu() {
     std::cout << "\n====== Versioned Database System ======\n";
     std::cout << "Database Commands:\n";
     std::cout << "  insert <key> <value>           - Insert or update a key-value pair\n";
+    std::cout << "  set <key> <literal>            - Insert a typed value (42, 1.5, true, [..], {..})\n";
     std::cout << "  get <key>                      - Retrieve value by key\n";
+    std::cout << "  type <key>                     - Show the type of a key's value\n";
     std::cout << "  remove <key>                   - Remove a key-value pair\n";
-    std::cout << "  query <prefix>                 - Find all keys with prefix\n";
+    std::cout << "  query <prefix> [--reverse]     - Find all keys with prefix, in key order\n";
+    std::cout << "  range <lo> <hi|*> [--reverse] [--limit N]\n";
+    std::cout << "                                 - Find keys in [lo, hi), in key order\n";
     std::cout << "  queryvalue <value>             - Find keys with specific value\n";
+    std::cout << "  querypattern <pattern>         - Find keys whose value contains a literal or regex match\n";
+    std::cout << "  find <expr>                    - Structured query, e.g. prefix:user: AND (value:42 OR regex:^a)\n";
+    std::cout << "                                   terms: prefix:P range:LO..HI value:V regex:R index:NAME=V\n";
+    std::cout << "  explain <expr>                 - Run a structured query and show its plan\n";
+    std::cout << "  between <lo> <hi> [--limit N]  - Find keys with numeric values in [lo, hi], by value\n";
+    std::cout << "  aggregate <prefix|*>           - Count/min/max/sum of numeric values under a prefix\n";
     std::cout << "  export <filename>              - Export database to file\n";
     std::cout << "  import <filename> [--merge]    - Import database from file\n";
+    std::cout << "  index <name> <kind>            - Create an index (value, lower, length, prefix:N)\n";
+    std::cout << "  queryindex <name> <value>      - Find keys through a secondary index\n";
     std::cout << "  stats                          - Show database statistics\n";
+    std::cout << "  checkpoint                     - Fold the write-ahead log into the snapshot\n";
+    std::cout << "  optimize                       - Evict down to the memory budget, compact the spill file\n";
+    std::cout << "  clearcache                     - Spill every cached value, drop value indexes\n";
 
     std::cout << "\nGraph Commands:\n";
     std::cout << "  addnode <node>                 - Add a node to the graph\n";
     std::cout << "  addedge <from> <to> <weight>   - Add an edge with weight between nodes\n";
-    std::cout << "  bfs <start>                    - Perform BFS traversal\n";
+    std::cout << "  removeedge <from> <to>         - Remove the edge between nodes\n";
+    std::cout << "  connected <a> <b>              - Check whether a path joins two nodes\n";
+    std::cout << "  components                     - Count connected components, check for cycles\n";
+    std::cout << "  bfs <start> [--depth N] [--parents] [--threads N]\n";
+    std::cout << "                                 - Perform BFS traversal (parents shown as node(parent))\n";
     std::cout << "  dfs <start>                    - Perform DFS traversal\n";
+    std::cout << "  shortestpath <from> <to>       - Find the lowest-weight path between nodes\n";
+    std::cout << "  distances <start>              - Show the distance to every reachable node\n";
     
     std::cout << "\nVersion Control Commands:\n";
     std::cout << "  stage <key> <value>            - Stage a change for commit\n";
@@ -85,10 +107,38 @@ void printError(const std::string& message) {
     std::cerr << "Error: " << message << std::endl;
 }
 
+// Build an indexer from a CLI spec: value, lower, length or prefix:N
+std::function<std::string(const std::string&)> makeIndexer(const std::string& spec) {
+    if (spec == "value") {
+        return [](const std::string& value) { return value; };
+    }
+    if (spec == "lower") {
+        return [](const std::string& value) {
+            std::string lowered = value;
+            std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+            return lowered;
+        };
+    }
+    if (spec == "length") {
+        return [](const std::string& value) { return std::to_string(value.size()); };
+    }
+    if (spec.rfind("prefix:", 0) == 0) {
+        size_t length = std::stoul(spec.substr(7));
+        return [length](const std::string& value) { return value.substr(0, length); };
+    }
+    return nullptr;
+}
+
 int main(int argc, char* argv[]) {
     // Database filename from command line or default
     std::string dbFilename = "data/mydb.json";
     std::string authorName = "user";
+    bool useWAL = false;
+    bool useBinarySnapshot = false;
+    size_t memoryBudgetMB = 0;
+    bool useLSM = false;
+    size_t blobThresholdKB = 0;
+    WALOptions walOptions;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -97,14 +147,54 @@ int main(int argc, char* argv[]) {
             dbFilename = argv[++i];
         } else if (arg == "--author" && i + 1 < argc) {
             authorName = argv[++i];
+        } else if (arg == "--wal") {
+            useWAL = true;
+        } else if (arg == "--wal-batch" && i + 1 < argc) {
+            walOptions.groupCommitSize = std::stoul(argv[++i]);
+        } else if (arg == "--wal-interval" && i + 1 < argc) {
+            walOptions.groupCommitIntervalMs = std::stoi(argv[++i]);
+        } else if (arg == "--wal-async") {
+            walOptions.syncOnCommit = false;
+        } else if (arg == "--binary") {
+            useBinarySnapshot = true;
+        } else if (arg == "--lsm") {
+            useLSM = true;
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            memoryBudgetMB = std::stoul(argv[++i]);
+        } else if (arg == "--blob-threshold" && i + 1 < argc) {
+            blobThresholdKB = std::stoul(argv[++i]);
         } else if (arg == "--help") {
-            std::cout << "Usage: " << argv[0] << " [--db FILENAME] [--author NAME]" << std::endl;
+            std::cout << "Usage: " << argv[0] << " [--db FILENAME] [--author NAME]"
+                      << " [--wal] [--wal-batch N] [--wal-interval MS] [--wal-async] [--binary]"
+                      << " [--memory-budget MB] [--lsm] [--blob-threshold KB]" << std::endl;
             return 0;
         }
     }
     
     // Initialize database and version control
     Database db(dbFilename);
+    if (useLSM) {
+        // The LSM engine logs every write itself, so --wal only tunes its log
+        LSMOptions lsmOptions;
+        lsmOptions.wal = walOptions;
+        if (!db.setStorageEngine(std::make_unique<LSMTree>(dbFilename + ".lsm", lsmOptions))) {
+            printError("Failed to open LSM storage at " + dbFilename + ".lsm");
+            return 1;
+        }
+        useWAL = false;
+    }
+    if (useWAL && !db.enableWAL(walOptions)) {
+        printError("Failed to open write-ahead log, falling back to full saves");
+    }
+    if (blobThresholdKB && !db.enableBlobStore(blobThresholdKB << 10)) {
+        printError("Failed to open blob file, keeping large values inline");
+    }
+    if (useBinarySnapshot) {
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+    }
+    if (memoryBudgetMB && !db.setMemoryBudget(memoryBudgetMB << 20)) {
+        printError("Failed to open value spill file, keeping every value in memory");
+    }
     if (!db.load()) {
         std::cout << "Creating new database at " << dbFilename << std::endl;
     } else {
@@ -145,7 +235,28 @@ int main(int argc, char* argv[]) {
                 
                 db.insert(key, value);
                 std::cout << "Inserted: " << key << " = " << value << std::endl;
-                db.save();
+                if (!db.isWALEnabled()) db.save();
+            }
+            else if (command == "set" && args.size() >= 3) {
+                std::string key = args[1];
+                std::string literal = args[2];
+                for (size_t i = 3; i < args.size(); i++) {
+                    literal += " " + args[i];
+                }
+
+                TypedValue value = TypedValue::parse(literal);
+                db.insertTyped(key, value);
+                std::cout << "Set: " << key << " = " << value.toString()
+                          << " (" << TypedValue::typeName(value.getType()) << ")" << std::endl;
+                if (!db.isWALEnabled()) db.save();
+            }
+            else if (command == "type" && args.size() >= 2) {
+                TypedValue value;
+                if (db.getTyped(args[1], value)) {
+                    std::cout << args[1] << ": " << TypedValue::typeName(value.getType()) << std::endl;
+                } else {
+                    std::cout << "Key not found: " << args[1] << std::endl;
+                }
             }
             else if (command == "get" && args.size() >= 2) {
                 std::string key = args[1];
@@ -161,19 +272,40 @@ int main(int argc, char* argv[]) {
                 std::string key = args[1];
                 if (db.remove(key)) {
                     std::cout << "Removed key: " << key << std::endl;
-                    db.save();
+                    if (!db.isWALEnabled()) db.save();
                 } else {
                     std::cout << "Key not found: " << key << std::endl;
                 }
             }
             else if (command == "query" && args.size() >= 2) {
                 std::string prefix = args[1];
-                auto results = db.queryByPrefix(prefix);
-                
-                std::cout << "Found " << results.size() << " keys with prefix '" << prefix << "':" << std::endl;
-                for (const auto& key : results) {
-                    std::cout << "  " << key << " = " << db.get(key) << std::endl;
+                bool reverse = (args.size() >= 3 && args[2] == "--reverse");
+                size_t found = 0;
+                for (auto cursor = db.openCursor(CursorOptions::prefix(prefix, reverse)); cursor.valid();
+                     cursor.next(), found++) {
+                    std::cout << "  " << cursor.key() << " = " << TypedValue::display(cursor.value()) << std::endl;
                 }
+                std::cout << "Found " << found << " keys with prefix '" << prefix << "'" << std::endl;
+            }
+            else if (command == "range" && args.size() >= 3) {
+                std::string lo = args[1];
+                std::string hi = (args[2] == "*") ? "" : args[2];
+                bool reverse = false;
+                size_t limit = 0;
+                for (size_t i = 3; i < args.size(); i++) {
+                    if (args[i] == "--reverse") {
+                        reverse = true;
+                    } else if (args[i] == "--limit" && i + 1 < args.size()) {
+                        limit = std::stoul(args[++i]);
+                    }
+                }
+                size_t found = 0;
+                for (auto cursor = db.openCursor(CursorOptions::range(lo, hi, reverse));
+                     cursor.valid() && (!limit || found < limit); cursor.next(), found++) {
+                    std::cout << "  " << cursor.key() << " = " << TypedValue::display(cursor.value()) << std::endl;
+                }
+                std::cout << "Found " << found << " keys in [" << lo << ", "
+                          << (hi.empty() ? "*" : hi) << ")" << std::endl;
             }
             else if (command == "queryvalue" && args.size() >= 2) {
                 std::string value = args[1];
@@ -184,6 +316,65 @@ int main(int argc, char* argv[]) {
                     std::cout << "  " << key << std::endl;
                 }
             }
+            else if (command == "querypattern" && args.size() >= 2) {
+                // The rest of the line, so a pattern may hold spaces and quotes
+                std::string pattern = commandLine.substr(commandLine.find(args[0]) + args[0].size());
+                pattern.erase(0, pattern.find_first_not_of(' '));
+                auto results = db.queryByValuePattern(pattern);
+                auto compiled = PatternCache::instance().get(pattern);
+
+                std::cout << "Found " << results.size() << " keys matching '" << pattern << "' ("
+                          << compiled->describe() << "):" << std::endl;
+                for (const auto& key : results) {
+                    std::cout << "  " << key << std::endl;
+                }
+            }
+            else if ((command == "find" || command == "explain") && args.size() >= 2) {
+                // Parse the raw text: parseCommand() would strip the query's own quotes
+                std::string text = commandLine.substr(commandLine.find(args[0]) + args[0].size());
+                Query query;
+                std::string error;
+                if (!Query::parse(text, query, error)) {
+                    printError("Bad query: " + error);
+                } else if (command == "find") {
+                    auto results = db.query(query);
+                    std::cout << "Found " << results.size() << " keys matching " << query.toString() << ":" << std::endl;
+                    for (const auto& key : results) {
+                        std::cout << "  " << key << std::endl;
+                    }
+                } else {
+                    QueryExplain explain = db.explain(query);
+                    std::cout << "Plan for " << query.toString() << ":" << std::endl;
+                    for (const auto& line : explain.plan) {
+                        std::cout << "  " << line << std::endl;
+                    }
+                    std::cout << "Rows examined: " << explain.rowsExamined
+                              << ", index keys read: " << explain.postingsRead
+                              << ", matches: " << explain.matches << std::endl;
+                }
+            }
+            else if (command == "between" && args.size() >= 3) {
+                double lo = std::stod(args[1]);
+                double hi = std::stod(args[2]);
+                size_t limit = 0;
+                if (args.size() >= 5 && args[3] == "--limit") limit = std::stoul(args[4]);
+                auto results = db.queryBetween(lo, hi, limit);
+
+                std::cout << "Found " << results.size() << " keys with values in [" << args[1] << ", "
+                          << args[2] << "]:" << std::endl;
+                for (const auto& key : results) {
+                    std::cout << "  " << key << " = " << db.get(key) << std::endl;
+                }
+            }
+            else if (command == "aggregate" && args.size() >= 2) {
+                std::string prefix = (args[1] == "*") ? "" : args[1];
+                NumericSummary summary = db.summarizeNumeric(prefix);
+                std::cout << "Numeric values under '" << args[1] << "': " << summary.count << std::endl;
+                if (summary.count) {
+                    std::cout << "  min " << summary.min << ", max " << summary.max << ", sum " << summary.sum
+                              << ", mean " << summary.mean() << std::endl;
+                }
+            }
             else if (command == "export" && args.size() >= 2) {
                 std::string filename = args[1];
                 if (db.exportTo(filename)) {
@@ -204,26 +395,119 @@ int main(int argc, char* argv[]) {
                     printError("Failed to import database");
                 }
             }
+            else if (command == "index" && args.size() >= 3) {
+                auto indexer = makeIndexer(args[2]);
+                if (!indexer) {
+                    printError("Unknown index kind: " + args[2]);
+                } else if (db.createIndex(args[1], indexer)) {
+                    std::cout << "Index " << args[1] << " created." << std::endl;
+                } else {
+                    printError("Index already exists: " + args[1]);
+                }
+            }
+            else if (command == "queryindex" && args.size() >= 3) {
+                auto results = db.queryByIndex(args[1], args[2]);
+                std::cout << "Found " << results.size() << " keys in index '" << args[1]
+                          << "' for '" << args[2] << "':" << std::endl;
+                for (const auto& key : results) {
+                    std::cout << "  " << key << std::endl;
+                }
+            }
+            else if (command == "checkpoint") {
+                if (db.checkpoint()) {
+                    std::cout << "Checkpoint written to " << dbFilename << std::endl;
+                } else {
+                    printError("Checkpoint failed");
+                }
+            }
+            else if (command == "optimize") {
+                db.optimize();
+                std::cout << "Optimized" << std::endl;
+            }
+            else if (command == "clearcache") {
+                db.clearCache();
+                std::cout << "Cache cleared" << std::endl;
+            }
             else if (command == "stats") {
+                auto stats = db.getStats();
                 std::cout << "Database statistics:" << std::endl;
-                std::cout << "  Total entries: " << db.size() << std::endl;
+                std::cout << "  Total entries: " << stats.entries << std::endl;
+                std::cout << "  Data size: " << stats.keyBytes << " key bytes, "
+                          << stats.valueBytes << " value bytes" << std::endl;
+                if (stats.hasEngine) {
+                    const auto& engine = stats.engine;
+                    std::cout << "  Storage engine: " << engine.name << ", " << engine.flushes << " flushes, "
+                              << engine.compactions << " compactions, write amplification "
+                              << std::fixed << std::setprecision(2) << engine.writeAmplification() << std::endl;
+                    for (size_t level = 0; level < engine.runsPerLevel.size(); level++) {
+                        std::cout << "    L" << level << ": " << engine.runsPerLevel[level] << " runs, "
+                                  << engine.bytesPerLevel[level] << " bytes" << std::endl;
+                    }
+                    std::cout << "    Bloom filters skipped " << engine.bloomNegatives << " of "
+                              << engine.bloomNegatives + engine.runProbes << " run probes" << std::endl;
+                } else {
+                    if (stats.valueIndexReady) {
+                        std::cout << "  Value index: " << stats.valueIndexDistinctValues << " distinct values, ~"
+                                  << stats.valueIndexBytes << " bytes" << std::endl;
+                    } else {
+                        std::cout << "  Value index: not built (built on first queryvalue)" << std::endl;
+                    }
+                    if (stats.numericIndexReady) {
+                        std::cout << "  Numeric index: " << stats.numericIndexEntries << " values, ~"
+                                  << stats.numericIndexBytes << " bytes" << std::endl;
+                    } else {
+                        std::cout << "  Numeric index: not built (built on first between/aggregate)" << std::endl;
+                    }
+                    if (stats.openSnapshots || stats.savedVersions) {
+                        std::cout << "  Read snapshots: " << stats.openSnapshots << " open, "
+                                  << stats.savedVersions << " saved versions" << std::endl;
+                    }
+                    std::cout << "  Strings: " << stats.strings.uniqueStrings << " unique, "
+                              << stats.strings.references << " references, "
+                              << stats.strings.storedBytes << " bytes stored, "
+                              << stats.strings.bytesSaved() << " bytes saved by interning" << std::endl;
+                    std::cout << "  String arena: " << stats.strings.arenaBytes << " bytes, "
+                              << stats.strings.freeBytes << " free for reuse" << std::endl;
+                    const auto& cache = stats.cache;
+                    std::cout << "  Cache: " << cache.residentValues << " values resident ("
+                              << cache.residentBytes << " bytes";
+                    if (cache.budgetBytes) std::cout << " of " << cache.budgetBytes << " budget";
+                    std::cout << "), " << cache.spilledValues << " spilled" << std::endl;
+                    if (cache.sharedBytes) {
+                        std::cout << "  Cache: " << cache.sharedBytes << " resident bytes shared with indexes, "
+                                  << "versions, commits or other keys; not evictable" << std::endl;
+                    }
+                    if (cache.budgetBytes || cache.spilledValues) {
+                        std::cout << "  Cache hits: " << cache.hits << ", misses: " << cache.misses
+                                  << " (" << std::fixed << std::setprecision(1) << cache.hitRate() * 100
+                                  << "% hit rate), evictions: " << cache.evictions << std::endl;
+                        std::cout << "  Spill file: " << cache.spillFileBytes << " bytes, "
+                                  << cache.spillGarbageBytes << " garbage" << std::endl;
+                    }
+                }
                 
-                auto distribution = db.getValueDistribution();
-                if (!distribution.empty()) {
-                    std::cout << "  Value distribution (top 5):" << std::endl;
-                    
-                    // Sort by frequency
-                    std::vector<std::pair<std::string, size_t>> sorted;
-                    for (const auto& [value, count] : distribution) {
-                        sorted.push_back({value, count});
+                if (stats.hasBlobStore) {
+                    const auto& blobs = stats.blobs;
+                    std::cout << "  Blob file: " << blobs.blobs << " blobs of " << stats.blobThreshold
+                              << "+ bytes, " << blobs.fileBytes << " bytes, " << blobs.dedupHits
+                              << " duplicates (" << blobs.bytesSaved << " bytes saved)" << std::endl;
+                }
+                if (stats.graphNodes) {
+                    std::cout << "  Graph: " << stats.graphNodes << " nodes, " << stats.graphEdges
+                              << " adjacency entries (" << stats.graphPendingEdges << " pending), ";
+                    if (stats.graphComponentsStale) {
+                        std::cout << "components not current (recounted by the next connected/components)";
+                    } else {
+                        std::cout << stats.graphComponents << " components, " << stats.graphIndependentCycles
+                                  << " independent cycles";
                     }
-                    
-                    std::sort(sorted.begin(), sorted.end(), 
-                             [](const auto& a, const auto& b) { return a.second > b.second; });
-                    
-                    int shown = 0;
-                    for (const auto& [value, count] : sorted) {
-                        if (++shown > 5) break;
+                    std::cout << ", ~" << stats.graphBytes << " bytes" << std::endl;
+                }
+
+                if (!stats.topValues.empty()) {
+                    std::cout << "  Value distribution (top " << stats.topValues.size()
+                              << (stats.topValuesExact ? "" : ", approximate") << "):" << std::endl;
+                    for (const auto& [value, count] : stats.topValues) {
                         std::cout << "    " << value << ": " << count << std::endl;
                     }
                 }
@@ -235,12 +519,41 @@ int main(int argc, char* argv[]) {
                 std::cout << "Node " << args[1] << " added.\n";
             }
             else if (command == "addedge" && args.size() >= 4) {
-                db.insertEdge(args[1], args[2], std::stoi(args[3]));
-                std::cout << "Edge added between " << args[1] << " and " << args[2] << ".\n";
+                bool closesCycle = db.insertEdge(args[1], args[2], std::stoi(args[3]));
+                std::cout << "Edge added between " << args[1] << " and " << args[2]
+                          << (closesCycle ? " (closes a cycle).\n" : ".\n");
+            }
+            else if (command == "removeedge" && args.size() >= 3) {
+                if (db.removeEdge(args[1], args[2])) {
+                    std::cout << "Edge removed between " << args[1] << " and " << args[2] << ".\n";
+                } else {
+                    printError("No edge between " + args[1] + " and " + args[2]);
+                }
+            }
+            else if (command == "connected" && args.size() >= 3) {
+                std::cout << args[1] << " and " << args[2]
+                          << (db.connected(args[1], args[2]) ? " are connected.\n" : " are not connected.\n");
+            }
+            else if (command == "components") {
+                auto sizes = db.componentSizes();
+                std::cout << sizes.size() << " components" << (db.hasCycle() ? ", with cycles" : ", no cycles");
+                if (!sizes.empty()) std::cout << "; largest:";
+                for (size_t i = 0; i < std::min<size_t>(sizes.size(), 10); i++) std::cout << " " << sizes[i];
+                std::cout << "\n";
             }
             else if (command == "bfs" && args.size() >= 2) {
-                auto result = db.bfs(args[1]);
-                for (const auto& node : result) std::cout << node << " ";
+                BfsOptions options;
+                for (size_t i = 2; i < args.size(); i++) {
+                    if (args[i] == "--depth" && i + 1 < args.size()) options.maxDepth = std::stoul(args[++i]);
+                    else if (args[i] == "--threads" && i + 1 < args.size()) options.threads = std::stoul(args[++i]);
+                    else if (args[i] == "--parents") options.parents = true;
+                }
+                auto result = db.bfs(args[1], options);
+                for (size_t i = 0; i < result.nodes.size(); i++) {
+                    std::cout << result.nodes[i];
+                    if (options.parents && i) std::cout << "(" << result.parents[i] << ")";
+                    std::cout << " ";
+                }
                 std::cout << "\n";
             }
             else if (command == "dfs" && args.size() >= 2) {
@@ -248,6 +561,22 @@ int main(int argc, char* argv[]) {
                 for (const auto& node : result) std::cout << node << " ";
                 std::cout << "\n";
             }
+            else if (command == "shortestpath" && args.size() >= 3) {
+                auto path = db.shortestPath(args[1], args[2]);
+                if (path.found) {
+                    for (size_t i = 0; i < path.nodes.size(); i++) {
+                        std::cout << (i ? " -> " : "") << path.nodes[i];
+                    }
+                    std::cout << " (distance " << path.distance << ")\n";
+                } else {
+                    std::cout << "No path from " << args[1] << " to " << args[2] << ".\n";
+                }
+            }
+            else if (command == "distances" && args.size() >= 2) {
+                auto reached = db.shortestDistances(args[1]);
+                if (reached.empty()) std::cout << "Node " << args[1] << " not found.\n";
+                for (const auto& [node, distance] : reached) std::cout << "  " << node << ": " << distance << "\n";
+            }
             
             
             // Version control commands
@@ -390,6 +719,11 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // 🛠️ In WAL mode this is a checkpoint, so the next start has no log to replay
+    if (!db.save()) {
+        printError("Failed to save database to " + dbFilename);
+        return 1;
+    }
     std::cout << "Exiting. Database saved." << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal assert-style harness: CHECK records a failure and carries on, so one run
+// reports every broken expectation; runTests() returns the process exit code.
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            testFailures()++;                                                              \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                  \
+    do {                                                                            \
+        auto&& checkActual = (actual);                                              \
+        auto&& checkExpected = (expected);                                          \
+        if (!(checkActual == checkExpected)) {                                      \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " \
+                      << #expected ") failed\n";                                    \
+            testFailures()++;                                                       \
+        }                                                                           \
+    } while (0)
+
+struct TestCase {
+    const char* name;
+    std::function<void()> run;
+};
+
+// 🛠️ Run every case in order and report which ones failed
+inline int runTests(const std::vector<TestCase>& cases) {
+    int failedCases = 0;
+    for (const auto& test : cases) {
+        int before = testFailures();
+        auto start = std::chrono::steady_clock::now();
+        test.run();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        bool passed = testFailures() == before;
+        if (!passed) failedCases++;
+        std::cout << (passed ? "[PASS] " : "[FAIL] ") << test.name << " (" << elapsed.count() << " ms)" << std::endl;
+    }
+    std::cout << (cases.size() - failedCases) << "/" << cases.size() << " passed" << std::endl;
+    return failedCases == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// A fresh directory under the system temp dir, removed with everything in it
+class TempDir {
+public:
+    TempDir() {
+        std::string pattern = (std::filesystem::temp_directory_path() / "versioned-db-test-XXXXXX").string();
+        if (!mkdtemp(pattern.data())) {
+            std::cerr << "Cannot create a temporary directory" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        path = pattern;
+    }
+    ~TempDir() {
+        std::error_code ignored;
+        std::filesystem::remove_all(path, ignored);
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    std::string file(const std::string& name) const { return (path / name).string(); }
+
+private:
+    std::filesystem::path path;
+};
+
+#endif
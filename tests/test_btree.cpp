@@ -0,0 +1,174 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/BTree.h"
+#include "TestSupport.h"
+#include <random>
+#include <set>
+
+// B+tree tests: a tree bulk loaded from sorted keys must behave exactly like one built
+// by inserting the same keys one at a time, before and after further updates.
+
+namespace {
+
+// Keys sharing long prefixes, so searches fall back to full comparisons on prefix ties
+std::vector<std::string> makeKeys(size_t n, std::mt19937& rng) {
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        switch (rng() % 3) {
+            case 0: keys.push_back("user:" + std::to_string(rng() % (n * 4 + 1))); break;
+            case 1: keys.push_back("user:profile:" + std::to_string(rng() % (n + 1))); break;
+            default: keys.push_back(std::string(1, static_cast<char>('a' + rng() % 26)) + std::to_string(i)); break;
+        }
+    }
+    return keys;
+}
+
+template <typename Tree>
+std::vector<std::string> forward(const Tree& tree) {
+    std::vector<std::string> keys;
+    for (auto it = tree.begin(); it != tree.end(); ++it) keys.push_back(*it);
+    return keys;
+}
+
+template <typename Tree>
+std::vector<std::string> backward(const Tree& tree) {
+    std::vector<std::string> keys;
+    if (tree.empty()) return keys;
+    auto it = tree.end();
+    do {
+        --it;
+        keys.push_back(*it);
+    } while (it != tree.begin());
+    return keys;
+}
+
+// 🛠️ Compare a tree with the model: size, both walk directions, lookups and scans
+template <typename Tree>
+void checkAgainst(const Tree& tree, const std::set<std::string>& model, const std::vector<std::string>& probes) {
+    CHECK_EQ(tree.size(), model.size());
+    std::vector<std::string> ordered(model.begin(), model.end());
+    CHECK(forward(tree) == ordered);
+    CHECK(backward(tree) == std::vector<std::string>(ordered.rbegin(), ordered.rend()));
+    for (const auto& probe : probes) {
+        CHECK_EQ(tree.contains(probe), model.count(probe) > 0);
+        auto expected = model.lower_bound(probe);
+        auto found = tree.lowerBound(probe);
+        CHECK(expected == model.end() ? found == tree.end() : found != tree.end() && *found == *expected);
+    }
+    for (std::string prefix : {"", "user:", "user:1", "user:profile:2", "b", "zz"}) {
+        std::vector<std::string> expected;
+        for (auto it = model.lower_bound(prefix); it != model.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+            expected.push_back(*it);
+        }
+        CHECK(tree.rangeSearch(prefix) == expected);
+    }
+}
+
+template <size_t Capacity>
+void compareBulkLoadWithInserts(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> keys = makeKeys(n, rng);  // With repeats
+    std::vector<std::string> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    std::set<std::string> model(keys.begin(), keys.end());
+
+    BTree<std::string, Capacity> bulk(sorted.begin(), sorted.end());
+    BTree<std::string, Capacity> inserted;
+    for (const auto& key : keys) {
+        bool fresh = !inserted.contains(key);
+        CHECK_EQ(inserted.insert(key), fresh);
+    }
+
+    std::vector<std::string> probes = makeKeys(200, rng);
+    probes.insert(probes.end(), keys.begin(), keys.begin() + std::min<size_t>(keys.size(), 200));
+    probes.push_back("");
+    probes.push_back("~");
+    checkAgainst(bulk, model, probes);
+    checkAgainst(inserted, model, probes);
+    CHECK(bulk.memoryUsage() <= inserted.memoryUsage());  // Packed leaves need no more nodes
+
+    // The packed tree must split, borrow and merge like any other
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size() / 2; i++) {
+        bool present = model.erase(keys[i]) > 0;
+        CHECK_EQ(bulk.remove(keys[i]), present);
+        CHECK_EQ(inserted.remove(keys[i]), present);
+    }
+    for (const auto& key : makeKeys(n / 2, rng)) {
+        bool added = model.insert(key).second;
+        CHECK_EQ(bulk.insert(key), added);
+        CHECK_EQ(inserted.insert(key), added);
+    }
+    checkAgainst(bulk, model, probes);
+    checkAgainst(inserted, model, probes);
+
+    for (const auto& key : std::vector<std::string>(model.begin(), model.end())) {
+        CHECK(bulk.remove(key));
+        CHECK(inserted.remove(key));
+    }
+    CHECK(bulk.empty() && bulk.begin() == bulk.end());
+    CHECK(inserted.empty() && inserted.begin() == inserted.end());
+}
+
+void testSmallTrees() {
+    for (size_t n : {0, 1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 33}) compareBulkLoadWithInserts<4>(n, static_cast<uint32_t>(n));
+    for (size_t n : {31, 32, 33, 64, 65}) compareBulkLoadWithInserts<32>(n, static_cast<uint32_t>(n));
+}
+
+void testLargeTrees() {
+    compareBulkLoadWithInserts<4>(5000, 7);
+    compareBulkLoadWithInserts<32>(50000, 11);
+}
+
+void testBulkLoadKeepsRepeatsOnce() {
+    std::vector<std::string> sorted = {"a", "a", "b", "b", "b", "c"};
+    BTree<std::string, 4> tree(sorted.begin(), sorted.end());
+    CHECK_EQ(tree.size(), size_t(3));
+    CHECK(forward(tree) == std::vector<std::string>({"a", "b", "c"}));
+    CHECK(!tree.insert("b"));
+}
+
+template <size_t Capacity>
+void compareSortedRuns(size_t rounds, size_t maxRun, uint32_t seed) {
+    std::mt19937 rng(seed);
+    BTree<std::string, Capacity> tree;
+    std::set<std::string> model;
+    for (size_t round = 0; round < rounds; round++) {
+        // Runs both far smaller and far larger than the tree, so both paths are taken
+        std::vector<std::string> run = makeKeys(rng() % 3 ? 1 + rng() % 8 : rng() % (maxRun + 1), rng);
+        if (!model.empty()) run.push_back(*model.begin());  // Already present
+        std::sort(run.begin(), run.end());
+        size_t fresh = 0;
+        for (const auto& key : run) fresh += model.insert(key).second;
+        CHECK_EQ(tree.insertSorted(run.begin(), run.end()), fresh);
+
+        // Removes leave underfull and emptied trees for the next run to merge with
+        std::vector<std::string> present(model.begin(), model.end());
+        size_t removals = round % 5 == 4 ? present.size() : rng() % (present.size() / 2 + 1);
+        std::shuffle(present.begin(), present.end(), rng);
+        for (size_t i = 0; i < removals; i++) {
+            CHECK(tree.remove(present[i]));
+            model.erase(present[i]);
+        }
+        checkAgainst(tree, model, makeKeys(50, rng));
+    }
+    std::vector<std::string> probes(model.begin(), model.end());
+    checkAgainst(tree, model, probes);
+    for (const auto& key : makeKeys(100, rng)) CHECK_EQ(tree.insert(key), model.insert(key).second);
+    checkAgainst(tree, model, probes);
+}
+
+void testSortedRuns() {
+    compareSortedRuns<4>(200, 60, 3);
+    compareSortedRuns<32>(100, 3000, 5);
+}
+
+}  // namespace
+
+int main() {
+    return runTests({
+        {"small bulk-loaded trees match inserted ones", testSmallTrees},
+        {"large bulk-loaded trees match inserted ones", testLargeTrees},
+        {"bulk load keeps repeated keys once", testBulkLoadKeepsRepeatsOnce},
+        {"sorted runs insert like single keys", testSortedRuns},
+    });
+}
@@ -0,0 +1,1249 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/BlobStore.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Database.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/LSMTree.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Query.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Snapshot.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <random>
+#include <regex>
+#include <set>
+#include <thread>
+
+// Database tests. A Database dropped without save() stands in for a crash: its
+// destructor only stops the checkpointer and closes the log, so whatever survives is
+// what the snapshot and the write-ahead log hold on disk.
+
+namespace {
+
+// Closing the log flushes it, so a dropped Database leaves every record in the file
+// without the tests paying an fsync per write
+WALOptions quietWAL() {
+    WALOptions options;
+    options.syncOnCommit = false;
+    options.checkpointBytes = SIZE_MAX;  // No background checkpoints unless a test asks
+    return options;
+}
+
+// 🛠️ Every entry, sorted, for comparing two databases
+std::vector<std::pair<std::string, std::string>> contents(const Database& db) {
+    auto all = db.getAllData();
+    std::vector<std::pair<std::string, std::string>> sorted(all.begin(), all.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void testWALReplaysEveryOperation() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        for (int i = 0; i < 100; i++) db.insert("key" + std::to_string(i), "value" + std::to_string(i));
+        db.insert("key7", "rewritten");
+        CHECK(db.remove("key8"));
+        CHECK(db.batchInsert(std::unordered_map<std::string, std::string>{{"batch:a", "1"}, {"batch:b", "2"}}));
+        CHECK(db.batchRemove({"key9", "key10"}));
+    }
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK_EQ(db.size(), size_t(99));
+    CHECK_EQ(db.get("key0"), std::string("value0"));
+    CHECK_EQ(db.get("key7"), std::string("rewritten"));
+    CHECK_EQ(db.get("key8"), std::string(""));
+    CHECK_EQ(db.get("key9"), std::string(""));
+    CHECK_EQ(db.get("batch:b"), std::string("2"));
+    CHECK_EQ(db.queryByPrefix("batch:").size(), size_t(2));  // Indexes are rebuilt after replay
+}
+
+void testWALDropsTornTail() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        db.insert("a", "1");
+        db.insert("b", "2");
+    }
+    {
+        // A record cut short by the crash: a length prefix promising more than follows
+        std::ofstream log(path + ".wal", std::ios::binary | std::ios::app);
+        log.write("\x40\x00\x00\x00\x12\x34", 6);
+    }
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        CHECK(db.load());
+        CHECK_EQ(db.size(), size_t(2));
+        db.insert("c", "3");  // Must land after the truncated tail, not behind it
+    }
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK_EQ(db.size(), size_t(3));
+    CHECK_EQ(db.get("c"), std::string("3"));
+}
+
+void testCheckpointThenCrash() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        for (int i = 0; i < 50; i++) db.insert("before" + std::to_string(i), "x");
+        CHECK(db.checkpoint());
+        for (int i = 0; i < 50; i++) db.insert("after" + std::to_string(i), "y");
+        db.remove("before0");
+        expected = contents(db);
+    }
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK(contents(db) == expected);
+}
+
+void testInterruptedCheckpointIsRecovered() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        for (int i = 0; i < 20; i++) db.insert("old" + std::to_string(i), "1");
+    }
+    // Crash between rotating the log and writing the snapshot: only the rotated log is left
+    std::filesystem::rename(path + ".wal", path + ".wal.ckpt");
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        CHECK(db.load());
+        CHECK_EQ(db.size(), size_t(20));
+        db.insert("new", "2");
+        CHECK(db.checkpoint());  // Folds the leftover rotated log in as well
+        db.insert("newer", "3");
+    }
+    CHECK(!std::filesystem::exists(path + ".wal.ckpt"));
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK_EQ(db.size(), size_t(22));
+    CHECK_EQ(db.get("old19"), std::string("1"));
+    CHECK_EQ(db.get("newer"), std::string("3"));
+}
+
+void testNoCheckpointBeforeLoad() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        for (int i = 0; i < 500; i++) db.insert("k" + std::to_string(i), "v");
+    }
+    {
+        // The log is far past the checkpoint threshold; the checkpointer must wait for load()
+        WALOptions eager = quietWAL();
+        eager.checkpointBytes = 1;
+        eager.checkpointIntervalMs = 10;
+        Database db(path);
+        CHECK(db.enableWAL(eager));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CHECK(db.load());
+        CHECK_EQ(db.size(), size_t(500));
+        CHECK(db.checkpoint());
+    }
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK_EQ(db.size(), size_t(500));
+}
+
+void testBinarySnapshotReload() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+        Database db(path);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        for (int i = 0; i < 1000; i++) db.insert("user:" + std::to_string(i), "name" + std::to_string(i % 37));
+        db.insert("bytes", std::string("a\0b\xff", 4));
+        db.insert("empty", "");
+        db.insertTyped("count", TypedValue::ofInteger(42));
+        CHECK(db.save());
+        expected = contents(db);
+    }
+    CHECK(BinarySnapshot::isBinarySnapshot(path));
+
+    Database db(path);
+    CHECK(db.load());
+    CHECK(db.getSnapshotFormat() == SnapshotFormat::BINARY);  // Detected from the file
+    CHECK(contents(db) == expected);
+    CHECK_EQ(db.get("bytes"), std::string("a\0b\xff", 4));
+    TypedValue count;
+    CHECK(db.getTyped("count", count));
+    CHECK(count.getType() == INTEGER && count.asInteger() == 42);
+    CHECK_EQ(db.queryByValue("name5").size(), size_t(27));
+    auto range = db.queryRange("user:10", "user:11");
+    CHECK_EQ(range.size(), size_t(11));  // user:10, user:100 ... user:109
+    CHECK(std::is_sorted(range.begin(), range.end()));
+}
+
+void testWritesOverMappedSnapshot() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    {
+        Database db(path);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        for (int i = 0; i < 100; i++) db.insert("k" + std::to_string(i), "old");
+        CHECK(db.save());
+    }
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+        Database db(path);
+        CHECK(db.load());
+        db.insert("k5", "new");
+        CHECK(db.remove("k6"));
+        CHECK(!db.remove("k6"));
+        db.insert("k100", "added");
+        CHECK_EQ(db.size(), size_t(100));
+        CHECK_EQ(db.get("k5"), std::string("new"));
+        CHECK_EQ(db.get("k6"), std::string(""));
+        auto keys = db.queryByPrefix("k");
+        CHECK_EQ(keys.size(), size_t(100));
+        CHECK(std::find(keys.begin(), keys.end(), "k6") == keys.end());
+        CHECK(db.save());  // Replaces the file the data is mapped from
+        expected = contents(db);
+    }
+
+    Database db(path);
+    CHECK(db.load());
+    CHECK(contents(db) == expected);
+}
+
+void testBinaryCheckpointRecovery() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+        Database db(path);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        for (int i = 0; i < 200; i++) db.insert("a" + std::to_string(i), "1");
+        CHECK(db.checkpoint());
+        db.insert("a0", "2");
+        db.remove("a1");
+        expected = contents(db);
+    }
+    CHECK(BinarySnapshot::isBinarySnapshot(path));
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK(contents(db) == expected);
+}
+
+// 🛠️ Write `rows` as NDJSON, each value a JSON literal
+void writeNDJSON(const std::string& path, const std::vector<std::pair<std::string, std::string>>& rows) {
+    std::ofstream out(path);
+    for (const auto& [key, value] : rows) out << "{\"key\": \"" << key << "\", \"value\": " << value << "}\n";
+}
+
+void testImportIsLogged() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    std::vector<std::pair<std::string, std::string>> rows;
+    for (int i = 0; i < 10000; i++) {  // Several import batches
+        rows.emplace_back("row" + std::to_string(i), i % 2 ? std::to_string(i) : "\"text" + std::to_string(i) + "\"");
+    }
+    rows.emplace_back("row7", "\"last wins\"");
+    writeNDJSON(dir.file("replace.ndjson"), rows);
+    writeNDJSON(dir.file("merge.ndjson"), {{"merged", "true"}, {"row1", "-1"}});
+    {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        db.load();
+        db.insert("before", "wiped by the import");
+        CHECK(db.save());
+        db.insert("logged", "wiped too");
+        CHECK(db.importFrom(dir.file("replace.ndjson")));
+        CHECK(db.importFrom(dir.file("merge.ndjson"), true));
+        db.insert("after", "kept");
+    }
+
+    Database db(path);
+    CHECK(db.enableWAL(quietWAL()));
+    CHECK(db.load());
+    CHECK_EQ(db.size(), size_t(10002));
+    CHECK_EQ(db.get("before"), std::string(""));
+    CHECK_EQ(db.get("logged"), std::string(""));
+    CHECK_EQ(db.get("row0"), std::string("text0"));
+    CHECK_EQ(db.get("row1"), std::string("-1"));
+    CHECK_EQ(db.get("row7"), std::string("last wins"));
+    CHECK_EQ(db.get("row9999"), std::string("9999"));
+    CHECK_EQ(db.get("merged"), std::string("true"));
+    CHECK_EQ(db.get("after"), std::string("kept"));
+    TypedValue typed = TypedValue::ofString("");
+    CHECK(db.getTyped("row3", typed) && typed.getType() == INTEGER);
+    CHECK_EQ(db.queryByPrefixBTree("row999").size(), size_t(11));
+}
+
+// 🛠️ Sorted copy, for comparing query results that come back in any order
+std::vector<std::string> sorted(std::vector<std::string> values) {
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+void testImportKeepsValueIndex() {
+    TempDir dir;
+    Database db(dir.file("db.json"));
+    db.insert("a", "apple");
+    db.insert("b", "banana");
+    CHECK(db.queryByValueBTree("ap") == std::vector<std::string>{"apple"});  // Builds the index
+
+    writeNDJSON(dir.file("fruit.ndjson"), {{"c", "\"apricot\""}, {"d", "\"application\""}, {"e", "\"cherry\""}});
+    CHECK(db.importFrom(dir.file("fruit.ndjson"), true));
+    CHECK(sorted(db.queryByValueBTree("ap")) == (std::vector<std::string>{"apple", "application", "apricot"}));
+    CHECK(db.queryByValueBTree("ch") == std::vector<std::string>{"cherry"});
+
+    // A replacing import drops the old values from the index along with the table
+    writeNDJSON(dir.file("veg.ndjson"), {{"f", "\"apio\""}, {"g", "\"carrot\""}});
+    CHECK(db.importFrom(dir.file("veg.ndjson")));
+    CHECK(db.queryByValueBTree("ap") == std::vector<std::string>{"apio"});
+    CHECK(db.queryByValueBTree("ch").empty());
+    CHECK(db.queryByPrefixBTree("") == (std::vector<std::string>{"f", "g"}));
+}
+
+// 🛠️ A typed value of a random kind; numbers repeat often enough to tie in value order
+TypedValue randomTyped(std::mt19937& rng) {
+    switch (rng() % 8) {
+        case 0:
+        case 1:
+        case 2: return TypedValue::ofInteger(static_cast<int64_t>(rng() % 200) - 100);
+        case 3:
+        case 4: return TypedValue::ofFloat((static_cast<double>(rng() % 4000) - 2000) / 16.0);
+        case 5: return TypedValue::ofBoolean(rng() % 2);
+        case 6: return TypedValue::ofString(std::to_string(rng() % 50));  // Numeric-looking text stays text
+        default: return TypedValue::ofArray("[" + std::to_string(rng() % 10) + "]");
+    }
+}
+
+void testTypedJSONRoundTrip() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    std::map<std::string, std::string> encoded;  // key -> TypedValue::encode()
+    {
+        Database db(path);
+        std::vector<TypedValue> values = {
+            TypedValue::ofInteger(-42), TypedValue::ofInteger(INT64_MAX), TypedValue::ofFloat(2.5),
+            TypedValue::ofFloat(-0.125), TypedValue::ofBoolean(true), TypedValue::ofBoolean(false),
+            TypedValue::ofString("17"), TypedValue::ofString("true"), TypedValue::ofString(""),
+            TypedValue::ofString(std::string(1, TypedValue::MARKER) + "not a header"),
+            TypedValue::ofArray("[1,\"two\",[3]]"), TypedValue::ofObject("{\"a\":{\"b\":null}}"),
+        };
+        for (size_t i = 0; i < values.size(); i++) {
+            db.insertTyped("t" + std::to_string(i), values[i]);
+            encoded["t" + std::to_string(i)] = values[i].encode();
+        }
+        db.insert("plain", "12");  // insert() keeps text as text
+        encoded["plain"] = TypedValue::ofString("12").encode();
+        CHECK(db.save());
+        CHECK(db.exportTo(dir.file("export.ndjson")));
+    }
+
+    auto checkTypes = [&](const Database& db) {
+        CHECK_EQ(db.size(), encoded.size());
+        for (const auto& [key, expected] : encoded) {
+            TypedValue value = TypedValue::ofString("");
+            CHECK(db.getTyped(key, value));
+            CHECK_EQ(value.encode(), expected);
+            CHECK_EQ(db.get(key), TypedValue::decode(expected).toString());
+        }
+    };
+    Database reloaded(path);
+    CHECK(reloaded.load());
+    checkTypes(reloaded);
+
+    Database imported(dir.file("imported.json"));
+    CHECK(imported.importFrom(dir.file("export.ndjson")));
+    checkTypes(imported);
+}
+
+// 🛠️ Compare queryBetween and summarizeNumeric with the model (key -> number) on random
+// ranges, limits and prefixes
+void checkNumericQueries(const Database& db, const std::map<std::string, double>& model, std::mt19937& rng) {
+    std::vector<std::pair<double, std::string>> byValue;
+    for (const auto& [key, value] : model) byValue.emplace_back(value, key);
+    std::sort(byValue.begin(), byValue.end());
+
+    for (int probe = 0; probe < 40; probe++) {
+        double lo = (static_cast<double>(rng() % 300) - 150) / 1.5;
+        double hi = lo + static_cast<double>(rng() % 100);
+        size_t limit = rng() % 3 ? 0 : 1 + rng() % 20;
+        std::vector<std::string> expected;
+        for (const auto& [value, key] : byValue) {
+            if (value < lo || value > hi) continue;
+            if (limit && expected.size() == limit) break;
+            expected.push_back(key);
+        }
+        CHECK(db.queryBetween(lo, hi, limit) == expected);
+
+        std::string prefix = "n" + std::to_string(rng() % 12);
+        if (probe % 10 == 0) prefix = "n";
+        NumericSummary summary;
+        for (const auto& [key, value] : model) {
+            if (key.compare(0, prefix.size(), prefix) == 0) summary.add(value);
+        }
+        NumericSummary actual = db.summarizeNumeric(prefix);
+        CHECK_EQ(actual.count, summary.count);
+        CHECK_EQ(actual.min, summary.min);
+        CHECK_EQ(actual.max, summary.max);
+        CHECK(std::abs(actual.sum - summary.sum) <= 1e-9 * std::max(1.0, std::abs(summary.sum)));
+    }
+}
+
+// 🛠️ Random typed writes and removes over keys n0..n<keys>; numeric ones go in the model
+void numericChurn(Database& db, std::map<std::string, double>& model, std::mt19937& rng, int ops, size_t keys) {
+    for (int i = 0; i < ops; i++) {
+        std::string key = "n" + std::to_string(rng() % keys);
+        if (rng() % 6 == 0) {
+            db.remove(key);
+            model.erase(key);
+            continue;
+        }
+        TypedValue value = randomTyped(rng);
+        db.insertTyped(key, value);
+        if (value.isNumeric()) model[key] = value.asDouble();
+        else model.erase(key);
+    }
+}
+
+void testNumericQueriesMatchModel() {
+    TempDir dir;
+    std::mt19937 rng(29);
+    {
+        // In memory: the index is built on the first query, then kept by every write
+        Database db(dir.file("db.json"));
+        std::map<std::string, double> model;
+        numericChurn(db, model, rng, 3000, 1500);
+        checkNumericQueries(db, model, rng);
+        for (int round = 0; round < 5; round++) {
+            numericChurn(db, model, rng, 1000, 1500);
+            std::unordered_map<std::string, std::string> batch;
+            for (int i = 0; i < 50; i++) batch["n" + std::to_string(rng() % 1500)] = "text";
+            CHECK(db.batchInsert(batch));
+            for (const auto& [key, _] : batch) model.erase(key);
+            checkNumericQueries(db, model, rng);
+        }
+    }
+    {
+        // Storage engine: answered by scans
+        std::string path = dir.file("engine.json");
+        LSMOptions options;
+        options.memtableBytes = 8192;
+        options.wal = quietWAL();
+        Database db(path);
+        CHECK(db.setStorageEngine(std::make_unique<LSMTree>(path + ".lsm", options)));
+        std::map<std::string, double> model;
+        numericChurn(db, model, rng, 3000, 1500);
+        checkNumericQueries(db, model, rng);
+    }
+}
+
+void testValuePrefixSeesShownValues() {
+    TempDir dir;
+    auto fill = [](Database& db) {
+        db.insertTyped("int", TypedValue::ofInteger(123));
+        db.insertTyped("float", TypedValue::ofFloat(12.5));
+        db.insertTyped("flag", TypedValue::ofBoolean(true));
+        db.insertTyped("list", TypedValue::ofArray("[12,3]"));
+        db.insert("text", "12 apples");
+        db.insert("story", "true story");
+    };
+    auto check = [](const Database& db) {
+        CHECK(sorted(db.queryByValueBTree("12")) == (std::vector<std::string>{"12 apples", "12.5", "123"}));
+        CHECK(sorted(db.queryByValueBTree("tru")) == (std::vector<std::string>{"true", "true story"}));
+        CHECK(db.queryByValueBTree("[12") == std::vector<std::string>{"[12,3]"});
+    };
+
+    Database db(dir.file("db.json"));
+    fill(db);
+    check(db);  // Builds the value B-Tree
+    db.insertTyped("later", TypedValue::ofInteger(1200));
+    CHECK(sorted(db.queryByValueBTree("120")) == std::vector<std::string>{"1200"});
+
+    // Served from a mapped binary snapshot
+    std::string binary = dir.file("db.bin");
+    {
+        Database saved(binary);
+        saved.setSnapshotFormat(SnapshotFormat::BINARY);
+        fill(saved);
+        CHECK(saved.save());
+    }
+    Database mapped(binary);
+    CHECK(mapped.load());
+    check(mapped);
+
+    std::string path = dir.file("engine.json");
+    LSMOptions options;
+    options.wal = quietWAL();
+    Database engine(path);
+    CHECK(engine.setStorageEngine(std::make_unique<LSMTree>(path + ".lsm", options)));
+    fill(engine);
+    check(engine);
+}
+
+void testBlobStoreDeduplicates() {
+    TempDir dir;
+    BlobStore store(dir.file("values.blobs"), false);
+    CHECK(store.open());
+    std::string first(300, 'a'), second(300, 'b');
+    BlobRef a, again, b, found;
+    CHECK(store.put(first, a));
+    CHECK(store.put(first, again));
+    CHECK(store.put(second, b));
+    CHECK_EQ(again.offset, a.offset);
+    CHECK_EQ(again.hash, a.hash);
+    CHECK(b.offset != a.offset);
+    CHECK_EQ(std::string(store.view(a)), first);
+    CHECK_EQ(std::string(store.view(b)), second);
+
+    CHECK(store.find(second, found));
+    CHECK_EQ(found.offset, b.offset);
+    CHECK(!store.find(std::string(300, 'c'), found));
+
+    BlobStoreStats stats = store.stats();
+    CHECK_EQ(stats.blobs, size_t(2));
+    CHECK_EQ(stats.dedupHits, uint64_t(1));
+    CHECK_EQ(stats.bytesSaved, uint64_t(300));
+    CHECK_EQ(stats.fileBytes, static_cast<uint64_t>(std::filesystem::file_size(store.getPath())));
+}
+
+void testBlobStoreDropsTornTail() {
+    TempDir dir;
+    std::string path = dir.file("values.blobs");
+    std::vector<std::string> values = {std::string(500, 'x'), std::string(700, 'y')};
+    std::vector<BlobRef> refs(values.size());
+    uint64_t intact;
+    {
+        BlobStore store(path, false);
+        CHECK(store.open());
+        for (size_t i = 0; i < values.size(); i++) CHECK(store.put(values[i], refs[i]));
+        intact = store.stats().fileBytes;
+    }
+    for (size_t torn : {size_t(5), size_t(30)}) {
+        {
+            // A blob cut short by the crash: part of a header, or a header promising
+            // more bytes than follow
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            std::string tail(torn, '\x7f');
+            file.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        }
+        BlobStore store(path, false);
+        CHECK(store.open());
+        CHECK_EQ(store.stats().fileBytes, intact);
+        CHECK_EQ(static_cast<uint64_t>(std::filesystem::file_size(path)), intact);
+        CHECK_EQ(store.stats().blobs, values.size());
+        for (size_t i = 0; i < values.size(); i++) CHECK_EQ(std::string(store.view(refs[i])), values[i]);
+        BlobRef found;
+        CHECK(store.find(values[1], found));
+        CHECK_EQ(found.offset, refs[1].offset);
+    }
+
+    BlobRef later;
+    {
+        BlobStore store(path, false);
+        CHECK(store.open());
+        CHECK(store.put(std::string(100, 'z'), later));  // Lands where the torn tail was
+        CHECK(later.offset > intact && later.offset < intact + 32);
+    }
+    BlobStore store(path, false);
+    CHECK(store.open());
+    CHECK_EQ(store.stats().blobs, size_t(3));
+    CHECK_EQ(std::string(store.view(later)), std::string(100, 'z'));
+    CHECK_EQ(std::string(store.view(refs[0])), values[0]);
+}
+
+// 🛠️ The bytes [offset, offset + length) of a file
+std::string readRange(const std::string& path, uint64_t offset, uint64_t length) {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    std::string bytes(length, '\0');
+    file.read(bytes.data(), static_cast<std::streamsize>(length));
+    return file ? bytes : std::string();
+}
+
+void testBlobViewsAndLocations() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    std::string big = "blob:" + std::string(400, 'q');
+    Database db(path);
+    CHECK(db.enableBlobStore(64));
+    db.load();
+    db.insert("big", big);
+    db.insert("copy", big);
+    db.insert("small", "tiny");
+    db.insertTyped("list", TypedValue::ofArray("[" + std::string(200, '1') + "]"));
+
+    std::string_view view;
+    std::string scratch;
+    CHECK(db.getView("big", view, scratch));
+    CHECK_EQ(std::string(view), big);
+    CHECK(view.data() < scratch.data() || view.data() >= scratch.data() + scratch.size());  // In the mapping
+
+    uint64_t offset = 0, length = 0;
+    CHECK(db.locateBlob("big", offset, length));
+    CHECK_EQ(length, static_cast<uint64_t>(big.size()));
+    CHECK_EQ(readRange(path + ".blobs", offset, length), big);
+    CHECK(db.locateBlob("list", offset, length));
+    CHECK_EQ(readRange(path + ".blobs", offset, length), db.get("list"));
+    CHECK(!db.locateBlob("small", offset, length));
+    CHECK(!db.locateBlob("missing", offset, length));
+    CHECK(db.getView("small", view, scratch));
+    CHECK_EQ(std::string(view), std::string("tiny"));
+
+    BlobStoreStats stats = db.getBlobStore()->stats();
+    CHECK_EQ(stats.blobs, size_t(2));
+    CHECK_EQ(stats.dedupHits, uint64_t(1));
+    CHECK(db.queryByValueBTree("blob:q") == std::vector<std::string>{big});  // Distinct values
+    CHECK(db.queryByValueBTree("[11") == std::vector<std::string>{db.get("list")});
+}
+
+void testLoadOpensBlobFile() {
+    TempDir dir;
+    std::string big(300, 'w');
+    std::string logged = dir.file("logged.json");
+    {
+        Database db(logged);
+        CHECK(db.enableWAL(quietWAL()));
+        CHECK(db.enableBlobStore(64));
+        db.load();
+        db.insert("big", big);
+        db.insert("small", "s");
+    }
+    std::string binary = dir.file("db.bin");
+    {
+        Database db(binary);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        CHECK(db.enableBlobStore(64));
+        db.load();
+        db.insert("big", big);
+        db.insert("small", "s");
+        CHECK(db.save());
+    }
+
+    // Started without a threshold, each finds the blob file its references point into
+    for (const std::string& path : {logged, binary}) {
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        CHECK(db.load());
+        CHECK(db.hasBlobStore());
+        CHECK_EQ(db.get("big"), big);
+        CHECK_EQ(db.get("small"), std::string("s"));
+        CHECK(db.queryByValueBTree("ww") == std::vector<std::string>{big});
+    }
+
+    // Without the file those references cannot be resolved, so loading must fail
+    // rather than hand out reference bytes as values
+    for (const std::string& path : {logged, binary}) {
+        std::filesystem::remove(path + ".blobs");
+        Database db(path);
+        CHECK(db.enableWAL(quietWAL()));
+        CHECK(!db.load());
+    }
+}
+
+// 🛠️ A read snapshot's entries, sorted, with values shown as by get()
+std::vector<std::pair<std::string, std::string>> contents(const Database::ReadSnapshot& snapshot) {
+    std::vector<std::pair<std::string, std::string>> sorted;
+    snapshot.forEach([&](std::string_view key, std::string_view value) {
+        sorted.emplace_back(std::string(key), TypedValue::display(value));
+    });
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void testSnapshotIgnoresLaterWrites() {
+    TempDir dir;
+    Database db(dir.file("db.json"));
+    for (int i = 0; i < 100; i++) db.insert("k" + std::to_string(i), "v1");
+    auto before = contents(db);
+
+    auto snapshot = db.openSnapshot();
+    db.insert("k0", "v2");
+    db.remove("k1");
+    db.insert("fresh", "v2");
+    CHECK(db.batchInsert(std::unordered_map<std::string, std::string>{{"k2", "v2"}, {"batch", "v2"}}));
+    CHECK(db.batchRemove({"k3"}));
+
+    std::string value;
+    CHECK(snapshot.get("k0", value) && value == "v1");
+    CHECK(snapshot.get("k1", value) && value == "v1");
+    CHECK(snapshot.get("k2", value) && value == "v1");
+    CHECK(snapshot.get("k3", value) && value == "v1");
+    CHECK(!snapshot.get("fresh", value));
+    CHECK(!snapshot.get("batch", value));
+    CHECK(contents(snapshot) == before);
+    CHECK_EQ(snapshot.entries().size(), size_t(100));
+
+    // The live database and a newer snapshot see the writes
+    CHECK_EQ(db.get("k0"), std::string("v2"));
+    CHECK_EQ(db.get("k1"), std::string(""));
+    auto newer = db.openSnapshot();
+    CHECK(newer.sequence() > snapshot.sequence());
+    CHECK(contents(newer) == contents(db));
+}
+
+void testSnapshotIsolatedFromConcurrentWriter() {
+    TempDir dir;
+    Database db(dir.file("db.json"), 8);
+    for (int i = 0; i < 2000; i++) db.insert("k" + std::to_string(i), "0");
+    auto before = contents(db);
+    auto snapshot = db.openSnapshot();
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        for (int round = 1; !stop; round++) {
+            for (int i = round % 7; i < 2000; i += 7) db.insert("k" + std::to_string(i), std::to_string(round));
+            db.remove("k" + std::to_string(round % 2000));
+            db.insert("new" + std::to_string(round), "x");
+        }
+    });
+    bool stable = true;
+    for (int scan = 0; scan < 20; scan++) stable = stable && contents(snapshot) == before;
+    stop = true;
+    writer.join();
+    CHECK(stable);
+
+    // Closing the last snapshot lets old versions go; later snapshots still read correctly
+    { auto closing = std::move(snapshot); }
+    auto latest = db.openSnapshot();
+    CHECK(contents(latest) == contents(db));
+}
+
+void testSnapshotAcrossReload() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    Database db(path);
+    db.setSnapshotFormat(SnapshotFormat::BINARY);
+    for (int i = 0; i < 50; i++) db.insert("k" + std::to_string(i), "saved");
+    CHECK(db.save());
+    db.insert("unsaved", "1");
+
+    auto snapshot = db.openSnapshot();
+    auto before = contents(snapshot);
+    CHECK(db.load());  // Swaps in the mapped file: the open snapshot must not notice
+    CHECK_EQ(db.size(), size_t(50));
+    CHECK(contents(snapshot) == before);
+    CHECK_EQ(before.size(), size_t(51));
+}
+
+using Rows = std::vector<std::pair<std::string, std::string>>;
+
+// 🛠️ Drain a cursor into (key, value shown as by get()) rows
+Rows drain(Database::Cursor cursor) {
+    Rows rows;
+    for (; cursor.valid(); cursor.next()) {
+        rows.emplace_back(std::string(cursor.key()), TypedValue::display(cursor.value()));
+    }
+    return rows;
+}
+
+// 🛠️ The rows of `model` in [lo, hi), in key order or reversed
+Rows slice(const std::map<std::string, std::string>& model, const std::string& lo, const std::string& hi,
+           bool reverse = false) {
+    Rows rows;
+    for (auto it = model.lower_bound(lo); it != model.end() && (hi.empty() || it->first < hi); ++it) {
+        rows.push_back(*it);
+    }
+    if (reverse) std::reverse(rows.begin(), rows.end());
+    return rows;
+}
+
+void testCursorOrdersOverMappedSnapshot() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    std::map<std::string, std::string> model;
+    {
+        Database db(path);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        for (int i = 0; i < 300; i++) db.insert("k" + std::to_string(i), "saved" + std::to_string(i));
+        CHECK(db.save());
+    }
+    Database db(path);
+    CHECK(db.load());
+    for (int i = 0; i < 300; i++) model["k" + std::to_string(i)] = "saved" + std::to_string(i);
+    // Writes since the mapping: rewritten and removed snapshot keys, and new ones between them
+    for (int i = 0; i < 300; i += 10) {
+        db.insert("k" + std::to_string(i), "live");
+        model["k" + std::to_string(i)] = "live";
+    }
+    for (int i = 5; i < 300; i += 25) {
+        db.remove("k" + std::to_string(i));
+        model.erase("k" + std::to_string(i));
+    }
+    for (std::string key : {"a", "k", "k10a", "k2_", "zz"}) {
+        db.insert(key, "new");
+        model[key] = "new";
+    }
+
+    CHECK(drain(db.openCursor()) == slice(model, "", ""));
+    CHECK(drain(db.openCursor(CursorOptions::range("", "", true))) == slice(model, "", "", true));
+    CHECK(drain(db.openCursor(CursorOptions::range("k10", "k2"))) == slice(model, "k10", "k2"));
+    CHECK(drain(db.openCursor(CursorOptions::range("k10", "k2", true))) == slice(model, "k10", "k2", true));
+    CHECK(drain(db.openCursor(CursorOptions::prefix("k1"))) == slice(model, "k1", "k2"));
+    CHECK(drain(db.openCursor(CursorOptions::prefix("k2", true))) == slice(model, "k2", "k3", true));
+    CHECK(drain(db.openCursor(CursorOptions::range("x", "y"))).empty());
+
+    Rows hashed = drain(db.openCursor(CursorOptions::all(CursorOrder::HASH)));
+    std::sort(hashed.begin(), hashed.end());
+    CHECK(hashed == slice(model, "", ""));
+}
+
+void testCursorBatches() {
+    TempDir dir;
+    Database db(dir.file("db.json"));
+    for (int i = 0; i < 100; i++) db.insert("k" + std::to_string(1000 + i), std::to_string(i));
+    Rows expected = drain(db.openCursor());
+
+    Rows batched;
+    auto cursor = db.openCursor();
+    std::vector<std::pair<std::string_view, std::string_view>> batch;
+    while (cursor.nextBatch(batch, 7) > 0) {
+        CHECK(batch.size() <= 7);
+        for (auto& [key, value] : batch) batched.emplace_back(std::string(key), TypedValue::display(value));
+    }
+    CHECK(!cursor.valid());
+    CHECK(batched == expected);
+    CHECK_EQ(expected.size(), size_t(100));
+}
+
+void testCursorOverStorageEngine() {
+    TempDir dir;
+    std::string path = dir.file("db.json");
+    LSMOptions options;
+    options.memtableBytes = 4096;  // Spread the keys over several sorted runs
+    options.wal = quietWAL();
+    Database db(path);
+    CHECK(db.setStorageEngine(std::make_unique<LSMTree>(path + ".lsm", options)));
+    std::map<std::string, std::string> model;
+    for (int i = 0; i < 500; i++) {
+        db.insert("k" + std::to_string(i), "v" + std::to_string(i));
+        model["k" + std::to_string(i)] = "v" + std::to_string(i);
+    }
+    for (int i = 0; i < 500; i += 3) {
+        db.remove("k" + std::to_string(i));
+        model.erase("k" + std::to_string(i));
+    }
+
+    CursorOptions all;
+    all.batchSize = 5;
+    CHECK(drain(db.openCursor(all)) == slice(model, "", ""));
+    CursorOptions range = CursorOptions::range("k2", "k3", true);
+    range.batchSize = 5;
+    CHECK(drain(db.openCursor(range)) == slice(model, "k2", "k3", true));
+}
+
+// 🛠️ Every live entry of an LSM tree, in key order
+Rows lsmContents(const LSMTree& tree) {
+    Rows rows;
+    tree.scan("", "", [&](std::string_view key, std::string_view value) {
+        rows.emplace_back(std::string(key), std::string(value));
+        return true;
+    });
+    return rows;
+}
+
+// 🛠️ Whether the tree holds exactly the model, by point lookups and by a full scan
+bool lsmMatches(const LSMTree& tree, const std::map<std::string, std::string>& model, size_t keySpace) {
+    for (size_t i = 0; i < keySpace; i++) {
+        std::string key = "k" + std::to_string(i);
+        std::string value;
+        auto it = model.find(key);
+        bool found = tree.get(key, value);
+        if (found != (it != model.end()) || (found && value != it->second)) return false;
+    }
+    return lsmContents(tree) == slice(model, "", "");
+}
+
+// 🛠️ Random puts and removes over keys k0..k<keySpace>, mirrored in the model
+void lsmChurn(LSMTree& tree, std::map<std::string, std::string>& model, std::mt19937& rng,
+              size_t keySpace, int ops, int removeOneIn) {
+    for (int i = 0; i < ops; i++) {
+        std::string key = "k" + std::to_string(rng() % keySpace);
+        if (rng() % removeOneIn == 0) {
+            CHECK(tree.remove(key));
+            model.erase(key);
+        } else {
+            std::string value = "value-" + std::to_string(i);
+            CHECK(tree.put(key, value));
+            model[key] = value;
+        }
+    }
+}
+
+void testLSMReplaysSealedMemtable() {
+    TempDir dir;
+    std::string path = dir.file("db.lsm");
+    LSMOptions options;
+    options.wal = quietWAL();
+    std::map<std::string, std::string> model;
+    {
+        LSMTree tree(path, options);
+        CHECK(tree.open());
+        for (int i = 0; i < 300; i++) {
+            CHECK(tree.put("k" + std::to_string(i), "sealed" + std::to_string(i)));
+            model["k" + std::to_string(i)] = "sealed" + std::to_string(i);
+        }
+    }
+    {
+        // What a crash between sealing a memtable and installing its run leaves: the
+        // sealed records in the rotated log, later writes in a fresh live log
+        WriteAheadLog log(path + "/wal", options.wal);
+        CHECK(log.open());
+        CHECK(log.rotate());
+        for (int i = 0; i < 300; i += 3) {
+            std::string key = "k" + std::to_string(i);
+            if (i % 2) {
+                CHECK(log.append({WALOp::REMOVE, key, ""}));
+                model.erase(key);
+            } else {
+                CHECK(log.append({WALOp::INSERT, key, "live" + std::to_string(i)}));
+                model[key] = "live" + std::to_string(i);
+            }
+        }
+        log.close();
+        CHECK(std::filesystem::exists(path + "/wal.ckpt"));
+    }
+    {
+        LSMTree tree(path, options);
+        CHECK(tree.open());
+        CHECK(lsmMatches(tree, model, 300));
+        // Sealing again folds the live log into the leftover rotated one; the flush
+        // then covers both and drops them
+        CHECK(tree.flush());
+        CHECK(!std::filesystem::exists(path + "/wal.ckpt"));
+        CHECK(lsmMatches(tree, model, 300));
+    }
+    LSMTree tree(path, options);
+    CHECK(tree.open());
+    CHECK(lsmMatches(tree, model, 300));
+}
+
+void testLSMReopensAfterCompaction() {
+    TempDir dir;
+    std::string path = dir.file("db.lsm");
+    LSMOptions options;
+    options.memtableBytes = 4096;
+    options.level0Runs = 2;
+    options.level1Bytes = 16 << 10;
+    options.levelRatio = 2;
+    options.wal = quietWAL();
+    std::map<std::string, std::string> model;
+    std::mt19937 rng(13);
+    {
+        LSMTree tree(path, options);
+        CHECK(tree.open());
+        lsmChurn(tree, model, rng, 2000, 20000, 4);
+        tree.waitForCompactions();
+        CHECK(tree.stats().compactions > 0);
+        CHECK(lsmMatches(tree, model, 2000));
+        lsmChurn(tree, model, rng, 2000, 500, 4);  // Left in the memtable and the log
+    }
+    {
+        LSMTree tree(path, options);
+        CHECK(tree.open());
+        CHECK(lsmMatches(tree, model, 2000));
+        lsmChurn(tree, model, rng, 2000, 5000, 3);
+        tree.waitForCompactions();
+    }
+    LSMTree tree(path, options);
+    CHECK(tree.open());
+    CHECK(lsmMatches(tree, model, 2000));
+}
+
+void testLSMDropsTombstonesOnlyAtBottom() {
+    TempDir dir;
+    std::string path = dir.file("db.lsm");
+    LSMOptions options;
+    options.memtableBytes = 4096;
+    options.level0Runs = 2;
+    options.level1Bytes = 8 << 10;
+    options.levelRatio = 2;
+    options.wal = quietWAL();
+    std::map<std::string, std::string> model;
+    std::mt19937 rng(17);
+    {
+        LSMTree tree(path, options);
+        CHECK(tree.open());
+        // Push every key down to the deepest level, then remove a third of them: their
+        // tombstones are compacted through levels that still sit above the old values
+        for (int i = 0; i < 3000; i++) {
+            CHECK(tree.put("k" + std::to_string(i), "base" + std::to_string(i)));
+            model["k" + std::to_string(i)] = "base" + std::to_string(i);
+        }
+        CHECK(tree.flush());
+        tree.waitForCompactions();
+        for (int i = 0; i < 3000; i += 3) {
+            CHECK(tree.remove("k" + std::to_string(i)));
+            model.erase("k" + std::to_string(i));
+        }
+        lsmChurn(tree, model, rng, 3000, 3000, 3);
+        CHECK(tree.flush());
+        tree.waitForCompactions();
+        CHECK(lsmMatches(tree, model, 3000));
+    }
+
+    // Nothing lies below the bottom level, so no tombstone may survive there
+    std::ifstream manifest(path + "/MANIFEST");
+    std::string tag;
+    std::vector<std::pair<size_t, uint64_t>> runs;
+    while (manifest >> tag) {
+        if (tag != "run") continue;
+        size_t level;
+        uint64_t id;
+        manifest >> level >> id;
+        runs.emplace_back(level, id);
+    }
+    size_t bottom = 0;
+    for (const auto& [level, _] : runs) bottom = std::max(bottom, level);
+    CHECK(bottom >= 2);
+    for (const auto& [level, id] : runs) {
+        if (level != bottom) continue;
+        auto run = SortedRun::open(path + "/run-" + std::to_string(id) + ".sst", id);
+        CHECK(run != nullptr);
+        if (!run) continue;
+        for (size_t i = 0; i < run->size(); i++) CHECK(!run->isTombstone(i));
+    }
+
+    LSMTree tree(path, options);
+    CHECK(tree.open());
+    CHECK(lsmMatches(tree, model, 3000));
+}
+
+// 🛠️ Whether one entry matches `query`, decided from the entry alone
+bool matches(const Query& query, const std::string& key, const std::string& value,
+             const std::function<std::string(const std::string&)>& indexer) {
+    switch (query.kind) {
+        case Query::Kind::KEY_PREFIX:
+            return key.compare(0, query.first.size(), query.first) == 0;
+        case Query::Kind::KEY_RANGE:
+            return key >= query.first && (query.second.empty() || key < query.second);
+        case Query::Kind::VALUE_EQUALS:
+            return value == query.first;
+        case Query::Kind::VALUE_REGEX: {
+            static std::map<std::string, std::regex> compiled;
+            auto it = compiled.try_emplace(query.first, query.first).first;
+            return std::regex_search(value, it->second);
+        }
+        case Query::Kind::INDEX_EQUALS:
+            return indexer(value) == query.second;
+        case Query::Kind::AND:
+            for (const auto& child : query.children) {
+                if (!matches(child, key, value, indexer)) return false;
+            }
+            return true;
+        case Query::Kind::OR:
+            for (const auto& child : query.children) {
+                if (matches(child, key, value, indexer)) return true;
+            }
+            return false;
+    }
+    return false;
+}
+
+// 🛠️ A random query tree: leaves from every kind, some selective and some not
+Query randomQuery(std::mt19937& rng, int depth) {
+    auto pick = [&](std::initializer_list<const char*> options) {
+        return std::string(options.begin()[rng() % options.size()]);
+    };
+    if (depth == 0 || rng() % 3 == 0) {
+        switch (rng() % 5) {
+            case 0: return Query::keyPrefix(pick({"user:", "user:1", "user:12", "order:", "order:9", "none:"}));
+            case 1: return Query::keyRange(pick({"", "order:5", "user:"}), pick({"", "order:6", "user:2", "zzz"}));
+            case 2: return Query::valueEquals(pick({"red", "blue", "green7", "cyan", "missing"}));
+            case 3: return Query::valueMatches(pick({"re", "^gr", "[0-9]$", "b.u", "zzz"}));
+            default: return Query::indexEquals("color", pick({"red", "blu", "gre", "cya", "xyz"}));
+        }
+    }
+    std::vector<Query> children;
+    for (size_t n = 2 + rng() % 3; n > 0; n--) children.push_back(randomQuery(rng, depth - 1));
+    return rng() % 2 ? Query::allOf(std::move(children)) : Query::anyOf(std::move(children));
+}
+
+void testPlannerMatchesFullScan() {
+    TempDir dir;
+    std::string path = dir.file("db.bin");
+    const char* colors[] = {"red", "blue", "green", "cyan"};
+    {
+        Database db(path);
+        db.setSnapshotFormat(SnapshotFormat::BINARY);
+        for (int i = 0; i < 2000; i++) {
+            std::string color = colors[i % 4];
+            db.insert("user:" + std::to_string(i), i % 3 ? color : color + std::to_string(i % 10));
+        }
+        CHECK(db.save());
+    }
+    Database db(path);
+    CHECK(db.load());
+    // Live writes over the mapped snapshot, so plans merge both
+    for (int i = 0; i < 1000; i++) db.insert("order:" + std::to_string(i), colors[(i / 7) % 4]);
+    for (int i = 0; i < 2000; i += 11) db.remove("user:" + std::to_string(i));
+    for (int i = 1; i < 2000; i += 13) db.insert("user:" + std::to_string(i), "red");
+    auto indexer = [](const std::string& value) { return value.substr(0, 3); };
+    CHECK(db.createIndex("color", indexer));
+    auto all = db.getAllData();
+
+    std::mt19937 rng(20240611);
+    for (int round = 0; round < 200; round++) {
+        Query query = randomQuery(rng, 3);
+        std::vector<std::string> expected;
+        for (const auto& [key, value] : all) {
+            if (matches(query, key, value, indexer)) expected.push_back(key);
+        }
+        std::sort(expected.begin(), expected.end());
+        std::vector<std::string> planned = db.query(query);
+        if (planned != expected) {
+            std::cerr << "query " << query.toString() << ": " << planned.size() << " keys, scan found "
+                      << expected.size() << std::endl;
+        }
+        CHECK(planned == expected);
+        CHECK_EQ(db.explain(query).matches, expected.size());
+    }
+}
+
+// 🛠️ Components of an undirected edge list by repeated BFS: node -> component number
+std::map<std::string, size_t> referenceComponents(const std::set<std::pair<std::string, std::string>>& edges,
+                                                  const std::set<std::string>& nodes) {
+    std::map<std::string, std::vector<std::string>> adjacent;
+    for (const auto& [a, b] : edges) {
+        adjacent[a].push_back(b);
+        adjacent[b].push_back(a);
+    }
+    std::map<std::string, size_t> component;
+    size_t next = 0;
+    for (const auto& node : nodes) {
+        if (component.count(node)) continue;
+        std::vector<std::string> queue{node};
+        component[node] = next;
+        for (size_t head = 0; head < queue.size(); head++) {
+            for (const auto& neighbor : adjacent[queue[head]]) {
+                if (component.emplace(neighbor, next).second) queue.push_back(neighbor);
+            }
+        }
+        next++;
+    }
+    return component;
+}
+
+void testComponentsTrackEdgeChanges() {
+    TempDir dir;
+    Database db(dir.file("db.json"));
+    std::mt19937 rng(41);
+    std::set<std::string> nodes;
+    std::set<std::pair<std::string, std::string>> edges;  // Each undirected edge once, smaller name first
+    auto name = [](uint32_t i) { return "n" + std::to_string(i); };
+    for (uint32_t i = 0; i < 300; i++) {
+        db.insertNode(name(i));
+        nodes.insert(name(i));
+    }
+
+    for (int round = 0; round < 1500; round++) {
+        std::string a = name(rng() % 300), b = name(rng() % 300);
+        auto edge = std::minmax(a, b);
+        if (rng() % 3 == 0 && !edges.empty()) {
+            // Remove an existing edge: components must split again when the rebuild runs
+            auto it = edges.begin();
+            std::advance(it, rng() % edges.size());
+            CHECK(db.removeEdge(it->first, it->second));
+            edges.erase(it);
+        } else {
+            db.insertEdge(a, b, 1);
+            edges.insert({edge.first, edge.second});
+        }
+
+        if (round % 50 == 0) {
+            auto expected = referenceComponents(edges, nodes);
+            std::map<size_t, size_t> sizes;
+            for (const auto& [_, c] : expected) sizes[c]++;
+            std::vector<size_t> expectedSizes;
+            for (const auto& [_, size] : sizes) expectedSizes.push_back(size);
+            std::sort(expectedSizes.begin(), expectedSizes.end(), std::greater<size_t>());
+
+            CHECK_EQ(db.componentCount(), sizes.size());
+            CHECK(db.componentSizes() == expectedSizes);
+            for (int probe = 0; probe < 20; probe++) {
+                std::string x = name(rng() % 300), y = name(rng() % 300);
+                CHECK_EQ(db.connected(x, y), expected[x] == expected[y]);
+                CHECK_EQ(db.componentSize(x), sizes[expected[x]]);
+            }
+        }
+    }
+    CHECK(!db.connected("n0", "unknown"));
+    CHECK_EQ(db.componentSize("unknown"), size_t(0));
+}
+
+void testCycleDetection() {
+    TempDir dir;
+    Database db(dir.file("db.json"));
+    CHECK(!db.insertEdge("a", "b", 1));
+    CHECK(!db.insertEdge("b", "c", 1));
+    CHECK(!db.hasCycle());
+    CHECK(!db.insertEdge("a", "b", 5));  // Already there: not a new edge
+    CHECK(!db.hasCycle());
+    CHECK(db.insertEdge("c", "a", 1));
+    CHECK(db.hasCycle());
+    CHECK(db.insertEdge("d", "d", 1));   // Self-loops count
+    CHECK_EQ(db.componentCount(), size_t(2));
+}
+
+}  // namespace
+
+int main() {
+    return runTests({
+        {"WAL replays inserts, removes and batches", testWALReplaysEveryOperation},
+        {"WAL drops a torn tail", testWALDropsTornTail},
+        {"writes after a checkpoint survive a crash", testCheckpointThenCrash},
+        {"an interrupted checkpoint is recovered", testInterruptedCheckpointIsRecovered},
+        {"no checkpoint runs before load()", testNoCheckpointBeforeLoad},
+        {"binary snapshot reloads every entry", testBinarySnapshotReload},
+        {"writes over a mapped snapshot are saved", testWritesOverMappedSnapshot},
+        {"binary checkpoint plus log recovers", testBinaryCheckpointRecovery},
+        {"imports are logged and survive a crash", testImportIsLogged},
+        {"imports keep the value index current", testImportKeepsValueIndex},
+        {"typed values survive a JSON save and an export/import", testTypedJSONRoundTrip},
+        {"numeric range and summary queries match a model", testNumericQueriesMatchModel},
+        {"value prefix queries see values as get() shows them", testValuePrefixSeesShownValues},
+        {"the blob store deduplicates values", testBlobStoreDeduplicates},
+        {"the blob store drops a torn tail", testBlobStoreDropsTornTail},
+        {"blob values are viewed and located in the blob file", testBlobViewsAndLocations},
+        {"load opens the blob file its values refer to", testLoadOpensBlobFile},
+        {"a snapshot ignores later writes", testSnapshotIgnoresLaterWrites},
+        {"a snapshot is isolated from a concurrent writer", testSnapshotIsolatedFromConcurrentWriter},
+        {"a snapshot survives a reload", testSnapshotAcrossReload},
+        {"cursors merge a mapped snapshot in every order", testCursorOrdersOverMappedSnapshot},
+        {"cursor batches cover the same rows", testCursorBatches},
+        {"cursors scan a storage engine", testCursorOverStorageEngine},
+        {"an LSM tree replays a sealed memtable's log", testLSMReplaysSealedMemtable},
+        {"an LSM tree reopens after compactions", testLSMReopensAfterCompaction},
+        {"LSM tombstones are dropped only at the bottom level", testLSMDropsTombstonesOnlyAtBottom},
+        {"planned queries match a full scan", testPlannerMatchesFullScan},
+        {"components follow edge inserts and removals", testComponentsTrackEdgeChanges},
+        {"cycles are detected as edges close them", testCycleDetection},
+    });
+}
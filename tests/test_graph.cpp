@@ -0,0 +1,324 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/Graph.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ParallelBFS.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/ShortestPath.h"
+#include "/Users/gaganphadke/Versioning/versioned-db/include/UnionFind.h"
+#include "TestSupport.h"
+#include <map>
+#include <random>
+#include <set>
+
+// Graph algorithm tests: every search is checked against a plain reference computed
+// from the edge list, on random graphs and on a grid where A* has a real heuristic.
+
+namespace {
+
+struct Edge {
+    NodeId from;
+    NodeId to;
+    int weight;
+};
+
+// A graph and the same graph with every edge flipped, both compacted
+struct TestGraph {
+    Graph graph;
+    Graph reverse;
+    std::vector<Edge> edges;
+};
+
+// 🛠️ Build both directions from an edge list; repeated edges keep their first weight
+TestGraph buildGraph(size_t nodes, const std::vector<Edge>& edges) {
+    TestGraph built;
+    for (size_t i = 0; i < nodes; i++) {
+        built.graph.addNode("n" + std::to_string(i));
+        built.reverse.addNode("n" + std::to_string(i));
+    }
+    for (const auto& edge : edges) {
+        if (built.graph.addEdge(edge.from, edge.to, edge.weight)) {
+            built.reverse.addEdge(edge.to, edge.from, edge.weight);
+            built.edges.push_back(edge);
+        }
+    }
+    built.graph.compact();
+    built.reverse.compact();
+    return built;
+}
+
+TestGraph randomGraph(size_t nodes, size_t edges, int maxWeight, std::mt19937& rng) {
+    std::vector<Edge> list;
+    for (size_t i = 0; i < edges; i++) {
+        list.push_back({static_cast<NodeId>(rng() % nodes), static_cast<NodeId>(rng() % nodes),
+                        static_cast<int>(rng() % (maxWeight + 1))});
+    }
+    return buildGraph(nodes, list);
+}
+
+// A width x width grid with edges both ways between neighbours, weights of at least 1
+TestGraph gridGraph(size_t width, std::mt19937& rng) {
+    std::vector<Edge> list;
+    for (size_t y = 0; y < width; y++) {
+        for (size_t x = 0; x < width; x++) {
+            NodeId id = static_cast<NodeId>(y * width + x);
+            if (x + 1 < width) {
+                int weight = 1 + static_cast<int>(rng() % 9);
+                list.push_back({id, id + 1, weight});
+                list.push_back({id + 1, id, weight});
+            }
+            if (y + 1 < width) {
+                int weight = 1 + static_cast<int>(rng() % 9);
+                list.push_back({id, static_cast<NodeId>(id + width), weight});
+                list.push_back({static_cast<NodeId>(id + width), id, weight});
+            }
+        }
+    }
+    return buildGraph(width * width, list);
+}
+
+// 🛠️ Bellman-Ford distances from `source`: slow, but simple enough to trust
+std::vector<uint64_t> referenceDistances(size_t nodes, const std::vector<Edge>& edges, NodeId source) {
+    std::vector<uint64_t> dist(nodes, UNREACHABLE);
+    dist[source] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const auto& edge : edges) {
+            if (dist[edge.from] == UNREACHABLE) continue;
+            uint64_t through = dist[edge.from] + static_cast<uint64_t>(edge.weight);
+            if (through < dist[edge.to]) {
+                dist[edge.to] = through;
+                changed = true;
+            }
+        }
+    }
+    return dist;
+}
+
+// 🛠️ Whether `result` is a real from-to path over the graph's edges of the expected length
+bool validPath(const Graph& graph, const PathResult& result, NodeId from, NodeId to, uint64_t expected) {
+    if (expected == UNREACHABLE) return !result.found && result.nodes.empty();
+    if (!result.found || result.distance != expected || result.nodes.empty()) return false;
+    if (result.nodes.front() != from || result.nodes.back() != to) return false;
+    uint64_t length = 0;
+    for (size_t i = 0; i + 1 < result.nodes.size(); i++) {
+        NodeId u = result.nodes[i];
+        const NodeId* row = graph.targetsOf(u);
+        size_t n = graph.degree(u);
+        size_t at = std::lower_bound(row, row + n, result.nodes[i + 1]) - row;
+        if (at == n || row[at] != result.nodes[i + 1]) return false;
+        length += static_cast<uint64_t>(graph.weightsOf(u)[at]);
+    }
+    return length == expected;
+}
+
+// 🛠️ Every search between random pairs must agree with the reference distances
+void checkSearches(const TestGraph& test, std::mt19937& rng, size_t sources) {
+    size_t nodes = test.graph.nodeCount();
+    for (size_t round = 0; round < sources; round++) {
+        NodeId from = static_cast<NodeId>(rng() % nodes);
+        std::vector<uint64_t> expected = referenceDistances(nodes, test.edges, from);
+        CHECK(shortestDistances(test.graph, from, PathHeap::RADIX) == expected);
+        CHECK(shortestDistances(test.graph, from, PathHeap::DARY) == expected);
+
+        PathHeuristic zero = [](NodeId) { return uint64_t(0); };
+        for (size_t target = 0; target < 10; target++) {
+            NodeId to = static_cast<NodeId>(rng() % nodes);
+            CHECK(validPath(test.graph, dijkstraPath(test.graph, from, to, PathHeap::RADIX), from, to, expected[to]));
+            CHECK(validPath(test.graph, dijkstraPath(test.graph, from, to, PathHeap::DARY), from, to, expected[to]));
+            CHECK(validPath(test.graph, bidirectionalPath(test.graph, test.reverse, from, to), from, to, expected[to]));
+            CHECK(validPath(test.graph, astarPath(test.graph, from, to, zero), from, to, expected[to]));
+        }
+    }
+}
+
+void testPathsOnRandomGraphs() {
+    std::mt19937 rng(17);
+    for (size_t nodes : {1, 2, 10, 60, 300}) {
+        for (size_t density : {1, 3, 8}) {
+            // Zero weights included: ties between equally short paths must not confuse any search
+            TestGraph test = randomGraph(nodes, nodes * density, 20, rng);
+            checkSearches(test, rng, 4);
+        }
+    }
+}
+
+void testAStarWithManhattanHeuristic() {
+    std::mt19937 rng(23);
+    const size_t width = 40;
+    TestGraph test = gridGraph(width, rng);
+    for (int round = 0; round < 20; round++) {
+        NodeId from = static_cast<NodeId>(rng() % (width * width));
+        NodeId to = static_cast<NodeId>(rng() % (width * width));
+        std::vector<uint64_t> expected = referenceDistances(width * width, test.edges, from);
+        // Every edge weighs at least 1, so grid steps are a consistent lower bound
+        PathHeuristic manhattan = [&](NodeId v) {
+            auto gap = [](size_t a, size_t b) { return a > b ? a - b : b - a; };
+            return static_cast<uint64_t>(gap(v % width, to % width) + gap(v / width, to / width));
+        };
+        // Still a lower bound but no longer consistent, so settled nodes get queued again
+        PathHeuristic patchy = [&](NodeId v) { return v % 3 ? manhattan(v) : uint64_t(0); };
+        PathResult astar = astarPath(test.graph, from, to, manhattan);
+        PathResult dijkstra = dijkstraPath(test.graph, from, to);
+        CHECK(validPath(test.graph, astar, from, to, expected[to]));
+        CHECK(validPath(test.graph, astarPath(test.graph, from, to, patchy), from, to, expected[to]));
+        CHECK(validPath(test.graph, dijkstra, from, to, expected[to]));
+        CHECK(validPath(test.graph, bidirectionalPath(test.graph, test.reverse, from, to), from, to, expected[to]));
+        CHECK(astar.settled <= dijkstra.settled);
+    }
+
+    // A heuristic ruling a node out keeps A* away from it
+    NodeId from = 0, to = static_cast<NodeId>(width * width - 1);
+    NodeId blocked = 1;
+    PathResult detour = astarPath(test.graph, from, to, [&](NodeId v) { return v == blocked ? UNREACHABLE : 0; });
+    CHECK(detour.found);
+    CHECK(std::find(detour.nodes.begin(), detour.nodes.end(), blocked) == detour.nodes.end());
+}
+
+// 🛠️ Hop counts from `start` by a plain queue-based BFS, UINT32_MAX where unreached
+std::vector<uint32_t> referenceLevels(const Graph& graph, NodeId start) {
+    std::vector<uint32_t> level(graph.nodeCount(), UINT32_MAX);
+    std::vector<NodeId> queue{start};
+    level[start] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        NodeId u = queue[head];
+        for (size_t i = 0; i < graph.degree(u); i++) {
+            NodeId v = graph.targetsOf(u)[i];
+            if (level[v] == UINT32_MAX) {
+                level[v] = level[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return level;
+}
+
+// 🛠️ Check a BFS result level by level against the reference hop counts
+void checkBfs(const TestGraph& test, NodeId start, const BfsOptions& options) {
+    BfsResult result = parallelBfs(test.graph, test.reverse, start, options);
+    std::vector<uint32_t> expected = referenceLevels(test.graph, start);
+
+    CHECK(!result.order.empty() && result.order.front() == start);
+    CHECK(!result.levelOffsets.empty() && result.levelOffsets.front() == 0);
+    CHECK(!result.levelOffsets.empty() && result.levelOffsets.back() == result.order.size());
+    std::vector<uint32_t> seen(test.graph.nodeCount(), UINT32_MAX);
+    for (size_t d = 0; d + 1 < result.levelOffsets.size(); d++) {
+        CHECK(result.levelOffsets[d] < result.levelOffsets[d + 1]);  // No empty levels
+        for (size_t i = result.levelOffsets[d]; i < result.levelOffsets[d + 1]; i++) {
+            CHECK(seen[result.order[i]] == UINT32_MAX);
+            seen[result.order[i]] = static_cast<uint32_t>(d);
+        }
+    }
+    for (NodeId v = 0; v < test.graph.nodeCount(); v++) {
+        uint32_t want = expected[v] <= options.maxDepth ? expected[v] : UINT32_MAX;
+        CHECK_EQ(seen[v], want);
+    }
+
+    if (options.parents) {
+        CHECK_EQ(result.parents.size(), test.graph.nodeCount());
+        for (NodeId v = 0; v < result.parents.size(); v++) {
+            NodeId parent = result.parents[v];
+            if (seen[v] == UINT32_MAX) {
+                CHECK(parent == Graph::NONE);
+            } else if (v == start) {
+                CHECK(parent == start);
+            } else {
+                CHECK(parent != Graph::NONE && seen[parent] + 1 == seen[v] && test.graph.hasEdge(parent, v));
+            }
+        }
+    }
+}
+
+void testBfsLevelsOnSmallGraphs() {
+    std::mt19937 rng(5);
+    for (size_t nodes : {1, 2, 50, 1000}) {
+        TestGraph test = randomGraph(nodes, nodes * 2, 1, rng);
+        for (int round = 0; round < 5; round++) {
+            NodeId start = static_cast<NodeId>(rng() % nodes);
+            BfsOptions options;
+            options.parents = true;
+            checkBfs(test, start, options);
+            options.maxDepth = 0;
+            checkBfs(test, start, options);
+            options.maxDepth = 2;
+            checkBfs(test, start, options);
+        }
+        // Graph::bfs visits the same nodes
+        std::vector<NodeId> serial = test.graph.bfs(0);
+        BfsResult parallel = parallelBfs(test.graph, test.reverse, 0);
+        CHECK(std::set<NodeId>(serial.begin(), serial.end()) ==
+              std::set<NodeId>(parallel.order.begin(), parallel.order.end()));
+    }
+}
+
+void testBfsLevelsAcrossThreadsAndDirections() {
+    // Large enough to run on worker threads, dense enough to switch to bottom-up
+    std::mt19937 rng(9);
+    TestGraph test = randomGraph(40000, 40000 * 8, 1, rng);
+    size_t bottomUp = 0;
+    for (size_t threads : {1, 2, 4, 8}) {
+        NodeId start = static_cast<NodeId>(rng() % test.graph.nodeCount());
+        BfsOptions options;
+        options.threads = threads;
+        options.parents = true;
+        checkBfs(test, start, options);
+        bottomUp += parallelBfs(test.graph, test.reverse, start, options).bottomUpLevels;
+        options.maxDepth = 3;
+        checkBfs(test, start, options);
+    }
+    CHECK(bottomUp > 0);
+
+    // A directed chain: every level is one node, so the search never leaves top-down
+    std::vector<Edge> chain;
+    for (NodeId i = 0; i + 1 < 40000; i++) chain.push_back({i, i + 1, 1});
+    TestGraph line = buildGraph(40000, chain);
+    BfsOptions options;
+    options.threads = 4;
+    checkBfs(line, 0, options);
+    checkBfs(line, 39000, options);
+}
+
+void testUnionFindMatchesLabels() {
+    std::mt19937 rng(31);
+    const uint32_t n = 2000;
+    UnionFind sets;
+    sets.reset(n / 2);
+    for (uint32_t i = n / 2; i < n; i++) CHECK_EQ(sets.add(), i);
+    std::vector<uint32_t> label(n);  // Naive: relabel a whole set on every merge
+    for (uint32_t i = 0; i < n; i++) label[i] = i;
+    size_t labels = n;
+
+    for (int round = 0; round < 3000; round++) {
+        uint32_t a = rng() % n, b = rng() % n;
+        bool separate = label[a] != label[b];
+        CHECK_EQ(sets.unite(a, b), separate);
+        if (separate) {
+            uint32_t from = label[b];
+            for (auto& l : label) if (l == from) l = label[a];
+            labels--;
+        }
+        if (round % 100 == 0) {
+            CHECK_EQ(sets.setCount(), labels);
+            for (int probe = 0; probe < 50; probe++) {
+                uint32_t x = rng() % n, y = rng() % n;
+                CHECK_EQ(sets.connected(x, y), label[x] == label[y]);
+                CHECK_EQ(sets.setSize(x), size_t(std::count(label.begin(), label.end(), label[x])));
+            }
+        }
+    }
+
+    std::map<uint32_t, size_t> counts;
+    for (uint32_t l : label) counts[l]++;
+    std::vector<size_t> expected;
+    for (const auto& [_, size] : counts) expected.push_back(size);
+    std::sort(expected.begin(), expected.end(), std::greater<size_t>());
+    CHECK(sets.setSizes() == expected);
+}
+
+}  // namespace
+
+int main() {
+    return runTests({
+        {"Dijkstra, bidirectional and A* agree with Bellman-Ford", testPathsOnRandomGraphs},
+        {"A* with a Manhattan heuristic finds shortest paths", testAStarWithManhattanHeuristic},
+        {"BFS levels match a queue-based BFS", testBfsLevelsOnSmallGraphs},
+        {"parallel BFS levels match on every thread count", testBfsLevelsAcrossThreadsAndDirections},
+        {"union-find sets match naive labels", testUnionFindMatchesLabels},
+    });
+}
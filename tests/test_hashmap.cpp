@@ -0,0 +1,271 @@
+#include "/Users/gaganphadke/Versioning/versioned-db/include/FlatHashMap.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// FlatHashMap tests: random operation sequences checked against std::unordered_map,
+// plus the erase rules that keep a churning table from growing.
+
+namespace {
+
+// Hashes std::string and std::string_view alike, so lookups needn't build a key
+struct TextHash {
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>()(text); }
+};
+
+// Every key on one probe sequence, so the groups fill in a known order
+struct CollidingHash {
+    size_t operator()(std::string_view) const { return 0; }
+};
+
+// Keys with the same first letter share a probe sequence
+struct FirstLetterHash {
+    size_t operator()(std::string_view key) const { return static_cast<unsigned char>(key[0]); }
+};
+
+using Map = FlatHashMap<std::string, int, TextHash>;
+
+// 🛠️ Whether `map` holds exactly the model's entries, found both by lookup and by iteration
+template <typename M>
+bool sameAs(const M& map, const std::unordered_map<std::string, int>& model) {
+    if (map.size() != model.size()) return false;
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        auto it = model.find(key);
+        if (it == model.end() || it->second != value) return false;
+        visited++;
+    }
+    if (visited != model.size()) return false;
+    for (const auto& [key, value] : model) {
+        auto it = map.find(std::string_view(key));
+        if (it == map.end() || it->second != value) return false;
+    }
+    return true;
+}
+
+std::vector<std::string> iterationOrder(const FlatHashMap<std::string, int, CollidingHash>& map) {
+    std::vector<std::string> keys;
+    for (const auto& entry : map) keys.push_back(entry.first);
+    return keys;
+}
+
+void testMatchesUnorderedMap() {
+    Map map;
+    std::unordered_map<std::string, int> model;
+    std::mt19937 rng(7);
+    auto name = [](uint32_t i) { return "key:" + std::to_string(i); };
+
+    for (int op = 0; op < 200000; op++) {
+        std::string key = name(rng() % 3000);
+        switch (rng() % 6) {
+            case 0:
+            case 1: {
+                bool inserted = map.try_emplace(key, op).second;
+                CHECK_EQ(inserted, model.try_emplace(key, op).second);
+                break;
+            }
+            case 2:
+                map[key] = op;
+                model[key] = op;
+                break;
+            case 3:
+            case 4:
+                // Erase by string_view: no std::string is built for the lookup
+                CHECK_EQ(map.erase(std::string_view(key)), model.erase(key));
+                break;
+            default: {
+                auto it = map.find(std::string_view(key));
+                auto expected = model.find(key);
+                CHECK_EQ(it == map.end(), expected == model.end());
+                if (it != map.end() && expected != model.end()) CHECK_EQ(it->second, expected->second);
+                CHECK_EQ(map.count(std::string_view(key)), model.count(key));
+            }
+        }
+        if (op % 10000 == 0) CHECK(sameAs(map, model));
+    }
+    CHECK(sameAs(map, model));
+
+    // Erasing through iterators while walking the table leaves the rest in place
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        if (it->second % 2) {
+            model.erase(it->first);
+            map.erase(it);
+        }
+    }
+    CHECK(sameAs(map, model));
+    CHECK_EQ(map.find(std::string_view("key:never")) == map.end(), true);
+
+    Map moved(std::move(map));
+    CHECK(map.empty());
+    CHECK(sameAs(moved, model));
+    moved.clear();
+    CHECK(moved.empty());
+    CHECK_EQ(moved.capacity(), size_t(0));
+    CHECK(moved.find(std::string_view("key:1")) == moved.end());
+}
+
+void testEraseInGroupWithEmptySlotFreesIt() {
+    // One group of 16 slots takes 14 entries. Ten live keys leave EMPTY slots in the
+    // group, so each erase turns its slot back to EMPTY and returns it to the growth
+    // budget: churning fresh keys through never forces a rehash.
+    Map map;
+    std::unordered_map<std::string, int> model;
+    for (int i = 0; i < 10; i++) {
+        map.try_emplace("k" + std::to_string(i), i);
+        model.emplace("k" + std::to_string(i), i);
+    }
+    CHECK_EQ(map.capacity(), Map::GROUP_WIDTH);
+    for (int i = 10; i < 5000; i++) {
+        std::string gone = "k" + std::to_string(i - 10);
+        CHECK_EQ(map.erase(std::string_view(gone)), size_t(1));
+        model.erase(gone);
+        map.try_emplace("k" + std::to_string(i), i);
+        model.emplace("k" + std::to_string(i), i);
+    }
+    CHECK_EQ(map.capacity(), Map::GROUP_WIDTH);
+    CHECK(sameAs(map, model));
+}
+
+void testEraseInFullGroupLeavesTombstone() {
+    // With every key on one probe sequence, the first group fills before any key lands
+    // in the second. Erasing from the full first group must leave a DELETED marker:
+    // an EMPTY slot there would end the probe for every key behind it.
+    FlatHashMap<std::string, int, CollidingHash> map;
+    for (int i = 0; i < 20; i++) map.try_emplace("k" + std::to_string(i), i);
+    CHECK_EQ(map.capacity(), 2 * Map::GROUP_WIDTH);
+    std::vector<std::string> before = iterationOrder(map);
+
+    CHECK_EQ(map.erase(std::string_view("k3")), size_t(1));
+    for (int i = 0; i < 20; i++) {
+        if (i == 3) continue;
+        auto it = map.find(std::string_view("k" + std::to_string(i)));
+        CHECK(it != map.end() && it->second == i);
+    }
+    CHECK(map.find(std::string_view("k3")) == map.end());
+
+    // The next insert reuses the DELETED slot, the first free one on its probe sequence
+    map.try_emplace("fresh", 99);
+    std::vector<std::string> after = iterationOrder(map);
+    std::replace(before.begin(), before.end(), std::string("k3"), std::string("fresh"));
+    CHECK(after == before);
+    CHECK_EQ(map.capacity(), 2 * Map::GROUP_WIDTH);
+
+    // Tombstones keep being reused: churn in the first group never grows the table
+    for (int i = 0; i < 1000; i++) {
+        std::string gone = i ? "again" + std::to_string(i - 1) : "fresh";
+        CHECK_EQ(map.erase(std::string_view(gone)), size_t(1));
+        map.try_emplace("again" + std::to_string(i), i);
+    }
+    CHECK_EQ(map.size(), size_t(20));
+    CHECK_EQ(map.capacity(), 2 * Map::GROUP_WIDTH);
+    for (int i = 0; i < 20; i++) {
+        if (i != 3) CHECK(map.count(std::string_view("k" + std::to_string(i))));
+    }
+}
+
+void testChurnKeepsCapacity() {
+    // Fill to the load limit, then shrink to a third and churn at that size: erased
+    // slots go back to EMPTY or are reused as tombstones, and the table never doubles
+    Map map;
+    std::unordered_map<std::string, int> model;
+    std::mt19937 rng(11);
+    int next = 0;
+    auto add = [&] {
+        std::string key = "churn:" + std::to_string(next);
+        map.try_emplace(key, next);
+        model.emplace(key, next);
+        next++;
+    };
+    while (map.size() < 896) add();  // 7/8 of 1024 slots
+    size_t capacity = map.capacity();
+    CHECK_EQ(capacity, size_t(1024));
+
+    std::vector<std::string> live;
+    for (const auto& [key, _] : model) live.push_back(key);
+    std::shuffle(live.begin(), live.end(), rng);
+    while (live.size() > 300) {
+        CHECK_EQ(map.erase(std::string_view(live.back())), size_t(1));
+        model.erase(live.back());
+        live.pop_back();
+    }
+
+    for (int round = 0; round < 50000; round++) {
+        size_t victim = rng() % live.size();
+        CHECK_EQ(map.erase(std::string_view(live[victim])), size_t(1));
+        model.erase(live[victim]);
+        live[victim] = "churn:" + std::to_string(next);
+        add();
+        CHECK_EQ(map.capacity(), capacity);
+    }
+    CHECK(sameAs(map, model));
+}
+
+using LetterMap = FlatHashMap<std::string, int, FirstLetterHash>;
+
+// 🛠️ Which group of a 32-slot table keys starting with `letter` land in first
+size_t homeGroup(char letter) {
+    LetterMap map;
+    map.reserve(28);
+    map.try_emplace(std::string(1, letter), 0);
+    for (size_t slot = 0; slot < map.capacity(); slot++) {
+        if (map.occupied(slot)) return slot / LetterMap::GROUP_WIDTH;
+    }
+    return SIZE_MAX;
+}
+
+void testTombstonesClearedAtSameSize() {
+    // Fill one group with 'a' keys and part of the other with keys of a letter homed
+    // there, using up the growth budget. Erasing 'a' keys from the full group leaves
+    // tombstones no 'b'-side probe passes, so the next insert finds an EMPTY slot with
+    // no budget left. With most of the load being tombstones, the rehash must clear
+    // them at the same capacity instead of doubling the table.
+    char other = 'b';
+    while (other <= 'z' && homeGroup(other) == homeGroup('a')) other++;
+    CHECK(other <= 'z');
+    auto key = [](char letter, int i) { return letter + std::to_string(i); };
+
+    LetterMap map;
+    std::unordered_map<std::string, int> model;
+    map.reserve(28);
+    CHECK_EQ(map.capacity(), 2 * LetterMap::GROUP_WIDTH);
+    for (int i = 0; i < 16; i++) map.try_emplace(key('a', i), i);
+    for (int i = 0; i < 12; i++) map.try_emplace(key(other, i), i);
+    size_t full = homeGroup('a') * LetterMap::GROUP_WIDTH;
+    for (size_t slot = full; slot < full + LetterMap::GROUP_WIDTH; slot++) {
+        CHECK(map.occupied(slot) && map.slotAt(slot).first[0] == 'a');
+    }
+
+    for (int i = 0; i < 15; i++) CHECK_EQ(map.erase(std::string_view(key('a', i))), size_t(1));
+    model.emplace(key('a', 15), 15);
+    for (int i = 0; i < 12; i++) model.emplace(key(other, i), i);
+    CHECK(sameAs(map, model));
+
+    map.try_emplace(key(other, 12), 12);
+    model.emplace(key(other, 12), 12);
+    CHECK_EQ(map.capacity(), 2 * LetterMap::GROUP_WIDTH);
+    CHECK(sameAs(map, model));
+
+    // The tombstones are gone: the table fills to its load limit again without growing
+    for (int i = 13; map.size() < 28; i++) {
+        map.try_emplace(key(other, i), i);
+        model.emplace(key(other, i), i);
+    }
+    CHECK_EQ(map.capacity(), 2 * LetterMap::GROUP_WIDTH);
+    CHECK(sameAs(map, model));
+}
+
+}  // namespace
+
+int main() {
+    return runTests({
+        {"random operations match std::unordered_map", testMatchesUnorderedMap},
+        {"an erase in a group with an EMPTY slot frees the slot", testEraseInGroupWithEmptySlotFreesIt},
+        {"an erase in a full group leaves a reusable tombstone", testEraseInFullGroupLeavesTombstone},
+        {"churn at a third of the load keeps the capacity", testChurnKeepsCapacity},
+        {"a rehash at the same size clears tombstones", testTombstonesClearedAtSameSize},
+    });
+}